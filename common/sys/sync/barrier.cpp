@@ -15,88 +15,16 @@
 // ======================================================================== //
 
 #include "barrier.h"
-#include "condition.h"
-
-#if defined (__WIN32__)
-
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
-
-namespace embree
-{
-  struct BarrierSysImplementation
-  {
-    __forceinline BarrierSysImplementation () 
-      : i(0), enterCount(0), exitCount(0), barrierSize(0) 
-    {
-      events[0] = CreateEvent(NULL, TRUE, FALSE, NULL);
-      events[1] = CreateEvent(NULL, TRUE, FALSE, NULL);
-    }
-    
-    __forceinline ~BarrierSysImplementation ()
-    {
-      CloseHandle(events[0]);
-      CloseHandle(events[1]);
-    }
-    
-    __forceinline void init(size_t N) 
-    {
-      barrierSize = N;
-      enterCount = N;
-      exitCount = N;
-    }
-
-    __forceinline void wait()
-    {
-      /* every thread entering the barrier decrements this count */
-      size_t i0 = i;
-      ssize_t cnt0 = atomic_add(&enterCount,-1);
-
-      /* all threads except the last one are wait in the barrier */
-      if (cnt0 > 1) 
-      {
-        if (WaitForSingleObject(events[i0], INFINITE) != WAIT_OBJECT_0)
-          THROW_RUNTIME_ERROR("WaitForSingleObjects failed");
-      }
-      
-      /* the last thread starts all threads waiting at the barrier */
-      else 
-      {
-        i = 1-i;
-        enterCount = barrierSize;
-        if (SetEvent(events[i0]) == 0)
-          THROW_RUNTIME_ERROR("SetEvent failed");
-      }
-
-      /* every thread leaving the barrier decrements this count */
-      ssize_t cnt1 = atomic_add(&exitCount,-1);
-
-      /* the last thread that left the barrier resets the event again */
-      if (cnt1 == 1) 
-      {
-        exitCount = barrierSize;
-        if (ResetEvent(events[i0]) == 0)
-          THROW_RUNTIME_ERROR("ResetEvent failed");
-      }
-    }
-
-  public:
-    HANDLE events[2];
-    volatile size_t i;
-    volatile atomic_t enterCount;
-    volatile atomic_t exitCount;
-	size_t barrierSize;
-  };
-}
-
-#else
 
 namespace embree
 {
+  /*! The last thread entering the barrier starts a new generation, all
+   *  other threads wait for the generation to change following the idle
+   *  policy. */
   struct BarrierSysImplementation
   {
     __forceinline BarrierSysImplementation () 
-      : count(0), barrierSize(0) {}
+      : count(0), barrierSize(0), generation(0) {}
     
     __forceinline void init(size_t N) 
     {
@@ -106,31 +34,28 @@ namespace embree
 
     __forceinline void wait()
     {
-      mutex.lock();
-      count++;
-      
-      if (count == barrierSize) {
+      const atomic_t gen = generation;
+
+      /* the last thread entering the barrier wakes up all other threads */
+      if (atomic_add(&count,1) == barrierSize-1) {
         count = 0;
-        cond.broadcast();
-        mutex.unlock();
+        __memory_barrier();
+        generation = gen+1;
+        idle.notify();
         return;
       }
-      
-      cond.wait(mutex);
-      mutex.unlock();
-      return;
+
+      idle.wait([&] { return generation != gen; });
     }
 
   public:
-    MutexSys mutex;
-    ConditionSys cond;
-    volatile size_t count;
-    volatile size_t barrierSize;
+    volatile atomic_t count;
+    volatile atomic_t barrierSize;
+    volatile atomic_t generation;
+    IdleWait idle;
   };
 }
 
-#endif
-
 namespace embree
 {
   BarrierSys::BarrierSys () {
@@ -184,29 +109,18 @@ namespace embree
           count1[i] = 0;
         
         for (size_t i=1; i<threadCount; i++)
-        {
-          unsigned int wait_cycles = MIN_MIC_BARRIER_WAIT_CYCLES;
-          while (likely(count0[i] == 0)) 
-          {
-            pause(wait_cycles);
-          }
-        }
+          idle.wait([&] { return count0[i] != 0; });
         mode  = 1;
         flag1 = 0;
         __memory_barrier();
         flag0 = 1;
+        idle.notify();
       }			
       else
       {					
         count0[threadIndex] = 1;
-        {
-          unsigned int wait_cycles = MIN_MIC_BARRIER_WAIT_CYCLES;
-          while (likely(flag0 == 0))
-          {
-            pause(wait_cycles);
-          }
-        }
-        
+        idle.notify();
+        idle.wait([&] { return flag0 != 0; });
       }		
     }					
     else						
@@ -217,29 +131,19 @@ namespace embree
           count0[i] = 0;
         
         for (size_t i=1; i<threadCount; i++)
-        {		
-          unsigned int wait_cycles = MIN_MIC_BARRIER_WAIT_CYCLES;
-          while (likely(count1[i] == 0))
-          {
-            pause(wait_cycles);
-          }
-        }
+          idle.wait([&] { return count1[i] != 0; });
         
         mode  = 0;
         flag0 = 0;
         __memory_barrier();
         flag1 = 1;
+        idle.notify();
       }			
       else
       {					
         count1[threadIndex] = 1;
-        {
-          unsigned int wait_cycles = MIN_MIC_BARRIER_WAIT_CYCLES;
-          while (likely(flag1 == 0))
-          {
-            pause(wait_cycles);
-          }
-        }
+        idle.notify();
+        idle.wait([&] { return flag1 != 0; });
       }		
     }					
   }
@@ -261,28 +165,20 @@ namespace embree
         
         for (size_t i=1; i<threadCount; i++)
         {
-          unsigned int wait_cycles = MIN_MIC_BARRIER_WAIT_CYCLES;
-          while (likely(count0[i] == 0)) 
-          {
-            pause(wait_cycles);
-          }
+          idle.wait([&] { return count0[i] != 0; });
           (*reductionFct)(threadIndex,i,ptr);
         }
         mode  = 1;
         flag1 = 0;
         __memory_barrier();
         flag0 = 1;
+        idle.notify();
       }			
       else
       {					
         count0[threadIndex] = 1;
-        {
-          unsigned int wait_cycles = MIN_MIC_BARRIER_WAIT_CYCLES;
-          while (likely(flag0 == 0))
-          {
-            pause(wait_cycles);
-          }
-        }
+        idle.notify();
+        idle.wait([&] { return flag0 != 0; });
       }		
     }					
     else						
@@ -293,12 +189,8 @@ namespace embree
           count0[i] = 0;
         
         for (size_t i=1; i<threadCount; i++)
-        {		
-          unsigned int wait_cycles = MIN_MIC_BARRIER_WAIT_CYCLES;
-          while (likely(count1[i] == 0))
-          {
-            pause(wait_cycles);
-          }
+        {
+          idle.wait([&] { return count1[i] != 0; });
           (*reductionFct)(threadIndex,i,ptr);
         }
         
@@ -306,17 +198,13 @@ namespace embree
         flag0 = 0;
         __memory_barrier();
         flag1 = 1;
+        idle.notify();
       }			
       else
       {					
         count1[threadIndex] = 1;
-        {
-          unsigned int wait_cycles = MIN_MIC_BARRIER_WAIT_CYCLES;
-          while (likely(flag1 == 0))
-          {
-            pause(wait_cycles);
-          }
-        }
+        idle.notify();
+        idle.wait([&] { return flag1 != 0; });
       }		
     }				             	
   }
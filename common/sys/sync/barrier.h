@@ -18,6 +18,7 @@
 
 #include "sys/platform.h"
 #include "sys/intrinsics.h"
+#include "idle.h"
 
 namespace embree
 {
@@ -73,14 +74,16 @@ namespace embree
       cntr = 0;
     }
 
-    void wait (size_t numThreads) {
-      atomic_add((atomic_t*)&cntr,1);
-      while (cntr != numThreads) __pause_cpu();
+    void wait (size_t numThreads) 
+    {
+      if (atomic_add((atomic_t*)&cntr,1) == numThreads-1) idle.notify();
+      else idle.wait([&] { return cntr == numThreads; });
     }
 
   private:
     volatile atomic_t cntr;
     char align[64-sizeof(atomic_t)];
+    IdleWait idle;
   };
 
   // =================================================
@@ -105,15 +108,12 @@ namespace embree
       volatile unsigned int flag1;
       volatile unsigned int fill[16-3];
       volatile unsigned int numThreads;
+      IdleWait idle;
       
       LinearBarrierActive (size_t numThreads = 0);
 
       void init(size_t numThreads);
 
-      __forceinline void pause(unsigned int &cycles) {
-	__pause_cpu_expfalloff(cycles,MAX_MIC_BARRIER_WAIT_CYCLES);
-      }
-
       void wait (const size_t threadIndex, const size_t threadCount); // FIXME: remove second parameter
       void waitForThreads(const size_t threadIndex, const size_t threadCount);
 
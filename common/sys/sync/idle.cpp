@@ -0,0 +1,43 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "idle.h"
+
+namespace embree
+{
+  size_t IdlePolicy::spinRounds = IdlePolicy::DEFAULT_SPIN_ROUNDS;
+  size_t IdlePolicy::yieldRounds = IdlePolicy::DEFAULT_YIELD_ROUNDS;
+
+  void IdlePolicy::set(size_t spinRounds_in, size_t yieldRounds_in)
+  {
+    spinRounds = spinRounds_in;
+    yieldRounds = yieldRounds_in;
+  }
+
+  void IdleWait::notify()
+  {
+    /* a full fence orders the change of the condition before reading the sleeper count */
+#if defined(__MIC__)
+    atomic_t dummy = 0; atomic_add(&dummy,0);
+#else
+    _mm_mfence();
+#endif
+    if (numSleeping == 0) return;
+    mutex.lock();
+    condition.broadcast();
+    mutex.unlock();
+  }
+}
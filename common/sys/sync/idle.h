@@ -0,0 +1,88 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "../platform.h"
+#include "../intrinsics.h"
+#include "../thread.h"
+#include "mutex.h"
+#include "condition.h"
+
+namespace embree
+{
+  /*! Controls how threads behave while waiting. A waiting thread first
+   *  spins using pause instructions, then yields its time slice, and
+   *  finally blocks until it gets woken up. */
+  struct IdlePolicy
+  {
+    static const size_t DEFAULT_SPIN_ROUNDS = 1024;
+    static const size_t DEFAULT_YIELD_ROUNDS = 64;
+
+    /*! sets the number of pause and yield rounds before blocking */
+    static void set(size_t spinRounds, size_t yieldRounds);
+
+    /*! spins and yields until the predicate becomes true, returns false
+     *  if the thread should block as the predicate did not become true */
+    template<typename Predicate>
+      static __forceinline bool spin(const Predicate& pred)
+    {
+      for (size_t i=0; i<spinRounds; i++) {
+        if (pred()) return true;
+        __pause_cpu();
+      }
+      for (size_t i=0; i<yieldRounds; i++) {
+        if (pred()) return true;
+        yield();
+      }
+      return pred();
+    }
+
+  public:
+    static size_t spinRounds;   //!< number of pause rounds before yielding
+    static size_t yieldRounds;  //!< number of yield rounds before blocking
+  };
+
+  /*! Lets threads wait for some condition following the idle policy. The
+   *  thread that makes the condition true has to call notify. */
+  class IdleWait
+  {
+  public:
+    IdleWait () : numSleeping(0) {}
+
+    /*! waits until the predicate becomes true */
+    template<typename Predicate>
+      __forceinline void wait(const Predicate& pred) 
+    {
+      if (IdlePolicy::spin(pred)) return;
+
+      /* the atomic increment orders the sleeper count before checking the predicate */
+      mutex.lock();
+      atomic_add(&numSleeping,+1);
+      while (!pred()) condition.wait(mutex);
+      atomic_add(&numSleeping,-1);
+      mutex.unlock();
+    }
+
+    /*! wakes up blocked threads */
+    void notify();
+
+  private:
+    MutexSys mutex;
+    ConditionSys condition;
+    volatile atomic_t numSleeping;
+  };
+}
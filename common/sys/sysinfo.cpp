@@ -18,6 +18,8 @@
 #include "intrinsics.h"
 #include "stl/string.h"
 
+#include <algorithm>
+
 ////////////////////////////////////////////////////////////////////////////////
 /// All Platforms
 ////////////////////////////////////////////////////////////////////////////////
@@ -246,6 +248,33 @@ namespace embree
     if (features & CPU_FEATURE_KNC   ) str += "KNC ";
     return str;
   }
+
+  /*! converts the package and core IDs reported by the operating
+   *  system into dense indices and enumerates the SMT siblings */
+  static void normalizeThreadTopology(std::vector<ThreadLocation>& threads)
+  {
+    std::vector<size_t> packages;
+    std::vector<std::pair<size_t,size_t> > cores;
+    for (size_t i=0; i<threads.size(); i++) {
+      packages.push_back(threads[i].package);
+      cores.push_back(std::make_pair(threads[i].package,threads[i].core));
+    }
+    std::sort(packages.begin(),packages.end());
+    packages.erase(std::unique(packages.begin(),packages.end()),packages.end());
+    std::sort(cores.begin(),cores.end());
+    cores.erase(std::unique(cores.begin(),cores.end()),cores.end());
+
+    std::vector<size_t> siblings(cores.size(),0);
+    for (size_t i=0; i<threads.size(); i++) 
+    {
+      const std::pair<size_t,size_t> id(threads[i].package,threads[i].core);
+      const size_t core = std::lower_bound(cores.begin(),cores.end(),id)-cores.begin();
+      const size_t first = std::lower_bound(cores.begin(),cores.end(),std::make_pair(id.first,size_t(0)))-cores.begin();
+      threads[i].package = std::lower_bound(packages.begin(),packages.end(),id.first)-packages.begin();
+      threads[i].core = core-first;
+      threads[i].smt = siblings[core]++;
+    }
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -280,9 +309,51 @@ namespace embree
 #endif
   }
 
+  static std::vector<ThreadLocation> computeThreadTopology()
+  {
+    /* without topology information every logical thread is a core of its own */
+    std::vector<ThreadLocation> threads(getNumberOfLogicalThreads());
+    for (size_t i=0; i<threads.size(); i++) {
+      threads[i].package = 0;
+      threads[i].core = i;
+    }
+
+    /* processor masks cover only the first 64 logical threads */
+    DWORD bytes = 0;
+    GetLogicalProcessorInformation(NULL,&bytes);
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(bytes/sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (info.size() && GetLogicalProcessorInformation(&info[0],&bytes)) 
+    {
+      size_t core = 0, package = 0;
+      for (size_t i=0; i<info.size(); i++) 
+      {
+        const bool isCore = info[i].Relationship == RelationProcessorCore;
+        const bool isPackage = info[i].Relationship == RelationProcessorPackage;
+        if (!isCore && !isPackage) continue;
+        for (size_t j=0; j<threads.size() && j<8*sizeof(ULONG_PTR); j++) {
+          if ((info[i].ProcessorMask & (ULONG_PTR(1) << j)) == 0) continue;
+          if (isCore) threads[j].core = core;
+          else        threads[j].package = package;
+        }
+        if (isCore) core++; else package++;
+      }
+    }
+    normalizeThreadTopology(threads);
+    return threads;
+  }
+
+  const std::vector<ThreadLocation>& getThreadTopology() {
+    static const std::vector<ThreadLocation> threads = computeThreadTopology();
+    return threads;
+  }
+
   size_t getNumberOfCores() {
     static int nCores = -1;
-    if (nCores == -1) nCores = getNumberOfLogicalThreads(); // FIXME: detect if hyperthreading is enabled
+    if (nCores == -1) {
+      const std::vector<ThreadLocation>& threads = getThreadTopology();
+      nCores = 0;
+      for (size_t i=0; i<threads.size(); i++) nCores += threads[i].smt == 0;
+    }
     if (nCores ==  0) nCores = 1;
     return nCores;
   }
@@ -363,9 +434,46 @@ namespace embree
     return nThreads;
   }
 
+  /*! reads an integer from a file, returns false on failure */
+  static bool readInt(const char* fileName, size_t& value)
+  {
+    FILE* file = fopen(fileName,"r");
+    if (file == NULL) return false;
+    unsigned long v = 0;
+    const bool ok = fscanf(file,"%lu",&v) == 1;
+    fclose(file);
+    value = v;
+    return ok;
+  }
+
+  static std::vector<ThreadLocation> computeThreadTopology()
+  {
+    std::vector<ThreadLocation> threads(getNumberOfLogicalThreads());
+    for (size_t i=0; i<threads.size(); i++) 
+    {
+      /* without topology information every logical thread is a core of its own */
+      char fileName[256];
+      sprintf(fileName,"/sys/devices/system/cpu/cpu%d/topology/physical_package_id",int(i));
+      if (!readInt(fileName,threads[i].package)) threads[i].package = 0;
+      sprintf(fileName,"/sys/devices/system/cpu/cpu%d/topology/core_id",int(i));
+      if (!readInt(fileName,threads[i].core)) threads[i].core = i;
+    }
+    normalizeThreadTopology(threads);
+    return threads;
+  }
+
+  const std::vector<ThreadLocation>& getThreadTopology() {
+    static const std::vector<ThreadLocation> threads = computeThreadTopology();
+    return threads;
+  }
+
   size_t getNumberOfCores() {
     static int nCores = -1;
-    if (nCores == -1) nCores = sysconf(_SC_NPROCESSORS_CONF)/2; // FIXME: detect if hyperthreading is enabled
+    if (nCores == -1) {
+      const std::vector<ThreadLocation>& threads = getThreadTopology();
+      nCores = 0;
+      for (size_t i=0; i<threads.size(); i++) nCores += threads[i].smt == 0;
+    }
     if (nCores ==  0) nCores = 1;
     return nCores;
   }
@@ -76,6 +76,17 @@ namespace embree
   
   /*! return the number of cores of the system */
   size_t getNumberOfCores();
+
+  /*! location of a logical thread in the processor topology */
+  struct ThreadLocation 
+  {
+    size_t package;  //!< index of the physical package (socket)
+    size_t core;     //!< index of the core inside the package
+    size_t smt;      //!< index of the logical thread among the SMT siblings of the core
+  };
+
+  /*! returns the location of each logical thread of the system */
+  const std::vector<ThreadLocation>& getThreadTopology();
   
   /*! returns the size of the terminal window in characters */
   int getTerminalWidth();
@@ -16,6 +16,7 @@
 
 #include "taskscheduler.h"
 #include "taskscheduler_sys.h"
+#include "taskscheduler_stealing.h"
 #if defined(__MIC__)
 #include "taskscheduler_mic.h"
 #endif
@@ -39,20 +40,31 @@ namespace embree
   };
   
   TaskScheduler* TaskScheduler::instance = NULL;
+  __thread ssize_t TaskScheduler::workerIndex = -1;
 
-  void TaskScheduler::create(size_t numThreads)
+  void TaskScheduler::create(size_t numThreads, const std::string& type, const std::string& affinity)
   {
     if (instance)
       THROW_RUNTIME_ERROR("Embree threads already running.");
 
+    AffinityPolicy policy;
+    if (!parseAffinityPolicy(affinity,policy))
+      THROW_RUNTIME_ERROR("unknown thread affinity: "+affinity);
+
     /* enable fast pthreads tasking system */
+    if (type == "default") {
 #if defined(__MIC__)
-    instance = new TaskSchedulerMIC; 
-    //instance = new TaskSchedulerSys;
+      instance = new TaskSchedulerMIC; 
+      //instance = new TaskSchedulerSys;
 #else
-    instance = new TaskSchedulerSys; 
+      instance = new TaskSchedulerSys; 
 #endif
+    }
+    else if (type == "sys") instance = new TaskSchedulerSys;
+    else if (type == "stealing") instance = new TaskSchedulerStealing;
+    else THROW_RUNTIME_ERROR("unknown task scheduler: "+type);
 
+    instance->affinity = policy;
     instance->createThreads(numThreads);
   }
 
@@ -62,6 +74,10 @@ namespace embree
     return instance->numEnabledThreads;
   }
 
+  ssize_t TaskScheduler::getThreadIndex() {
+    return workerIndex;
+  }
+
   size_t TaskScheduler::enableThreads(size_t N)
   {
     if (!instance) THROW_RUNTIME_ERROR("Embree threads not running.");
@@ -119,7 +135,7 @@ namespace embree
   }
   
   TaskScheduler::TaskScheduler () 
-    : terminateThreads(false), defaultNumThreads(true), numThreads(0), numEnabledThreads(0) {}
+    : terminateThreads(false), defaultNumThreads(true), numThreads(0), affinity(AFFINITY_DEFAULT), numEnabledThreads(0) {}
 
   void TaskScheduler::createThreads(size_t numThreads_in)
   {
@@ -137,10 +153,11 @@ namespace embree
     }
 #endif
     numEnabledThreads = numThreads;
+    init(numThreads);
 
     /* generate all threads */
-    for (size_t t=0; t<numThreads; t++) {
-      threads.push_back(createThread((thread_func)threadFunction,new Thread(t,numThreads,this),4*1024*1024,t));
+    for (size_t t=0; t<numThreads && spawnsThreads(); t++) {
+      threads.push_back(createThread((thread_func)threadFunction,new Thread(t,numThreads,this),4*1024*1024,getThreadPlacement(affinity,t)));
     }
 
     TaskLogger::init(numThreads);
@@ -152,7 +169,9 @@ namespace embree
     Thread thread = *(Thread*) ptr;
     delete (Thread*) ptr;
 
+    workerIndex = thread.threadIndex;
     thread.scheduler->run(thread.threadIndex,thread.threadCount);
+    workerIndex = -1;
   }
   catch (const std::exception& e) {
     std::cout << "Error: " << e.what() << std::endl;
@@ -160,7 +179,7 @@ namespace embree
   }
 
   LockStepTaskScheduler* LockStepTaskScheduler::instance() {
-    return scheduler;
+    return executingTask ? NULL : scheduler; // tasks cannot dispatch nested lockstep tasks
   }
 
   void LockStepTaskScheduler::setInstance(LockStepTaskScheduler* inst) {
@@ -176,6 +195,7 @@ namespace embree
   }
 
   __thread LockStepTaskScheduler* LockStepTaskScheduler::scheduler = NULL;
+  __thread LockStepTaskScheduler* LockStepTaskScheduler::executingTask = NULL;
 
   void LockStepTaskScheduler::syncThreads(const size_t threadID, const size_t numThreads) {
     taskBarrier.wait(threadID,numThreads);
@@ -211,6 +231,7 @@ namespace embree
   {
     if (threadID == 0) {
       taskCounter.reset(0);
+      runningThreads.reset(numThreads);
       this->numThreads = numThreads;
     }
     
@@ -219,7 +240,11 @@ namespace embree
 
     if (taskPtr) {
       if (threadID < numThreads) {
+        LockStepTaskScheduler* executing = executingTask;
+        executingTask = this;
 	(*taskPtr)((void*)data,threadID,numThreads);
+        finishTask();
+        executingTask = executing;
       }
       syncThreads(threadID, numThreads);
       return false;
@@ -227,11 +252,15 @@ namespace embree
 
     if (taskPtr2) {
       if (threadID < numThreads) {
+        LockStepTaskScheduler* executing = executingTask;
+        executingTask = this;
 	while (true) {
 	  size_t taskID = taskCounter.inc();
 	  if (taskID >= numTasks) break;
 	  (*taskPtr2)((void*)data,threadID,numThreads,taskID,numTasks);
 	}
+        finishTask();
+        executingTask = executing;
       }
       syncThreads(threadID, numThreads);
       return false;
@@ -239,6 +268,14 @@ namespace embree
     return true;
   }
 
+  void LockStepTaskScheduler::finishTask()
+  {
+    runningThreads.dec();
+    while (runningThreads > 0) {
+      if (!ParallelTaskSet::help()) __pause_cpu();
+    }
+  }
+
   void LockStepTaskScheduler::leave(const size_t threadID, const size_t numThreads)
   {
     assert(threadID == 0);
@@ -258,6 +295,90 @@ namespace embree
   // ================================================================================
   // ================================================================================
 
+  bool ParallelTaskSet::process()
+  {
+    bool processed = false;
+    while (true)
+    {
+      /* claim a block of items, the blocks get smaller towards the end */
+      const size_t i = (size_t) next;
+      if (i >= N) break;
+      const size_t blockSize = max(minBlockSize,(N-i)/(2*numThreads));
+      const size_t begin = (size_t) next.add(blockSize);
+      if (begin >= N) break;
+      const size_t end = min(begin+blockSize,N);
+
+      run(data,begin,end);
+      completed.add(end-begin);
+      processed = true;
+    }
+    return processed;
+  }
+
+  void ParallelTaskSet::task_process(size_t threadIndex, size_t threadCount, size_t taskIndex, size_t taskCount, TaskScheduler::Event* event) {
+    process();
+  }
+
+  void ParallelTaskSet::execute()
+  {
+    /* inside a lockstep task the other threads of that lockstep scheduler help */
+    if (LockStepTaskScheduler* scheduler = LockStepTaskScheduler::executingTask)
+    {
+      /* publish the task set, if all slots are in use we process it alone */
+      LockStepTaskScheduler::TaskSetSlot* slot = NULL;
+      for (size_t i=0; i<LockStepTaskScheduler::MAX_TASK_SETS && slot == NULL; i++) {
+        LockStepTaskScheduler::TaskSetSlot& s = scheduler->taskSets[i];
+        if (s.set == NULL && atomic_cmpxchg_ptr<ParallelTaskSet>(&s.set,NULL,this) == NULL)
+          slot = &s;
+      }
+
+      /* process items and wait for blocks processed by other threads */
+      process();
+      while (!done()) __pause_cpu();
+
+      /* wait until no other thread accesses the task set anymore, the
+       * exchange orders the release of the slot before reading the
+       * users, as the increment of the users does in help() */
+      if (slot) {
+        atomic_xchg_ptr<ParallelTaskSet>(&slot->set,NULL);
+        while (slot->users) __pause_cpu();
+      }
+    }
+
+    /* otherwise the threads of the task scheduler help */
+    else 
+    {
+      const size_t threadCount = TaskScheduler::getNumThreads();
+      const ssize_t threadIndex = TaskScheduler::getThreadIndex();
+      const size_t taskCount = min(numThreads,(N+minBlockSize-1)/minBlockSize);
+      TaskScheduler::executeTask(threadIndex >= 0 ? threadIndex : threadCount,threadCount,_task_process,this,taskCount,"parallel_task_set");
+    }
+  }
+
+  bool ParallelTaskSet::help()
+  {
+    LockStepTaskScheduler* scheduler = LockStepTaskScheduler::executingTask;
+    if (scheduler == NULL) return false;
+
+    for (size_t i=0; i<LockStepTaskScheduler::MAX_TASK_SETS; i++)
+    {
+      LockStepTaskScheduler::TaskSetSlot& slot = scheduler->taskSets[i];
+      if (slot.set == NULL) continue;
+
+      /* the set cannot get released while we are a user of the slot */
+      slot.users.inc();
+      ParallelTaskSet* set = slot.set;
+      const bool processed = set && set->process();
+      slot.users.dec();
+      if (processed) return true;
+    }
+    return false;
+  }
+
+  // ================================================================================
+  // ================================================================================
+  // ================================================================================
+
   LockStepTaskScheduler4ThreadsLocalCore::LockStepTaskScheduler4ThreadsLocalCore()
   {
     taskPtr = NULL;
@@ -74,11 +74,11 @@ namespace embree
 
       __forceinline Task(Event* event, runFunction run, void* runData, size_t elts, completeFunction complete, void* completeData, const char* name)
         : event(event), run(run), runData(runData), elts(elts), complete(complete), completeData(completeData), 
-        started(elts), completed(elts), name(name), locks(0) {}
+        started(elts), completed(elts), unqueued(0), name(name), locks(0) {}
 
       __forceinline Task(Event* event, completeFunction complete, void* completeData, const char* name)
         : event(event), run(NULL), runData(NULL), elts(1), complete(complete), completeData(completeData), 
-        started(1), completed(1), name(name), locks(0) {}
+        started(1), completed(1), unqueued(0), name(name), locks(0) {}
 
     public:
       Event* event;
@@ -89,6 +89,7 @@ namespace embree
       void* completeData;          //!< data pointer to execute complete function
       AtomicCounter started;              //!< counts the number of started task set elements
       AtomicCounter completed;            //!< counts the number of completed task set elements
+      AtomicCounter unqueued;             //!< number of not started elements no queue references, used by work stealing
       const char* name;            //!< name of this task
       AtomicCounter locks;
     };
@@ -138,12 +139,16 @@ namespace embree
     /*! single instance of task scheduler */
     static TaskScheduler* instance;
     
-    /*! creates the threads */
-    static void create(size_t numThreads = 0);
+    /*! creates the threads, type selects the scheduler implementation ("default", "sys", or "stealing") 
+     *  and affinity the placement policy of the threads ("default", "none", "compact", "scatter", "cores", or "sockets") */
+    static void create(size_t numThreads = 0, const std::string& type = "default", const std::string& affinity = "default");
 
     /*! returns the number of threads used */
     static size_t getNumThreads();
 
+    /*! returns the index of the calling worker thread, or -1 if the calling thread is no worker thread */
+    static ssize_t getThreadIndex();
+
     /*! enables specified number of threads */
     static size_t enableThreads(size_t N);
 
@@ -174,6 +179,12 @@ namespace embree
     /*! creates all threads */
     void createThreads(size_t numThreads);
 
+    /*! allocates per thread state before the threads get started */
+    virtual void init(size_t numThreads) {}
+
+    /*! returns false if tasks get executed by threads of the application */
+    virtual bool spawnsThreads() const { return true; }
+
     /*! thread function */
     static void threadFunction(void* thread);
 
@@ -194,10 +205,12 @@ namespace embree
 
     /* thread handling */
   protected:
+    static __thread ssize_t workerIndex; //!< index of the calling worker thread, -1 for other threads
     volatile bool terminateThreads;
     std::vector<thread_t> threads;
     bool defaultNumThreads;
     size_t numThreads;
+    AffinityPolicy affinity;
     volatile size_t numEnabledThreads;
     __forceinline bool isEnabled(size_t threadIndex) const { return threadIndex < numEnabledThreads; }
   };
@@ -221,6 +234,8 @@ namespace embree
   }
   
 
+  class ParallelTaskSet;
+
   class LockStepTaskScheduler
   {
   public:
@@ -255,6 +270,7 @@ namespace embree
     };
 
     static __thread LockStepTaskScheduler* scheduler;
+    static __thread LockStepTaskScheduler* executingTask; //!< scheduler whose task the calling thread executes, NULL otherwise
     static LockStepTaskScheduler* instance();
     static void setInstance(LockStepTaskScheduler*);
 
@@ -266,6 +282,7 @@ namespace embree
     typedef void (*runFunction2)(void* data, const size_t threadID, const size_t numThreads, const size_t taskID, const size_t numTasks);
 
     __aligned(64) AlignedAtomicCounter32 taskCounter;
+    __aligned(64) AlignedAtomicCounter32 runningThreads;
     __aligned(64) runFunction taskPtr;
     __aligned(64) runFunction2 taskPtr2;
     size_t numTasks;
@@ -288,6 +305,19 @@ namespace embree
 
     bool dispatchTask(const size_t threadID, size_t numThreads);
 
+    /*! helps executing nested task sets until all threads finished their part of the task */
+    void finishTask();
+
+    /*! task sets published by threads executing a task of this scheduler */
+    struct __aligned(64) TaskSetSlot 
+    {
+      TaskSetSlot () : set(NULL) {}
+      ParallelTaskSet* volatile set;
+      AtomicCounter users;       //!< number of threads accessing the slot
+    };
+    static const size_t MAX_TASK_SETS = 64;
+    TaskSetSlot taskSets[MAX_TASK_SETS];
+
     void dispatchTaskMainLoop(const size_t threadID, const size_t numThreads);
     void releaseThreads(const size_t numThreads);
 
@@ -335,6 +365,48 @@ namespace embree
   };
 
   extern __aligned(64) LockStepTaskScheduler g_regression_task_scheduler;
+
+  /*! Set of N work items that is executed in parallel and can get
+   *  spawned from inside other tasks. Each joining thread repeatedly
+   *  claims a block of items whose size shrinks with the number of
+   *  remaining items. Inside a lockstep task the other threads of the
+   *  lockstep scheduler help once they finished their part of the
+   *  task, otherwise the threads of the task scheduler help. */
+  class __hidden ParallelTaskSet
+  {
+  public:
+
+    /*! function executed for the items [begin,end) */
+    typedef void (*runFunction)(void* data, size_t begin, size_t end);
+
+    ParallelTaskSet (runFunction run, void* data, size_t N, size_t minBlockSize, size_t numThreads)
+      : run(run), data(data), N(N), minBlockSize(minBlockSize ? minBlockSize : 1), numThreads(numThreads ? numThreads : 1), next(0), completed(0) {}
+
+    /*! executes all items, returns when all items are completed */
+    void execute();
+
+    /*! helps executing some task set spawned inside a task of the lockstep scheduler the calling thread works for, returns false if none was found */
+    static bool help();
+
+  private:
+
+    /*! processes blocks until no block is left, returns false if no block was processed */
+    bool process();
+
+    /*! returns true if all items got completed */
+    __forceinline bool done() const { return (size_t)completed == N; }
+
+    TASK_RUN_FUNCTION(ParallelTaskSet,task_process);
+
+  private:
+    runFunction run;
+    void* data;
+    size_t N;
+    size_t minBlockSize;
+    size_t numThreads;
+    __aligned(64) AtomicCounter next;       //!< next item to claim
+    __aligned(64) AtomicCounter completed;  //!< number of completed items
+  };
   
   class __aligned(64) LockStepTaskScheduler4ThreadsLocalCore
   {
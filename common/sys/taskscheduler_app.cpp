@@ -0,0 +1,134 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "taskscheduler_app.h"
+#include "tasklogger.h"
+
+namespace embree
+{
+  void TaskSchedulerApp::create(size_t numThreads, spawnFunction spawn, waitFunction wait, void* userPtr)
+  {
+    if (instance)
+      THROW_RUNTIME_ERROR("Embree threads already running.");
+
+    TaskSchedulerApp* scheduler = new TaskSchedulerApp(spawn,wait,userPtr);
+    scheduler->createThreads(numThreads);
+    scheduler->threadIndexStates.resize(scheduler->numThreads,0);
+    instance = scheduler;
+  }
+
+  TaskSchedulerApp::TaskSchedulerApp(spawnFunction spawn, waitFunction wait, void* userPtr)
+    : spawnFunc(spawn), waitFunc(wait), userPtr(userPtr) {}
+
+  void TaskSchedulerApp::add(ssize_t threadIndex, QUEUE queue, Task* task)
+  {
+    if (task->event)
+      task->event->inc();
+
+    /* the application decides when and where the elements run, thus the queue is ignored */
+    spawnFunc(userPtr,execute,task,task->elts);
+  }
+
+  size_t TaskSchedulerApp::claimThreadIndex()
+  {
+    /* an index can get claimed if it is free or if all its users wait
+     * for other tasks, like a worker thread that helps while waiting */
+    while (true) 
+    {
+      for (size_t i=0; i<numEnabledThreads; i++) {
+        volatile atomic_t* state = (volatile atomic_t*) &threadIndexStates[i];
+        const atomic_t s = *state;
+        if ((s & 1) == 0 && atomic_cmpxchg(state,s,s+1) == s)
+          return i;
+      }
+      yield();
+    }
+  }
+
+  void TaskSchedulerApp::releaseThreadIndex(size_t threadIndex) {
+    atomic_add((volatile atomic_t*) &threadIndexStates[threadIndex],-1);
+  }
+
+  void TaskSchedulerApp::execute(void* ptr, size_t taskIndex, size_t taskCount)
+  {
+    /* application threads are no Embree threads, thus each element
+     * claims a thread index that no other running element uses */
+    Task* task = (Task*) ptr;
+    TaskSchedulerApp* scheduler = (TaskSchedulerApp*) instance;
+    scheduler->runningElements.inc();
+    const size_t threadCount = scheduler->numEnabledThreads;
+    const ssize_t outerIndex = workerIndex;
+    const size_t threadIndex = workerIndex = scheduler->claimThreadIndex();
+
+    /* run the task */
+    TaskScheduler::Event* event = task->event;
+    if (task->run) {
+      size_t taskID = TaskLogger::beginTask(threadIndex,task->name,taskIndex);
+      task->run(task->runData,threadIndex,threadCount,taskIndex,task->elts,event);
+      TaskLogger::endTask(threadIndex,taskID);
+    }
+
+    /* complete the task */
+    if (--task->completed == 0) {
+      if (task->complete) {
+        size_t taskID = TaskLogger::beginTask(threadIndex,task->name,0);
+        task->complete(task->completeData,threadIndex,threadCount,event);
+        TaskLogger::endTask(threadIndex,taskID);
+      }
+      if (event) event->dec();
+    }
+
+    scheduler->releaseThreadIndex(threadIndex);
+    workerIndex = outerIndex;
+
+    /* the scheduler may get destroyed once the last element left */
+    scheduler->runningElements.dec();
+  }
+
+  void TaskSchedulerApp::terminate() 
+  {
+    /* elements that completed their task may still release their thread index */
+    while (runningElements) 
+      yield();
+  }
+
+  bool TaskSchedulerApp::triggered(void* event) {
+    return ((Event*)event)->triggered();
+  }
+
+  void TaskSchedulerApp::wait(size_t threadIndex, size_t threadCount, Event* event)
+  {
+    event->dec();
+
+    /* an element that waits lends its thread index to the elements of other threads */
+    const ssize_t index = workerIndex;
+    atomic_t state = 0;
+    if (index >= 0) state = atomic_add((volatile atomic_t*) &threadIndexStates[index],1);
+    workerIndex = -1;
+
+    /* the calling thread may be a thread of the application pool, thus let it help the pool */
+    if (waitFunc) waitFunc(userPtr,triggered,event);
+    while (!event->triggered())
+      __pause_cpu();
+
+    /* take the thread index back once the borrowing elements returned it */
+    if (index >= 0) {
+      while (atomic_cmpxchg((volatile atomic_t*) &threadIndexStates[index],state+1,state) != state+1)
+        yield();
+    }
+    workerIndex = index;
+  }
+}
@@ -0,0 +1,84 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "taskscheduler.h"
+
+namespace embree
+{
+  /*! Task scheduler that creates no threads of its own. All tasks get
+   *  forwarded to the thread pool of the application through a spawn
+   *  and an optional wait callback. */
+  class __hidden TaskSchedulerApp : public TaskScheduler
+  {
+  public:
+
+    /*! function the application invokes for each element of a spawned task */
+    typedef void (*taskFunction)(void* task, size_t taskIndex, size_t taskCount);
+
+    /*! spawns taskCount invocations of the task function into the application pool */
+    typedef void (*spawnFunction)(void* userPtr, taskFunction func, void* task, size_t taskCount);
+
+    /*! condition the wait function of the application waits for */
+    typedef bool (*conditionFunction)(void* ptr);
+
+    /*! lets the calling thread help the application pool until the condition holds */
+    typedef void (*waitFunction)(void* userPtr, conditionFunction cond, void* ptr);
+
+    /*! creates the single task scheduler instance */
+    static void create(size_t numThreads, spawnFunction spawn, waitFunction wait, void* userPtr);
+
+  private:
+
+    /*! construction */
+    TaskSchedulerApp(spawnFunction spawn, waitFunction wait, void* userPtr);
+
+    /*! tasks get executed by the threads of the application */
+    bool spawnsThreads() const { return false; }
+
+    /*! forwards all elements of the task to the application */
+    void add(ssize_t threadIndex, QUEUE queue, Task* task);
+
+    /*! waits for an event out of a task */
+    void wait(size_t threadIndex, size_t threadCount, Event* event);
+
+    /*! there are no threads of our own */
+    void run(size_t threadIndex, size_t threadCount) {}
+
+    /*! waits until no element accesses the scheduler anymore */
+    void terminate();
+
+    /*! executes one element of a task on some thread of the application */
+    static void execute(void* task, size_t taskIndex, size_t taskCount);
+
+    /*! returns true if the event got triggered */
+    static bool triggered(void* event);
+
+    /*! claims a thread index no other running element uses, waits if all indices are in use */
+    size_t claimThreadIndex();
+
+    /*! releases a thread index claimed before */
+    void releaseThreadIndex(size_t threadIndex);
+
+  private:
+    spawnFunction spawnFunc;  //!< spawns tasks into the application pool
+    waitFunction waitFunc;    //!< lets a thread help the application pool, may be NULL
+    void* userPtr;            //!< user pointer passed to both callbacks
+    std::vector<atomic_t> threadIndexStates; //!< per thread index, odd while some element uses the index, even if free or all its users wait
+    AtomicCounter runningElements;           //!< number of elements inside execute
+  };
+}
@@ -0,0 +1,228 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "taskscheduler_stealing.h"
+#include "tasklogger.h"
+
+namespace embree
+{
+  bool TaskSchedulerStealing::TaskDeque::push(Task* task)
+  {
+    const atomic_t b = bottom, t = top;
+    if (b-t >= (atomic_t)SIZE) return false;
+    tasks[b&(SIZE-1)] = task;
+    __memory_barrier();
+    bottom = b+1;
+    return true;
+  }
+
+  TaskScheduler::Task* TaskSchedulerStealing::TaskDeque::pop()
+  {
+    /* the exchange orders the store to bottom before the load of top */
+    const atomic_t b = bottom-1;
+    atomic_xchg(&bottom,b);
+    const atomic_t t = top;
+    if (t > b) { bottom = b+1; return NULL; }
+
+    /* for the last task we race with stealing threads */
+    Task* task = tasks[b&(SIZE-1)];
+    if (t == b) {
+      if (atomic_cmpxchg(&top,t,t+1) != t) task = NULL;
+      bottom = b+1;
+    }
+    return task;
+  }
+
+  TaskScheduler::Task* TaskSchedulerStealing::TaskDeque::steal()
+  {
+    const atomic_t t = top;
+    __memory_barrier();
+    const atomic_t b = bottom;
+    if (t >= b) return NULL;
+    Task* task = tasks[t&(SIZE-1)];
+    __memory_barrier();
+    if (atomic_cmpxchg(&top,t,t+1) != t) return NULL;
+    return task;
+  }
+
+  TaskSchedulerStealing::TaskSchedulerStealing()
+    : threadState(NULL), numThreadStates(0), begin(0), end(0), tasks(1024) {}
+
+  TaskSchedulerStealing::~TaskSchedulerStealing() {
+    delete[] threadState;
+  }
+
+  void TaskSchedulerStealing::init(size_t numThreads)
+  {
+    delete[] threadState;
+    threadState = new ThreadState[numThreads];
+    numThreadStates = numThreads;
+    for (size_t i=0; i<numThreads; i++)
+      threadState[i].random = (unsigned int)(i+1);
+  }
+
+  void TaskSchedulerStealing::add(ssize_t threadIndex, QUEUE queue, Task* task)
+  {
+    if (task->event)
+      task->event->inc();
+
+    /* the queue references one element, the others get referenced when the task executes */
+    task->unqueued = task->elts-1;
+    push(queue,task);
+  }
+
+  void TaskSchedulerStealing::push(QUEUE queue, Task* task)
+  {
+    /* worker threads push to their own deque */
+    if (workerIndex < 0 || !threadState[workerIndex].deque.push(task))
+    {
+      mutex.lock();
+
+      /*! resize array if too small */
+      if (end-begin == tasks.size())
+      {
+        size_t s0 = 1*tasks.size();
+        size_t s1 = 2*tasks.size();
+        tasks.resize(s1);
+        for (size_t i=begin; i!=end; i++)
+          tasks[i&(s1-1)] = tasks[i&(s0-1)];
+      }
+
+      /*! insert task to correct end of list */
+      if (queue == GLOBAL_FRONT) { size_t i = (begin-1)&(tasks.size()-1); tasks[i] = task; begin--; }
+      else                       { size_t i = (end    )&(tasks.size()-1); tasks[i] = task; end++;   }
+      mutex.unlock();
+    }
+
+    idle.notify();
+  }
+
+  TaskScheduler::Task* TaskSchedulerStealing::take()
+  {
+    if (begin == end) return NULL;
+    Lock<AtomicMutex> lock(mutex);
+    if (begin == end) return NULL;
+    size_t i = (end-1)&(tasks.size()-1);
+    end--;
+    return tasks[i];
+  }
+
+  TaskScheduler::Task* TaskSchedulerStealing::steal(size_t threadIndex)
+  {
+    /* start at a random victim to spread the stealing threads */
+    ThreadState& state = threadState[threadIndex];
+    state.random = state.random*1103515245+12345;
+    const size_t N = numThreadStates;
+    const size_t start = (state.random >> 16) % N;
+
+    for (size_t i=0; i<N; i++)
+    {
+      size_t victim = start+i;
+      if (victim >= N) victim -= N;
+      if (victim == threadIndex) continue;
+      TaskDeque& deque = threadState[victim].deque;
+      if (deque.empty()) continue;
+      if (Task* task = deque.steal()) return task;
+    }
+    return NULL;
+  }
+
+  void TaskSchedulerStealing::execute(size_t threadIndex, Task* task)
+  {
+    /* Claim one element. Each queued reference to the task can claim
+     * an element, thus the task gets pushed once for up to two of the
+     * remaining elements. The number of threads working on the task
+     * doubles with each step, and references never outnumber the
+     * not started elements, thus the task stays alive while queued. */
+    const ssize_t elt = --task->started;
+    for (size_t i=0; i<2; i++) {
+      if (--task->unqueued < 0) { task->unqueued++; break; }
+      push(GLOBAL_BACK,task);
+    }
+
+    /* run the task */
+    TaskScheduler::Event* event = task->event;
+    if (task->run) {
+      size_t taskID = TaskLogger::beginTask(threadIndex,task->name,elt);
+      task->run(task->runData,threadIndex,numEnabledThreads,elt,task->elts,task->event);
+      TaskLogger::endTask(threadIndex,taskID);
+    }
+
+    /* complete the task */
+    if (--task->completed == 0) {
+      if (task->complete) {
+        size_t taskID = TaskLogger::beginTask(threadIndex,task->name,0);
+        task->complete(task->completeData,threadIndex,numEnabledThreads,task->event);
+        TaskLogger::endTask(threadIndex,taskID);
+      }
+      if (event) {
+        event->dec();
+        finished.notify();
+      }
+    }
+  }
+
+  bool TaskSchedulerStealing::work(size_t threadIndex)
+  {
+    Task* task = threadState[threadIndex].deque.pop();
+    if (task == NULL) task = take();
+    if (task == NULL) task = steal(threadIndex);
+    if (task == NULL) return false;
+    execute(threadIndex,task);
+    return true;
+  }
+
+  void TaskSchedulerStealing::wait(size_t threadIndex, size_t threadCount, Event* event)
+  {
+    event->dec();
+
+    /* non-worker threads cannot help executing tasks, thus wait following the idle policy */
+    if (workerIndex < 0 || !isEnabled(workerIndex)) {
+      finished.wait([&] { return event->triggered(); });
+    }
+    else {
+      while (!event->triggered()) {
+        if (!work(workerIndex)) __pause_cpu();
+      }
+    }
+  }
+
+  bool TaskSchedulerStealing::hasTasks() const
+  {
+    if (begin != end) return true;
+    for (size_t i=0; i<numThreadStates; i++)
+      if (!threadState[i].deque.empty()) return true;
+    return false;
+  }
+
+  void TaskSchedulerStealing::run(size_t threadIndex, size_t threadCount)
+  {
+    while (!terminateThreads)
+    {
+      if (isEnabled(threadIndex) && work(threadIndex)) 
+        continue;
+
+      /* wait for new tasks following the idle policy */
+      idle.wait([&] { return terminateThreads || (isEnabled(threadIndex) && hasTasks()); });
+    }
+  }
+
+  void TaskSchedulerStealing::terminate()
+  {
+    terminateThreads = true;
+    idle.notify();
+  }
+}
@@ -0,0 +1,126 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "taskscheduler.h"
+#include "sys/sync/mutex.h"
+#include "sys/sync/idle.h"
+
+namespace embree
+{
+  /*! Task scheduler with one lock-free deque per thread and work
+   *  stealing. Tasks added by a worker thread go to the deque of that
+   *  thread, tasks added by other threads go to a small global queue. */
+  class __hidden TaskSchedulerStealing : public TaskScheduler
+  {
+  public:
+
+    /*! Chase-Lev deque of tasks, the owning thread pushes and pops at
+     *  the bottom, other threads steal from the top */
+    struct __aligned(64) TaskDeque
+    {
+      static const size_t SIZE = 1024;
+
+      TaskDeque () : top(0), bottom(0) {}
+
+      /*! returns true if the deque contains tasks */
+      __forceinline bool empty() const { return bottom <= top; }
+
+      /*! pushes a task to the bottom, fails if the deque is full (owner only) */
+      bool push(Task* task);
+
+      /*! pops a task from the bottom (owner only) */
+      Task* pop();
+
+      /*! steals a task from the top (any thread) */
+      Task* steal();
+
+    public:
+      volatile atomic_t top;
+      char align0[64-sizeof(atomic_t)];
+      volatile atomic_t bottom;
+      char align1[64-sizeof(atomic_t)];
+      Task* volatile tasks[SIZE];
+    };
+
+    /*! per thread state */
+    struct __aligned(64) ThreadState
+    {
+      ALIGNED_STRUCT;
+
+      ThreadState () : random(0) {}
+
+    public:
+      TaskDeque deque;       //!< tasks spawned by this thread
+      unsigned int random;   //!< state for victim selection
+    };
+
+    /*! construction */
+    TaskSchedulerStealing();
+
+    /*! destruction */
+    ~TaskSchedulerStealing();
+
+  private:
+
+    /*! allocates the per thread deques */
+    void init(size_t numThreads);
+
+    /*! adds a task to the deque of the calling worker thread or the global queue */
+    void add(ssize_t threadIndex, QUEUE queue, Task* task);
+
+    /*! waits for an event out of a task */
+    void wait(size_t threadIndex, size_t threadCount, Event* event);
+
+    /*! processes the next task, returns false if none was found */
+    bool work(size_t threadIndex);
+
+    /*! thread function */
+    void run(size_t threadIndex, size_t threadCount);
+
+    /*! sets the terminate thread variable */
+    void terminate();
+
+  private:
+
+    /*! makes a task visible to other threads */
+    void push(QUEUE queue, Task* task);
+
+    /*! takes a task from the global queue */
+    Task* take();
+
+    /*! steals a task from the deque of some other thread */
+    Task* steal(size_t threadIndex);
+
+    /*! executes one element of a task */
+    void execute(size_t threadIndex, Task* task);
+
+    /*! returns true if any queue contains tasks */
+    bool hasTasks() const;
+
+  private:
+    ThreadState* threadState;      //!< state of each worker thread
+    size_t numThreadStates;        //!< number of allocated thread states
+
+    AtomicMutex mutex;             //!< protects the global queue
+    volatile size_t begin,end;     //!< current range of the global queue
+    std::vector<Task*> tasks;      //!< global queue for tasks of non-worker threads
+
+    IdleWait idle;                 //!< lets idle threads wait for new tasks
+    IdleWait finished;             //!< lets non-worker threads wait for the completion of their tasks
+  };
+}
@@ -189,8 +189,12 @@ namespace embree
 
   void TaskSchedulerSys::run(size_t threadIndex, size_t threadCount)
   {
-    while (!terminateThreads)
+    while (!terminateThreads) 
+    {
+      /* spin and yield for a while before blocking on the condition */
+      IdlePolicy::spin([&] { return begin != end || terminateThreads; });
       work(threadIndex,threadCount,true);
+    }
   }
 
   void TaskSchedulerSys::terminate() 
@@ -19,6 +19,7 @@
 #include "taskscheduler.h"
 #include "sys/sync/mutex.h"
 #include "sys/sync/condition.h"
+#include "sys/sync/idle.h"
 
 namespace embree
 {
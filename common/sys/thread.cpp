@@ -19,12 +19,78 @@
 #include "sys/stl/string.h"
 
 #include <iostream>
+#include <algorithm>
 #include <xmmintrin.h>
 
 #if defined(PTHREADS_WIN32)
 #pragma comment (lib, "pthreadVC.lib")
 #endif
 
+////////////////////////////////////////////////////////////////////////////////
+/// All Platforms
+////////////////////////////////////////////////////////////////////////////////
+
+namespace embree
+{
+  bool parseAffinityPolicy(const std::string& name, AffinityPolicy& policy)
+  {
+    if      (name == "default") policy = AFFINITY_DEFAULT;
+    else if (name == "none"   ) policy = AFFINITY_NONE;
+    else if (name == "compact") policy = AFFINITY_COMPACT;
+    else if (name == "scatter") policy = AFFINITY_SCATTER;
+    else if (name == "cores"  ) policy = AFFINITY_CORES;
+    else if (name == "sockets") policy = AFFINITY_SOCKETS;
+    else return false;
+    return true;
+  }
+
+  /*! orders logical threads by the fields of their locations, most significant field first */
+  struct ThreadPlacementOrder
+  {
+    ThreadPlacementOrder (const std::vector<ThreadLocation>& threads, AffinityPolicy policy)
+      : threads(threads), policy(policy) {}
+
+    __forceinline void key(size_t i, size_t k[3]) const 
+    {
+      const ThreadLocation& t = threads[i];
+      switch (policy) {
+      case AFFINITY_COMPACT: k[0] = t.package; k[1] = t.core;    k[2] = t.smt;     break;
+      case AFFINITY_SCATTER: k[0] = t.smt;     k[1] = t.core;    k[2] = t.package; break;
+      case AFFINITY_CORES  : k[0] = t.smt;     k[1] = t.package; k[2] = t.core;    break;
+      case AFFINITY_SOCKETS: k[0] = t.package; k[1] = t.smt;     k[2] = t.core;    break;
+      default              : k[0] = 0;         k[1] = 0;         k[2] = i;         break;
+      }
+    }
+
+    bool operator() (size_t a, size_t b) const 
+    {
+      size_t ka[3]; key(a,ka);
+      size_t kb[3]; key(b,kb);
+      if (ka[0] != kb[0]) return ka[0] < kb[0];
+      if (ka[1] != kb[1]) return ka[1] < kb[1];
+      if (ka[2] != kb[2]) return ka[2] < kb[2];
+      return a < b;
+    }
+
+    const std::vector<ThreadLocation>& threads;
+    AffinityPolicy policy;
+  };
+
+  ssize_t getThreadPlacement(AffinityPolicy policy, size_t threadIndex)
+  {
+    if (policy == AFFINITY_DEFAULT) return threadIndex;
+    if (policy == AFFINITY_NONE) return -1;
+
+    const std::vector<ThreadLocation>& threads = getThreadTopology();
+    if (threads.size() == 0) return threadIndex;
+
+    std::vector<size_t> order(threads.size());
+    for (size_t i=0; i<order.size(); i++) order[i] = i;
+    std::sort(order.begin(),order.end(),ThreadPlacementOrder(threads,policy));
+    return order[threadIndex % order.size()];
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Windows Platform
 ////////////////////////////////////////////////////////////////////////////////
@@ -33,6 +33,23 @@ namespace embree
   /*! set affinity of the calling thread */
   void setAffinity(ssize_t affinity);
 
+  /*! policies to place threads onto the logical threads of the system */
+  enum AffinityPolicy 
+  {
+    AFFINITY_DEFAULT,  //!< thread i runs on logical thread i
+    AFFINITY_NONE,     //!< threads are not pinned
+    AFFINITY_COMPACT,  //!< fills all SMT siblings of a core before using the next core
+    AFFINITY_SCATTER,  //!< alternates between packages and uses all cores before SMT siblings
+    AFFINITY_CORES,    //!< one thread per core package by package, SMT siblings only once all cores are used
+    AFFINITY_SOCKETS   //!< fills all cores of a package, then its SMT siblings, before using the next package
+  };
+
+  /*! converts the name of an affinity policy, returns false for unknown names */
+  bool parseAffinityPolicy(const std::string& name, AffinityPolicy& policy);
+
+  /*! returns the logical thread to pin the thread with the specified index to, or -1 if the thread should not get pinned */
+  ssize_t getThreadPlacement(AffinityPolicy policy, size_t threadIndex);
+
   /*! the thread calling this function gets yielded */
   void yield();
 
@@ -95,6 +95,58 @@ typedef void (*RTC_ERROR_FUNCTION)(const RTCError code, const char* str);
 /*! \brief Sets a callback function that is called whenever an error occurs. */
 RTCORE_API void rtcSetErrorFunction(RTC_ERROR_FUNCTION func);
 
+/*! \brief Type of the task function the application has to invoke
+  for each element of a task spawned by Embree. */
+typedef void (*RTCTaskFunc)(void* task, size_t taskIndex, size_t taskCount);
+
+/*! \brief Type of the spawn callback. The callback has to schedule
+  taskCount invocations func(task,i,taskCount) with i in the range [0,
+  taskCount-1] to the thread pool of the application and may return
+  before they completed. */
+typedef void (*RTCSpawnFunc)(void* userPtr, RTCTaskFunc func, void* task, size_t taskCount);
+
+/*! \brief Type of the condition function passed to the wait callback. */
+typedef bool (*RTCConditionFunc)(void* ptr);
+
+/*! \brief Type of the wait callback. The callback has to return once
+  cond(ptr) returns true. In the meantime the calling thread should
+  execute tasks of the application pool, as this thread may itself be
+  a thread of the pool. */
+typedef void (*RTCWaitFunc)(void* userPtr, RTCConditionFunc cond, void* ptr);
+
+/*! \brief Makes Embree execute all its tasks through the thread pool
+  of the application.
+
+  Embree then creates no threads of its own, but forwards its tasks
+  through the spawn callback to the application and waits for them
+  through the optional wait callback. The threads option of rtcInit
+  specifies how many tasks Embree runs at once (default is the number
+  of hardware threads) and the pool has to be able to run that many
+  spawned tasks concurrently. Passing NULL as spawn callback restores
+  the Embree internal threads. This function has to get called before
+  rtcInit. */
+RTCORE_API void rtcSetTaskingSystem(RTCSpawnFunc spawn, RTCWaitFunc wait, void* userPtr);
+
+/*! \brief Statistics of the tessellation cache used for subdivision surfaces. */
+struct RTCTessellationCacheStats
+{
+  size_t size;       //!< current size of the cache in bytes
+  size_t accesses;   //!< number of cache lookups
+  size_t hits;       //!< number of lookups that found the tessellated patch
+  size_t misses;     //!< number of lookups that required tessellating the patch
+  size_t evictions;  //!< number of times a part of the cache got evicted
+  size_t clears;     //!< number of times the cache got cleared because it got resized
+};
+
+/*! \brief Returns tessellation cache statistics.
+
+  The statistics get accumulated since rtcInit or since the last call
+  that had the reset parameter set. The initial size, maximal size,
+  and number of segments of the tessellation cache can be configured
+  through the tessellation_cache_size, tessellation_cache_max_size,
+  and tessellation_cache_segments options of rtcInit. */
+RTCORE_API void rtcGetTessellationCacheStats(RTCTessellationCacheStats* stats, bool reset = false);
+
 /*! \brief Implementation specific (do not call).
 
   This function is implementation specific and only for debugging
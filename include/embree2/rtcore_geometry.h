@@ -40,6 +40,11 @@ enum RTCBufferType {
   RTC_VERTEX_CREASE_WEIGHT_BUFFER = 0x08000000,
 
   RTC_HOLE_BUFFER          = 0x09000001,
+
+  RTC_TEXCOORD_BUFFER      = 0x0A000000,
+
+  RTC_USER_VERTEX_BUFFER0  = 0x0B000000,
+  RTC_USER_VERTEX_BUFFER1  = 0x0B000001,
 };
 
 /*! \brief Supported types of matrix layout for functions involving matrices */
@@ -83,6 +88,21 @@ typedef void (*RTCFilterFunc16)(const void* valid, /*!< pointer to valid mask */
                                 void* ptr,         /*!< pointer to user data */
                                 RTCRay16& ray      /*!< intersection to filter */);
 
+/*! Batched filter function for single rays. Gets all candidate hits
+ *  of one geometry found for the ray in a leaf as SoA arrays. */
+typedef void (*RTCFilterFuncN)(int* valid,             /*!< pointer to valid flag per hit (source and target) */
+                               void* ptr,              /*!< pointer to user data */
+                               const RTCRay& ray,      /*!< ray the hits belong to */
+                               unsigned geomID,        /*!< ID of geometry hit */
+                               const unsigned* primID, /*!< IDs of primitives hit */
+                               const float* u,         /*!< barycentric u coordinates of hits */
+                               const float* v,         /*!< barycentric v coordinates of hits */
+                               const float* t,         /*!< distances of hits */
+                               const float* Ngx,       /*!< x coordinates of geometry normals */
+                               const float* Ngy,       /*!< y coordinates of geometry normals */
+                               const float* Ngz,       /*!< z coordinates of geometry normals */
+                               size_t N                /*!< number of hits */ );
+
 /*! Displacement mapping function. */
 typedef void (*RTCDisplacementFunc)(void* ptr,           /*!< pointer to user data of geometry */
                                     unsigned geomID,     /*!< ID of geometry to displace */
@@ -97,6 +117,19 @@ typedef void (*RTCDisplacementFunc)(void* ptr,           /*!< pointer to user da
                                     float* pz,           /*!< z coordinates of points to displace (source and target) */
                                     size_t N             /*!< number of points to displace */ );
 
+/*! Edge tessellation level function. */
+typedef void (*RTCEdgeLevelFunc)(void* ptr,           /*!< pointer to user data of geometry */
+                                 unsigned geomID,     /*!< ID of subdivision mesh */
+                                 size_t firstEdge,    /*!< index of first edge of the range */
+                                 const float* x0,     /*!< x coordinates of edge start vertices (source) */
+                                 const float* y0,     /*!< y coordinates of edge start vertices (source) */
+                                 const float* z0,     /*!< z coordinates of edge start vertices (source) */
+                                 const float* x1,     /*!< x coordinates of edge end vertices (source) */
+                                 const float* y1,     /*!< y coordinates of edge end vertices (source) */
+                                 const float* z1,     /*!< z coordinates of edge end vertices (source) */
+                                 float* levels,       /*!< tessellation levels of edges (target) */
+                                 size_t N             /*!< number of edges */ );
+
 /*! \brief Creates a new scene instance. 
 
   A scene instance contains a reference to a scene to instantiate and
@@ -189,6 +222,11 @@ RTCORE_API unsigned rtcNewTriangleMesh (RTCScene scene,                    //!<
  performance. Storing a vertex multiple times with different crease
  weights results in undefined behaviour.
 
+ Optionally, the application can set the user vertex buffers
+ (RTC_USER_VERTEX_BUFFER0 and RTC_USER_VERTEX_BUFFER1) with
+ numVertices many per vertex attributes, that can get interpolated
+ using rtcInterpolate.
+
 */
 RTCORE_API unsigned rtcNewSubdivisionMesh (RTCScene scene,                //!< the scene the mesh belongs to
                                            RTCGeometryFlags flags,        //!< geometry flags
@@ -226,9 +264,29 @@ RTCORE_API unsigned rtcNewHairGeometry (RTCScene scene,                    //!<
                                         size_t numTimeSteps = 1            //!< number of motion blur time steps
   );
 
+/*! \brief Creates a new point geometry, consisting of multiple
+  spheres. The number of points (numPoints) has to get specified at
+  construction time. The point vertex buffer (RTC_VERTEX_BUFFER) has
+  to get set by mapping and writing to the buffer. Each point consists
+  of a single precision (x,y,z) center and radius, stored in that
+  order in memory. Hits report the unnormalized surface normal as
+  geometry normal and u=v=0. */
+RTCORE_API unsigned rtcNewPointGeometry (RTCScene scene,                    //!< the scene the points belong to
+                                         RTCGeometryFlags flags,            //!< geometry flags
+                                         size_t numPoints                   //!< number of points
+  );
+
 /*! \brief Sets 32 bit ray mask. */
 RTCORE_API void rtcSetMask (RTCScene scene, unsigned geomID, int mask);
 
+/*! \brief Sets alpha mask of a triangle mesh. The mask is a bit
+ *  texture of width x height texels stored in row major order, packed
+ *  into 32 bit words starting at the least significant bit. Hits at
+ *  texels with a cleared bit are ignored. The mask is looked up with
+ *  the texture coordinates of the RTC_TEXCOORD_BUFFER. Passing NULL
+ *  removes the alpha mask. */
+RTCORE_API void rtcSetAlphaMask (RTCScene scene, unsigned geomID, const void* bits, size_t width, size_t height);
+
 /*! \brief Maps specified buffer. This function can be used to set index and
  *  vertex buffers of geometries. */
 RTCORE_API void* rtcMapBuffer(RTCScene scene, unsigned geomID, RTCBufferType type);
@@ -283,9 +341,51 @@ RTCORE_API void rtcDisable (RTCScene scene, unsigned geomID);
 /*! \brief Sets the displacement function. */
 RTCORE_API void rtcSetDisplacementFunction (RTCScene scene, unsigned geomID, RTCDisplacementFunc func, RTCBounds* bounds);
 
+/*! \brief Sets the edge level function. 
+
+  The edge level function computes the tessellation levels of a
+  subdivision mesh during commit, replacing the level buffer. */
+RTCORE_API void rtcSetEdgeLevelFunction (RTCScene scene, unsigned geomID, RTCEdgeLevelFunc func);
+
+/*! \brief Sets the camera used to compute edge levels. 
+
+  The tessellation level of each edge of a subdivision mesh is
+  computed during commit as levelFactor times the edge length divided
+  by the distance of the edge midpoint to the camera position. Passing
+  NULL as position disables view dependent edge levels. */
+RTCORE_API void rtcSetEdgeLevelCamera (RTCScene scene, unsigned geomID, const float* pos, float levelFactor);
+
+/*! \brief Interpolates vertex data to some u/v location. 
+
+  Evaluates the limit surface of the subdivision mesh spanned by
+  numFloats floats per vertex of the specified buffer
+  (RTC_VERTEX_BUFFER0/1 or RTC_USER_VERTEX_BUFFER0/1) at the u/v
+  location of some face, as reported by a hit of that face. The
+  interpolated value is written to P, and the derivatives with respect
+  to u and v to dPdu and dPdv. Each of these output arrays can be
+  NULL. The buffer has to be readable for 4 floats past the last
+  interpolated float of each vertex. This function must not get
+  called while the scene gets modified. */
+RTCORE_API void rtcInterpolate (RTCScene scene, unsigned geomID, unsigned primID, float u, float v, RTCBufferType buffer, 
+                                float* P, float* dPdu, float* dPdv, size_t numFloats);
+
+/*! \brief Interpolates vertex data to multiple u/v locations. 
+
+  Batched version of rtcInterpolate, e.g. for all hits of a ray
+  packet of size 4, 8, or 16. Each active location i (valid[i] == -1
+  or valid == NULL) evaluates face primIDs[i] at u[i],v[i]. The
+  outputs are stored in struct of array layout, thus the j'th float of
+  location i is stored at P[j*numUVs+i]. */
+RTCORE_API void rtcInterpolateN (RTCScene scene, unsigned geomID, 
+                                 const void* valid, const unsigned* primIDs, const float* u, const float* v, size_t numUVs, 
+                                 RTCBufferType buffer, float* P, float* dPdu, float* dPdv, size_t numFloats);
+
 /*! \brief Sets the intersection filter function for single rays. */
 RTCORE_API void rtcSetIntersectionFilterFunction (RTCScene scene, unsigned geomID, RTCFilterFunc func);
 
+/*! \brief Sets the batched intersection filter function for single rays. */
+RTCORE_API void rtcSetIntersectionFilterFunctionN (RTCScene scene, unsigned geomID, RTCFilterFuncN func);
+
 /*! \brief Sets the intersection filter function for ray packets of size 4. */
 RTCORE_API void rtcSetIntersectionFilterFunction4 (RTCScene scene, unsigned geomID, RTCFilterFunc4 func);
 
@@ -298,6 +398,9 @@ RTCORE_API void rtcSetIntersectionFilterFunction16 (RTCScene scene, unsigned geo
 /*! \brief Sets the occlusion filter function for single rays. */
 RTCORE_API void rtcSetOcclusionFilterFunction (RTCScene scene, unsigned geomID, RTCFilterFunc func);
 
+/*! \brief Sets the batched occlusion filter function for single rays. */
+RTCORE_API void rtcSetOcclusionFilterFunctionN (RTCScene scene, unsigned geomID, RTCFilterFuncN func);
+
 /*! \brief Sets the occlusion filter function for ray packets of size 4. */
 RTCORE_API void rtcSetOcclusionFilterFunction4 (RTCScene scene, unsigned geomID, RTCFilterFunc4 func);
 
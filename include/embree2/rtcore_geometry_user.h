@@ -25,11 +25,34 @@ typedef void (*RTCBoundsFunc)(void* ptr,              /*!< pointer to user data
                               size_t item,            /*!< item to calculate bounds for */
                               RTCBounds& bounds_o     /*!< returns calculated bounds */);
 
+/*! Type of batched bounding function. Calculates the bounds of all
+ *  items in the range [begin,end) and stores them in struct of array
+ *  layout, thus the bounds of item begin+i are stored at index i of
+ *  each output array. */
+typedef void (*RTCBoundsFuncN)(void* ptr,             /*!< pointer to user data */
+                               size_t begin,          /*!< first item to calculate bounds for */
+                               size_t end,            /*!< end of item range */
+                               float* lower_x,        /*!< returns x coordinates of lower bounds */
+                               float* lower_y,        /*!< returns y coordinates of lower bounds */
+                               float* lower_z,        /*!< returns z coordinates of lower bounds */
+                               float* upper_x,        /*!< returns x coordinates of upper bounds */
+                               float* upper_y,        /*!< returns y coordinates of upper bounds */
+                               float* upper_z         /*!< returns z coordinates of upper bounds */);
+
 /*! Type of intersect function pointer for single rays. */
 typedef void (*RTCIntersectFunc)(void* ptr,           /*!< pointer to user data */
                                  RTCRay& ray,         /*!< ray to intersect */
                                  size_t item          /*!< item to intersect */);
 
+/*! Type of intersect function pointer for streams of single
+ *  rays. Gets called with N (ray, item) pairs, where the i'th pair
+ *  consists of the ray rays[rayIDs[i]] and item items[i]. */
+typedef void (*RTCIntersectFuncN)(void* ptr,              /*!< pointer to user data */
+                                  RTCRay* rays,           /*!< rays to intersect */
+                                  const unsigned* rayIDs, /*!< ray index of each pair */
+                                  const size_t* items,    /*!< item to intersect of each pair */
+                                  size_t N                /*!< number of pairs */);
+
 /*! Type of intersect function pointer for ray packets of size 4. */
 typedef void (*RTCIntersectFunc4)(const void* valid,  /*!< pointer to valid mask */
                                   void* ptr,          /*!< pointer to user data */
@@ -53,6 +76,15 @@ typedef void (*RTCOccludedFunc) (void* ptr,           /*!< pointer to user data
                                  RTCRay& ray,         /*!< ray to test occlusion */
                                  size_t item          /*!< item to test for occlusion */);
 
+/*! Type of occlusion function pointer for streams of single
+ *  rays. Gets called with N (ray, item) pairs, where the i'th pair
+ *  consists of the ray rays[rayIDs[i]] and item items[i]. */
+typedef void (*RTCOccludedFuncN) (void* ptr,              /*!< pointer to user data */
+                                  RTCRay* rays,           /*!< rays to test occlusion */
+                                  const unsigned* rayIDs, /*!< ray index of each pair */
+                                  const size_t* items,    /*!< item to test for occlusion of each pair */
+                                  size_t N                /*!< number of pairs */);
+
 /*! Type of occlusion function pointer for ray packets of size 4. */
 typedef void (*RTCOccludedFunc4) (const void* valid,  /*! pointer to valid mask */
                                   void* ptr,          /*!< pointer to user data */
@@ -98,11 +130,24 @@ RTCORE_API void rtcSetUserData (RTCScene scene, unsigned geomID, void* ptr);
  *  tight.*/
 RTCORE_API void rtcSetBoundsFunction (RTCScene scene, unsigned geomID, RTCBoundsFunc bounds);
 
+/*! Sets a batched bounding function that calculates the bounds of
+ *  ranges of items. If set, it is used instead of the bounding
+ *  function when building spatial index structures. Different ranges
+ *  are processed in parallel by different threads. */
+RTCORE_API void rtcSetBoundsFunctionN (RTCScene scene, unsigned geomID, RTCBoundsFuncN boundsN);
+
 /*! Set intersect function for single rays. The rtcIntersect function
  *  will call the passed function for intersecting the user
  *  geometry. */
 RTCORE_API void rtcSetIntersectFunction (RTCScene scene, unsigned geomID, RTCIntersectFunc intersect);
 
+/*! Set intersect function for streams of single rays. The
+ *  rtcIntersect function will call the passed function once for all
+ *  items of the user geometry that are found together during
+ *  traversal, instead of calling the intersect function for single
+ *  rays once per item. */
+RTCORE_API void rtcSetIntersectFunctionN (RTCScene scene, unsigned geomID, RTCIntersectFuncN intersectN);
+
 /*! Set intersect function for ray packets of size 4. The
  *  rtcIntersect4 function will call the passed function for
  *  intersecting the user geometry. */
@@ -123,6 +168,13 @@ RTCORE_API void rtcSetIntersectFunction16 (RTCScene scene, unsigned geomID, RTCI
  *  geometry. */
 RTCORE_API void rtcSetOccludedFunction (RTCScene scene, unsigned geomID, RTCOccludedFunc occluded);
 
+/*! Set occlusion function for streams of single rays. The
+ *  rtcOccluded function will call the passed function once for all
+ *  items of the user geometry that are found together during
+ *  traversal, instead of calling the occlusion function for single
+ *  rays once per item. */
+RTCORE_API void rtcSetOccludedFunctionN (RTCScene scene, unsigned geomID, RTCOccludedFuncN occludedN);
+
 /*! Set occlusion function for ray packets of size 4. The rtcOccluded4
  *  function will call the passed function for intersecting the user
  *  geometry. */
@@ -68,4 +68,49 @@ namespace embree
   };
 
   parallel_for_regression_test parallel_for_regression("parallel_for_regression_test");
+
+  struct parallel_for_nested_regression_test : public RegressionTest
+  {
+    parallel_for_nested_regression_test(const char* name) : name(name) {
+      registerRegressionTest(this);
+    }
+    
+    bool operator() ()
+    {
+      bool passed = true;
+      printf("%s::%s ... ",TOSTRING(isa),name);
+      fflush(stdout);
+
+      /* every task spawns nested task sets that the other threads help
+       * with while they finish their part of the task */
+      const size_t M = 1000;
+      const size_t numTasks = 4*getNumParallelThreads();
+      for (size_t m=0; m<M && passed; m++)
+      {
+        const size_t N = 1+(m*7919)%4096;
+        AtomicCounter sum = 0;
+        parallel_for(numTasks, [&](const size_t taskIndex) 
+        {
+          parallel_for( size_t(0), N, size_t(16), [&](const range<size_t>& r) 
+          {
+            size_t s = 0;
+            for (size_t i=r.begin(); i<r.end(); i++) 
+              s += i;
+            sum += s;
+          });
+        });
+        passed = (size_t)sum == numTasks*(N*(N-1)/2);
+      }
+      
+      /* output if test passed or not */
+      if (passed) printf("[passed]\n");
+      else        printf("[failed]\n");
+      
+      return passed;
+    }
+
+    const char* name;
+  };
+
+  parallel_for_nested_regression_test parallel_for_nested_regression("parallel_for_nested_regression_test");
 }
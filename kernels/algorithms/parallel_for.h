@@ -20,6 +20,17 @@
 
 namespace embree
 {
+  /*! returns the number of threads available to the parallel algorithms */
+  __forceinline size_t getNumParallelThreads()
+  {
+    if (LockStepTaskScheduler* scheduler = LockStepTaskScheduler::instance())
+      return scheduler->getNumThreads();
+    return TaskScheduler::getNumThreads();
+  }
+
+  /*! Executes a task set through the lockstep scheduler if invoked by
+   *  its control thread, or as nestable parallel task set if invoked
+   *  from inside some other task. */
   template<typename Index, typename Func>
     class ParallelForTask
   {
@@ -33,18 +44,48 @@ namespace embree
 #else
       if (taskCount == 0) return;
       else if (taskCount == 1) func(0);
-      else LockStepTaskScheduler::instance()->dispatchTaskSet(task_set,this,taskCount);
+      else if (LockStepTaskScheduler* scheduler = LockStepTaskScheduler::instance()) 
+        scheduler->dispatchTaskSet(task_set,this,taskCount);
+      else 
+        ParallelTaskSet(task_range,this,taskCount,1,getNumParallelThreads()).execute();
 #endif
     }
 
     static void task_set(void* data, const size_t threadIndex, const size_t threadCount, const size_t taskIndex, const size_t taskCount) {
       ((ParallelForTask*)data)->func(taskIndex);
     }
+
+    static void task_range(void* data, const size_t begin, const size_t end) {
+      for (size_t taskIndex=begin; taskIndex<end; taskIndex++)
+        ((ParallelForTask*)data)->func(taskIndex);
+    }
     
     private:
       const Func& func;
   };
 
+  /*! Nestable parallel for over a range that gets split adaptively
+   *  into blocks of at least minStepSize elements. */
+  template<typename Index, typename Func>
+    class ParallelForRangeTask
+  {
+  public:
+    __forceinline ParallelForRangeTask (const Index first, const Index last, const Index minStepSize, const Func& func)
+      : first(first), func(func) 
+    {
+      ParallelTaskSet(task_range,this,last-first,minStepSize,getNumParallelThreads()).execute();
+    }
+
+    static void task_range(void* data, const size_t begin, const size_t end) {
+      ParallelForRangeTask* This = (ParallelForRangeTask*) data;
+      This->func(range<Index>(This->first+begin,This->first+end));
+    }
+
+    private:
+      const Index first;
+      const Func& func;
+  };
+
   /* simple parallel_for without range optimization (similar to a task set) */
   template<typename Index, typename Func>
     __forceinline void parallel_for( const Index N, const Func& func)
@@ -71,7 +112,14 @@ namespace embree
     __forceinline void parallel_for( const Index first, const Index last, const Index minStepSize, const Func& func)
   {
     size_t taskCount = (last-first+minStepSize-1)/minStepSize;
-    if (taskCount > 1) taskCount = min(taskCount,LockStepTaskScheduler::instance()->getNumThreads());
+
+    /* nested inside some other task the range gets split adaptively */
+    if (taskCount > 1 && LockStepTaskScheduler::instance() == NULL) {
+      ParallelForRangeTask<Index,Func>(first,last,minStepSize,func);
+      return;
+    }
+    
+    if (taskCount > 1) taskCount = min(taskCount,getNumParallelThreads());
 
     parallel_for(taskCount, [&](const size_t taskIndex) {
         const size_t k0 = first+(taskIndex+0)*(last-first)/taskCount;
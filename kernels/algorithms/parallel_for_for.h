@@ -56,8 +56,7 @@ namespace embree
       this->N = N;
 
       /* calculate number of tasks to use */
-      LockStepTaskScheduler* scheduler = LockStepTaskScheduler::instance();
-      const size_t numThreads = scheduler->getNumThreads();
+      const size_t numThreads = getNumParallelThreads();
       const size_t numBlocks  = (N+minStepSize-1)/minStepSize;
       taskCount = max(size_t(1),min(numThreads,numBlocks,size_t(ParallelForForState::MAX_TASKS)));
       
@@ -0,0 +1,83 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "parallel_partition.h"
+
+namespace embree
+{
+  struct parallel_partition_regression_test : public RegressionTest
+  {
+    parallel_partition_regression_test(const char* name) : name(name) {
+      registerRegressionTest(this);
+    }
+    
+    bool operator() ()
+    {
+      bool passed = true;
+      printf("%s::%s ... ",TOSTRING(isa),name);
+      fflush(stdout);
+
+      const size_t M = 10;
+      for (size_t N=10; N<10000000; N*=2.1f)
+      {
+        std::vector<unsigned> array(N);
+        double t = 0.0f;
+        for (size_t m=0; m<M; m++)
+        {
+          /* fill array with pseudo random numbers */
+          unsigned int s = unsigned(N+m);
+          for (size_t i=0; i<N; i++) {
+            s = 1103515245*s+12345;
+            array[i] = s >> 16;
+          }
+          const unsigned pivot = m*0x10000/(M-1);
+
+          /* sequentially count and sum left elements */
+          size_t numLeft0 = 0, sumLeft0 = 0, sumRight0 = 0;
+          for (size_t i=0; i<N; i++) {
+            if (array[i] < pivot) { numLeft0++; sumLeft0 += array[i]; }
+            else sumRight0 += array[i];
+          }
+
+          /* parallel partitioning of the array */
+	  double t0 = getSeconds();
+          size_t sumLeft1 = 0, sumRight1 = 0;
+          const size_t center = parallel_partition(array.data(), size_t(0), N, size_t(1024), size_t(0), sumLeft1, sumRight1,
+                                                   [&](const unsigned v) { return v < pivot; }, 
+                                                   [](size_t& sum, const unsigned v) { sum += v; },
+                                                   [](const size_t v0, const size_t v1) { return v0+v1; });
+	  t += getSeconds()-t0;
+
+          /* check the partitioning and the reductions */
+          passed &= center == numLeft0 && sumLeft0 == sumLeft1 && sumRight0 == sumRight1;
+          for (size_t i=0; i<center; i++) passed &= array[i] < pivot;
+          for (size_t i=center; i<N; i++) passed &= array[i] >= pivot;
+        }
+	printf("%zu/%3.2fM ",N,1E-6*double(N*M)/t);
+      }
+      
+      /* output if test passed or not */
+      if (passed) printf("[passed]\n");
+      else        printf("[failed]\n");
+      
+      return passed;
+    }
+
+    const char* name;
+  };
+
+  parallel_partition_regression_test parallel_partition_regression("parallel_partition_regression_test");
+}
@@ -0,0 +1,142 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "parallel_for.h"
+
+#include <algorithm>
+
+namespace embree
+{
+  /*! Partitions the array [first,last) in place such that all elements
+   *  for which isLeft returns true come first. The elements of both
+   *  sides get reduced into leftReduction and rightReduction, which have
+   *  to be initialized by the caller. Returns the index of the first
+   *  element of the right side. */
+  template<typename T, typename Value, typename IsLeft, typename Reduction_T>
+    __forceinline size_t serial_partition(T* array, const size_t first, const size_t last, Value& leftReduction, Value& rightReduction, 
+                                          const IsLeft& isLeft, const Reduction_T& reduction_t)
+  {
+    T* l = array + first;
+    T* r = array + last - 1;
+    
+    while (true)
+    {
+      while (likely(l <= r && isLeft(*l))) {
+        reduction_t(leftReduction,*l);
+        ++l;
+      }
+      while (likely(l <= r && !isLeft(*r))) {
+        reduction_t(rightReduction,*r);
+        --r;
+      }
+      if (r<l) break;
+
+      reduction_t(leftReduction,*r);
+      reduction_t(rightReduction,*l);
+      std::swap(*l,*r);
+      l++; r--;
+    }
+    return l - array;
+  }
+
+  /*! Parallel version of serial_partition. Each task first partitions
+   *  its own block of the array. The right elements that end up before
+   *  the final split position and the left elements that end up after it
+   *  form the same number of misplaced elements, which get swapped in
+   *  parallel in a second pass. */
+  template<typename T, typename Value, typename IsLeft, typename Reduction_T, typename Reduction_V>
+    __forceinline size_t parallel_partition(T* array, const size_t first, const size_t last, const size_t minStepSize, const Value& identity,
+                                            Value& leftReduction, Value& rightReduction, 
+                                            const IsLeft& isLeft, const Reduction_T& reduction_t, const Reduction_V& reduction_v)
+  {
+    /* fast path for small number of elements */
+    const size_t maxTasks = 64;
+    size_t taskCount = (last-first+minStepSize-1)/minStepSize;
+    taskCount = min(taskCount,getNumParallelThreads(),maxTasks);
+    if (taskCount <= 1) {
+      leftReduction = rightReduction = identity;
+      return serial_partition(array,first,last,leftReduction,rightReduction,isLeft,reduction_t);
+    }
+
+    /* partition each block of the array */
+    size_t numLefts[maxTasks];
+    Value leftReductions[maxTasks];
+    Value rightReductions[maxTasks];
+    parallel_for(taskCount, [&](const size_t taskIndex) {
+        const size_t k0 = first+(taskIndex+0)*(last-first)/taskCount;
+        const size_t k1 = first+(taskIndex+1)*(last-first)/taskCount;
+        leftReductions[taskIndex] = rightReductions[taskIndex] = identity;
+        numLefts[taskIndex] = serial_partition(array,k0,k1,leftReductions[taskIndex],rightReductions[taskIndex],isLeft,reduction_t)-k0;
+      });
+
+    /* reduce over all blocks */
+    size_t center = first;
+    leftReduction = rightReduction = identity;
+    for (size_t i=0; i<taskCount; i++) {
+      center += numLefts[i];
+      leftReduction  = reduction_v(leftReduction,leftReductions[i]);
+      rightReduction = reduction_v(rightReduction,rightReductions[i]);
+    }
+
+    /* collect the ranges of misplaced elements of each block */
+    size_t numLeftRanges = 0, numRightRanges = 0;
+    size_t misplacedLeftBegin[maxTasks+1], misplacedLeftStart[maxTasks+1];
+    size_t misplacedRightBegin[maxTasks+1], misplacedRightStart[maxTasks+1];
+    size_t numMisplaced = 0, numMisplacedRight = 0;
+    for (size_t i=0; i<taskCount; i++)
+    {
+      const size_t k0 = first+(i+0)*(last-first)/taskCount;
+      const size_t k1 = first+(i+1)*(last-first)/taskCount;
+      const size_t mid = k0+numLefts[i];
+
+      /* left elements at or after the center */
+      const size_t l0 = max(k0,center);
+      if (l0 < mid) {
+        misplacedLeftBegin[numLeftRanges] = l0;
+        misplacedLeftStart[numLeftRanges++] = numMisplaced;
+        numMisplaced += mid-l0;
+      }
+      
+      /* right elements before the center */
+      const size_t r1 = min(k1,center);
+      if (mid < r1) {
+        misplacedRightBegin[numRightRanges] = mid;
+        misplacedRightStart[numRightRanges++] = numMisplacedRight;
+        numMisplacedRight += r1-mid;
+      }
+    }
+    assert(numMisplaced == numMisplacedRight);
+    misplacedLeftStart [numLeftRanges ] = numMisplaced;
+    misplacedRightStart[numRightRanges] = numMisplaced;
+
+    /* swap misplaced elements in parallel */
+    parallel_for(size_t(0), numMisplaced, minStepSize, [&](const range<size_t>& r) 
+    {
+      size_t li = std::upper_bound(misplacedLeftStart ,misplacedLeftStart +numLeftRanges ,r.begin())-misplacedLeftStart -1;
+      size_t ri = std::upper_bound(misplacedRightStart,misplacedRightStart+numRightRanges,r.begin())-misplacedRightStart-1;
+      for (size_t i=r.begin(); i<r.end(); i++)
+      {
+        while (i >= misplacedLeftStart [li+1]) li++;
+        while (i >= misplacedRightStart[ri+1]) ri++;
+        std::swap(array[misplacedLeftBegin [li]+i-misplacedLeftStart [li]],
+                  array[misplacedRightBegin[ri]+i-misplacedRightStart[ri]]);
+      }
+    });
+    return center;
+  }
+}
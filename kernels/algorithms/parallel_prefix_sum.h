@@ -32,8 +32,7 @@ namespace embree
     __forceinline Value parallel_prefix_sum( ParallelPrefixSumState<Value>& state, Index first, Index last, Index minStepSize, const Value& identity, const Func& func, const Reduction& reduction)
   {
     /* calculate number of tasks to use */
-    LockStepTaskScheduler* scheduler = LockStepTaskScheduler::instance();
-    const size_t numThreads = scheduler->getNumThreads();
+    const size_t numThreads = getNumParallelThreads();
     const size_t numBlocks  = (last-first+minStepSize-1)/minStepSize;
     const size_t taskCount  = min(numThreads,numBlocks,size_t(ParallelPrefixSumState<Value>::MAX_TASKS));
 
@@ -41,7 +41,7 @@ namespace embree
       return func(range<Index>(first,last));
     }
     const size_t maxTasks = 256;
-    taskCount = min(taskCount,LockStepTaskScheduler::instance()->getNumThreads(),maxTasks);
+    taskCount = min(taskCount,getNumParallelThreads(),maxTasks);
 
     /* parallel invokation of all tasks */
     Value values[maxTasks];
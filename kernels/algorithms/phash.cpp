@@ -0,0 +1,78 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "phash.h"
+
+namespace embree
+{
+  struct phash_regression_test : public RegressionTest
+  {
+    struct Slot
+    {
+      Slot () : key(phash<uint64,Slot>::EMPTY), count(0) {}
+
+    public:
+      uint64 key;
+      atomic_t count;
+    };
+
+    phash_regression_test(const char* name) : name(name) {
+      registerRegressionTest(this);
+    }
+    
+    bool operator() ()
+    {
+      bool passed = true;
+      printf("%s::%s ... ",TOSTRING(isa),name);
+      fflush(stdout);
+
+      /* the table gets reused for different numbers of keys */
+      phash<uint64,Slot> table;
+      for (size_t M=10; M<1000000; M*=10)
+      {
+        /* every key gets inserted 4 times from different threads */
+        const size_t N = 4*M;
+        table.init(2*M);
+        parallel_for( size_t(0), N, size_t(1024), [&](const range<size_t>& r) {
+          for (size_t i=r.begin(); i<r.end(); i++) {
+            Slot* slot = table.insert(uint64(i%M) << 32 | uint64(i%M));
+            if (slot) atomic_add(&slot->count,1);
+          }
+        });
+
+        /* check that each key got found in the same slot */
+        for (size_t i=0; i<M; i++) {
+          const Slot* slot = table.lookup(uint64(i) << 32 | uint64(i));
+          passed &= slot && slot->count == 4;
+        }
+
+        /* check that other keys are not in the table */
+        for (size_t i=0; i<M; i++) 
+          passed &= table.lookup(uint64(i) << 32 | uint64(i+1)) == NULL;
+      }
+
+      /* output if test passed or not */
+      if (passed) printf("[passed]\n");
+      else        printf("[failed]\n");
+      
+      return passed;
+    }
+
+    const char* name;
+  };
+
+  phash_regression_test phash_regression("phash_regression_test");
+}
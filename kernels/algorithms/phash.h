@@ -0,0 +1,134 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "common/default.h"
+#include "algorithms/parallel_for.h"
+
+namespace embree
+{
+  /*! Concurrent hash table using open addressing with linear
+   *  probing. Each slot stores its key in a member called key that the
+   *  default constructor of the slot sets to EMPTY. Slots get claimed
+   *  through an atomic compare and swap of the key, thus keys can get
+   *  inserted from many threads at the same time, but not removed. */
+  template<typename Key, typename Slot>
+  class phash
+  {
+  public:
+
+    /*! reserved key of empty slots */
+    static const Key EMPTY = Key(-1);
+
+    phash () 
+      : slots(NULL), capacity(0), allocated(0) {}
+
+    ~phash () {
+      alignedFree(slots);
+    }
+
+    /*! disallow copy */
+    phash (const phash&) = delete;
+    phash& operator= (const phash&) = delete;
+
+    /*! clears the table in parallel and makes room for N slots, the memory gets reused if sufficiently large */
+    void init(size_t N)
+    {
+      N = max(N,size_t(16));
+      if (N > allocated) {
+        alignedFree(slots);
+        slots = (Slot*) alignedMalloc(N*sizeof(Slot));
+        allocated = N;
+      }
+      capacity = N;
+
+      parallel_for( size_t(0), capacity, size_t(4*4096), [&](const range<size_t>& r) {
+        for (size_t i=r.begin(); i<r.end(); i++) 
+          new (&slots[i]) Slot();
+      });
+    }
+
+    /*! returns the slot of the key and claims an empty slot if the key is
+     *  not contained yet, returns NULL if the table is full (thread safe) */
+    __forceinline Slot* insert(const Key key)
+    {
+      assert(key != EMPTY);
+      size_t i = hash(key);
+      for (size_t n=0; n<capacity; n++)
+      {
+        Slot& slot = slots[i];
+        Key k = *(volatile Key*)&slot.key;
+        if (k == EMPTY) k = cmpxchg(&slot.key,EMPTY,key);
+        if (k == EMPTY || k == key) return &slot;
+        if (++i == capacity) i = 0;
+      }
+      return NULL;
+    }
+
+    /*! returns the slot of the key or NULL if the key is not contained */
+    __forceinline const Slot* lookup(const Key key) const
+    {
+      size_t i = hash(key);
+      for (size_t n=0; n<capacity; n++)
+      {
+        const Slot& slot = slots[i];
+        if (slot.key == EMPTY) return NULL;
+        if (slot.key == key) return &slot;
+        if (++i == capacity) i = 0;
+      }
+      return NULL;
+    }
+
+    /*! returns the number of slots */
+    __forceinline size_t size() const { return capacity; }
+
+    /*! access to the slots for iterating over the table */
+    __forceinline       Slot& operator[] (size_t i)       { assert(i<capacity); return slots[i]; }
+    __forceinline const Slot& operator[] (size_t i) const { assert(i<capacity); return slots[i]; }
+
+    /*! frees all memory */
+    void clear()
+    {
+      alignedFree(slots);
+      slots = NULL;
+      capacity = allocated = 0;
+    }
+
+  private:
+
+    /*! maps the key to a slot using Fibonacci hashing */
+    __forceinline size_t hash(const Key key) const {
+      const uint64 h = uint64(key) * 0x9E3779B97F4A7C15ull;
+      return size_t(((h >> 32) * uint64(capacity)) >> 32);
+    }
+
+    /*! atomic compare and swap of 32 and 64 bit keys */
+    __forceinline static Key cmpxchg(Key* key, const Key c, const Key v) 
+    {
+      if (sizeof(Key) == 8) return (Key) atomic_cmpxchg((volatile int64*)key,(int64)c,(int64)v);
+      else                  return (Key) atomic_cmpxchg((volatile int32*)key,(int32)c,(int32)v);
+    }
+
+  private:
+    Slot* slots;        //!< array of all slots
+    size_t capacity;    //!< number of slots in use
+    size_t allocated;   //!< number of allocated slots
+  };
+
+  template<typename Key, typename Slot>
+    const Key phash<Key,Slot>::EMPTY;
+}
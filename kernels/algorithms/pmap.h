@@ -18,8 +18,7 @@
 
 #include "common/default.h"
 #include "common/buffer.h"
-#include "algorithms/sort.h"
-#include "algorithms/parallel_for.h"
+#include "algorithms/phash.h"
 
 namespace embree
 {
@@ -27,19 +26,14 @@ namespace embree
   template<typename Key, typename Val>
   class pmap
   {
-    struct KeyValue
+    struct Slot
     {
-      __forceinline KeyValue () {}
-
-      __forceinline KeyValue (const Key key, const Val val)
-	: key(key), val(val) {}
-
-      __forceinline operator Key() const {
-	return key;
-      }
+      __forceinline Slot () 
+        : key(phash<Key,Slot>::EMPTY), index(0x7FFFFFFF) {}
 
     public:
       Key key;
+      int index;   //!< smallest index of the key in the input, the first occurrence of a key defines its value
       Val val;
     };
 
@@ -58,71 +52,71 @@ namespace embree
     template<typename SourceKey>
       void init(const std::vector<SourceKey>& keys, const std::vector<Val>& values) 
     {
-      /* reserve sufficient space for all data */
       assert(keys.size() == values.size());
-      vec.resize(keys.size());
-      temp.resize(keys.size());
-
-      /* generate key/value pairs */
-      parallel_for( size_t(0), keys.size(), size_t(4*4096), [&](const range<size_t>& r) {
-	for (size_t i=r.begin(); i<r.end(); i++)
-	  vec[i] = KeyValue((Key)keys[i],values[i]);
-      });
-
-      /* perform parallel radix sort of the key/value pairs */
-      radix_sort<KeyValue,Key>(vec.data(),temp.data(),keys.size());
+      build(keys,values,keys.size());
     }
 
     /*! initialized the parallel map from user buffers with keys and values */
     template<typename SourceKey>
       void init(const BufferT<SourceKey>& keys, const BufferT<Val>& values) 
     {
-      /* reserve sufficient space for all data */
       assert(keys.size() == values.size());
-      vec.resize(keys.size());
-      temp.resize(keys.size());
-      
-      /* generate key/value pairs */
-      parallel_for( size_t(0), keys.size(), size_t(4*4096), [&](const range<size_t>& r) {
-	for (size_t i=r.begin(); i<r.end(); i++)
-	  vec[i] = KeyValue((Key)keys[i],values[i]);
-      });
-
-      /* perform parallel radix sort of the key/value pairs */
-      radix_sort<KeyValue,Key>(vec.data(),temp.data(),keys.size());
+      build(keys,values,keys.size());
     }
 
     /*! Returns a pointer to the value associated with the specified key. The pointer will be NULL of the key is not contained in the map. */
     __forceinline const Val* lookup(const Key& key) const 
     {
-      typename std::vector<KeyValue>::const_iterator i = std::lower_bound(vec.begin(), vec.end(), key);
-      if (i == vec.end()) return NULL;
-      if (i->key != key) return NULL;
-      return &i->val;
+      const Slot* slot = table.lookup(key);
+      if (slot == NULL) return NULL;
+      return &slot->val;
     }
 
     /*! If the key is in the map, the function returns the value associated with the key, otherwise it returns the default value. */
     __forceinline Val lookup(const Key& key, const Val& def) const 
     {
-      typename std::vector<KeyValue>::const_iterator i = std::lower_bound(vec.begin(), vec.end(), key);
-      if (i == vec.end()) return def;
-      if (i->key != key) return def;
-      return i->val;
+      const Slot* slot = table.lookup(key);
+      if (slot == NULL) return def;
+      return slot->val;
     }
 
     /*! cleans temporary state required for re-construction */
     void cleanup() {
-      temp.clear();
+      /* the hash table requires no temporary state */
     }
 
     /*! clears all state */
     void clear() {
-      vec.clear();
-      temp.clear();
+      table.clear();
+    }
+
+  private:
+
+    /*! inserts all key/value pairs into the hash table in parallel */
+    template<typename KeyArray, typename ValArray>
+      void build(const KeyArray& keys, const ValArray& values, const size_t N)
+    {
+      /* twice as many slots as keys keep the probe sequences short */
+      table.init(2*N);
+
+      /* insert all keys and remember their first occurrence */
+      parallel_for( size_t(0), N, size_t(4*4096), [&](const range<size_t>& r) {
+	for (size_t i=r.begin(); i<r.end(); i++) {
+          Slot* slot = table.insert((Key)keys[i]);
+          atomic_min_i32(&slot->index,int(i));
+        }
+      });
+
+      /* fetch the value of the first occurrence of each key */
+      parallel_for( size_t(0), table.size(), size_t(4*4096), [&](const range<size_t>& r) {
+	for (size_t i=r.begin(); i<r.end(); i++) {
+          Slot& slot = table[i];
+          if (slot.key != phash<Key,Slot>::EMPTY) slot.val = values[slot.index];
+        }
+      });
     }
 
   private:
-    std::vector<KeyValue> vec;    //!< vector containing sorted elements
-    std::vector<KeyValue> temp;   //!< temporary vector required during construction only
+    phash<Key,Slot> table;  //!< hash table containing all key/value pairs
   };
 }
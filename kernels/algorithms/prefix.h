@@ -16,7 +16,7 @@
 
 #pragma once
 
-#include "common/default.h"
+#include "parallel_for.h"
 
 namespace embree
 {
@@ -54,14 +54,13 @@ namespace embree
 	/* perform parallel prefix operation for large N */
 	else 
 	{
-	  LockStepTaskScheduler* scheduler = LockStepTaskScheduler::instance();
-	  const size_t numThreads = min(scheduler->getNumThreads(),MAX_THREADS);
+	  const size_t numThreads = min(getNumParallelThreads(),MAX_THREADS);
 
 	  /* first calculate range for each block */
-	  scheduler->dispatchTask(task_sum,this,0,numThreads);
+	  parallel_for(numThreads, [&](const size_t taskIndex) { sum(taskIndex,numThreads); });
 	  
 	  /* now calculate prefix_op for each block */
-	  scheduler->dispatchTask(task_prefix_op,this,0,numThreads);
+	  parallel_for(numThreads, [&](const size_t taskIndex) { prefix_op(taskIndex,numThreads); });
 	}
       }
       
@@ -100,14 +99,6 @@ namespace embree
         if (threadIndex == threadCount-1) 
           parent->value = count;
       }
-      
-      static void task_sum (void* data, const size_t threadIndex, const size_t threadCount) { 
-	((Task*)data)->sum(threadIndex,threadCount);                          
-      }
-      
-      static void task_prefix_op (void* data, const size_t threadIndex, const size_t threadCount) { 
-	((Task*)data)->prefix_op(threadIndex,threadCount);                          
-      }
 
     private:
       ParallelPrefixOp* const parent;
@@ -18,8 +18,7 @@
 
 #include "common/default.h"
 #include "common/buffer.h"
-#include "algorithms/sort.h"
-#include "algorithms/parallel_for.h"
+#include "algorithms/phash.h"
 
 namespace embree
 {
@@ -27,6 +26,14 @@ namespace embree
   template<typename T>
   class pset
   {
+    struct Slot
+    {
+      __forceinline Slot () : key(phash<T,Slot>::EMPTY) {}
+
+    public:
+      T key;
+    };
+
   public:
 
     /*! constructors for the parallel set */
@@ -35,60 +42,47 @@ namespace embree
     pset (const BufferT<T>    & in) { init(in); }
 
     /*! initialized the parallel set from a vector */
-    void init(const std::vector<T>& in) 
-    {
-      /* reserve sufficient space for all data */
-      vec.resize(in.size());
-      temp.resize(in.size());
-
-      /* copy data to temporary array */
-      parallel_for( size_t(0), in.size(), size_t(4*4096), [&](const range<size_t>& r) 
-      {
-	for (size_t i=r.begin(); i<r.end(); i++) 
-	  vec[i] = in[i];
-      });
-
-      /* sort the data */
-      radix_sort<T>(vec.data(),temp.data(),vec.size());
+    void init(const std::vector<T>& in) {
+      build(in,in.size());
     }
 
-
     /*! initialized the parallel set from a user buffer */
-    void init(const BufferT<T>& in) 
-    {
-      /* reserve sufficient space for all data */
-      vec.resize(in.size());
-      temp.resize(in.size());
-
-      /* copy data to temporary array */
-      parallel_for( size_t(0), in.size(), size_t(4*4096), [&](const range<size_t>& r) 
-      {
-	for (size_t i=r.begin(); i<r.end(); i++) 
-	  vec[i] = in[i];
-      });
-
-      /* parallel radix sort of the data */
-      radix_sort<T>(vec.data(),temp.data(),vec.size());
+    void init(const BufferT<T>& in) {
+      build(in,in.size());
     }
 
     /*! tests if some element is in the set */
     __forceinline bool lookup(const T& elt) const {
-      return std::binary_search(vec.begin(), vec.end(), elt);
+      return table.lookup(elt) != NULL;
     }
 
     /*! cleans temporary state required for re-construction */
     void cleanup() {
-      temp.clear();
+      /* the hash table requires no temporary state */
     }
 
     /*! clears all state */
     void clear() {
-      vec.clear();
-      temp.clear();
+      table.clear();
+    }
+
+  private:
+
+    /*! inserts all elements into the hash table in parallel */
+    template<typename Array>
+      void build(const Array& in, const size_t N)
+    {
+      /* twice as many slots as elements keep the probe sequences short */
+      table.init(2*N);
+
+      parallel_for( size_t(0), N, size_t(4*4096), [&](const range<size_t>& r) 
+      {
+	for (size_t i=r.begin(); i<r.end(); i++) 
+	  table.insert(in[i]);
+      });
     }
 
   private:
-    std::vector<T> vec;   //!< vector containing sorted elements
-    std::vector<T> temp;  //!< temporary vector required during construction only
+    phash<T,Slot> table;  //!< hash table containing all elements
   };
 }
@@ -36,6 +36,7 @@ namespace embree
       fflush(stdout);
 
       const size_t M = 10;
+      ParallelRadixSort sorter;
       for (size_t N=10; N<10000000; N*=2.1f)
       {
 	std::vector<Key> src(N); memset(src.data(),0,N*sizeof(Key));
@@ -48,7 +49,7 @@ namespace embree
 	/* sort numbers */
 	double t0 = getSeconds();
 	for (size_t i=0; i<M; i++) {
-          radix_sort<Key>(src.data(),tmp.data(),N);
+          sorter.sort<Key,Key>(src.data(),tmp.data(),N);
         }
 	double t1 = getSeconds();
 	printf("%zu/%3.2fM ",N,1E-6*double(N*M)/(t1-t0));
@@ -60,6 +61,15 @@ namespace embree
 	/* check if numbers are sorted */
 	for (size_t i=1; i<N; i++)
 	  passed &= src[i-1] <= src[i];
+
+	/* sort keys with few varying bits together with separate values */
+	std::vector<unsigned int> vals(N), tmpVals(N);
+	for (size_t i=0; i<N; i++) { src[i] = Key(rand()) & 0xFFFF0; vals[i] = (unsigned int) src[i]; }
+	radix_sort<Key,unsigned int>(src.data(),tmp.data(),vals.data(),tmpVals.data(),N);
+	for (size_t i=1; i<N; i++)
+	  passed &= src[i-1] <= src[i];
+	for (size_t i=0; i<N; i++)
+	  passed &= vals[i] == (unsigned int) src[i];
       }
       
       /* output if test passed or not */
@@ -20,12 +20,9 @@
 #include "sys/sysinfo.h"
 #include "sys/taskscheduler.h"
 #include "math/math.h"
+#include "parallel_for.h"
 #include <algorithm>
 
-#if defined(__MIC__)
- #include "simd/mic.h"
-#endif
-
 namespace embree
 {
   template<class T>
@@ -196,256 +193,167 @@ namespace embree
     }
 
 
-  class __aligned(64) ParallelRadixSort
+  /*! Parallel radix sort. The input is split into blocks that get
+   *  processed through nestable parallel_for calls, thus the sort scales
+   *  with the number of threads and can also get invoked from inside
+   *  other tasks. Passes whose digit is equal for all keys are
+   *  skipped. The scratch memory is kept by the object, thus sorting
+   *  repeatedly with the same object avoids allocations. */
+  class ParallelRadixSort
   {
   public:
 
 #if defined(__MIC__)
-    static const size_t MAX_THREADS = MAX_MIC_THREADS;
     static const size_t SINGLE_THREAD_THRESHOLD = MAX_MIC_THREADS*16;
 #else
-    static const size_t MAX_THREADS = 32;
     static const size_t SINGLE_THREAD_THRESHOLD = 3000;
 #endif
 
+    static const size_t MIN_BLOCK_SIZE = 4096;
     static const size_t BITS = 8;
     static const size_t BUCKETS = (1 << BITS);
-    typedef unsigned int TyRadixCount[MAX_THREADS][BUCKETS];
-    
-    template<typename Ty, typename Key>
-      class Task
-    {
-      template<typename T>
-	static bool compare(const T& v0, const T& v1) {
-	return (Key)v0 < (Key)v1;
-      }
-
-    public:
-      Task (ParallelRadixSort* parent, 
-	    Ty* const src, 
-	    Ty* const tmp, 
-	    const size_t N)
-	: parent(parent), src(src), tmp(tmp), N(N) 
-      {
-	/* perform single threaded sort for small N */
-	if (N<SINGLE_THREAD_THRESHOLD) 
-	{	  
-	  /* do inplace sort inside destination array */
-	  std::sort(src,src+N,compare<Ty>);
-	}
-	
-	/* perform parallel sort for large N */
-	else {
-	  LockStepTaskScheduler* scheduler = LockStepTaskScheduler::instance();
-	  const size_t numThreads = min(scheduler->getNumThreads(),MAX_THREADS);
-	  parent->barrier.init(numThreads);
-	  scheduler->dispatchTask(task_radixsort,this,0,numThreads);
-	}
-      }
-      
-    private:
-      
-      void radixIteration(const Key shift, 
-			  const bool last,
-			  Ty* __restrict const src, 
-			  Ty* __restrict const dst, 
-			  const size_t startID, const size_t endID, 
-			  const size_t threadIndex, const size_t threadCount)
-      {
-	/* mask to extract some number of bits */
-	const Key mask = BUCKETS-1;
-        
-	/* count how many items go into the buckets */
-	for (size_t i=0; i<BUCKETS; i++)
-	  parent->radixCount[threadIndex][i] = 0;
-	
-	for (size_t i=startID; i<endID; i++) {
-	  const Key index = ((Key)src[i] >> shift) & mask;
-	  parent->radixCount[threadIndex][index]++;
-	}
-	parent->barrier.wait(threadIndex,threadCount);
-	
-	/* calculate total number of items for each bucket */
-	__aligned(64) size_t total[BUCKETS];
-	for (size_t i=0; i<BUCKETS; i++)
-	  total[i] = 0;
-	
-	for (size_t i=0; i<threadCount; i++)
-	  for (size_t j=0; j<BUCKETS; j++)
-	    total[j] += parent->radixCount[i][j];
-	
-	/* calculate start offset of each bucket */
-	__aligned(64) size_t offset[BUCKETS];
-	offset[0] = 0;
-	for (size_t i=1; i<BUCKETS; i++)    
-	  offset[i] = offset[i-1] + total[i-1];
-	
-	/* calculate start offset of each bucket for this thread */
-	for (size_t i=0; i<threadIndex; i++)
-	  for (size_t j=0; j<BUCKETS; j++)
-	    offset[j] += parent->radixCount[i][j];
-	
-	/* copy items into their buckets */
-	for (size_t i=startID; i<endID; i++) {
-	  const Ty elt = src[i];
-	  const Key index = ((Key)src[i] >> shift) & mask;
-	  dst[offset[index]++] = elt;
-	}
-	if (!last) 
-	  parent->barrier.wait(threadIndex,threadCount);
-      }
-      
-#if defined(__MIC__)
-
-      void radixIteration(Ty* __restrict const src, 
-			  Ty* __restrict const dst, 
-			  const size_t startID, 
-			  const size_t endID, 
-			  const size_t threadIndex, 
-			  const size_t threadCount,
-			  const size_t byte_iteration)
-      {
-	const size_t L1_PREFETCH_ITEMS = 4;
-
-	for (size_t b=0; b<byte_iteration; b++)
-	  {
-#pragma unroll(16)
-	    for (size_t i=0; i<16; i++)
-	      store16i(&parent->radixCount[threadIndex][i*16],mic_i::zero());
-	    
-	    __assume_aligned(&parent->radixCount[threadIndex][0],64);
-
-	    for (size_t i=startID; i<endID; i++) {
-	      const Key &key = src[i];
-	      const unsigned char *__restrict const byte = (const unsigned char*)&key;
-	      prefetch<PFHINT_NT>(byte + 64*4);
-	      parent->radixCount[threadIndex][(unsigned int)byte[b]]++;
-	    }
-
-	    parent->barrier.wait(threadIndex,threadCount);
-
-	    mic_i count[16];
-#pragma unroll(16)
-	    for (size_t i=0; i<16; i++)
-	      count[i] = mic_i::zero();
 
+    /*! per block state */
+    struct __aligned(64) Block
+    {
+      size_t count[BUCKETS]; //!< number of items per bucket, turned into bucket offsets
+      uint64 bits;           //!< key bits that differ inside the block
+    };
 
-	    for (size_t i=0; i<threadIndex; i++)
-#pragma unroll(16)
-	      for (size_t j=0; j<16; j++)
-		count[j] += load16i((int*)&parent->radixCount[i][j*16]);
-      
-	    __aligned(64) unsigned int inner_offset[BUCKETS];
-
-#pragma unroll(16)
-	    for (size_t i=0; i<16; i++)
-	      store16i(&inner_offset[i*16],count[i]);
-
-#pragma unroll(16)
-	    for (size_t i=0; i<16; i++)
-	      count[i] = load16i((int*)&inner_offset[i*16]);
-
-	    for (size_t i=threadIndex; i<threadCount; i++)
-#pragma unroll(16)
-	      for (size_t j=0; j<16; j++)
-		count[j] += load16i((int*)&parent->radixCount[i][j*16]);	  
-
-	    __aligned(64) unsigned int total[BUCKETS];
-
-#pragma unroll(16)
-	    for (size_t i=0; i<16; i++)
-	      store16i(&total[i*16],count[i]);
+  private:
+    template<typename Ty, typename Key>
+      static bool compare(const Ty& v0, const Ty& v1) {
+      return (Key)v0 < (Key)v1;
+    }
 
-	    __aligned(64) unsigned int offset[BUCKETS];
+  public:
+    ParallelRadixSort () 
+      : blocks(NULL), numAllocatedBlocks(0) {}
 
-	    /* calculate start offset of each bucket */
-	    offset[0] = 0;
-	    for (size_t i=1; i<BUCKETS; i++)    
-	      offset[i] = offset[i-1] + total[i-1];
-      
-	    /* calculate start offset of each bucket for this thread */
+    ~ParallelRadixSort () {
+      alignedFree(blocks);
+    }
 
-#pragma unroll(BUCKETS)
-	    for (size_t j=0; j<BUCKETS; j++)
-	      offset[j] += inner_offset[j];
-	    
-	    for (size_t i=startID; i<endID; i++) {
-	      const Key &key = src[i];
+    /*! sorts the items of src by their key, tmp has to provide space for N items */
+    template<typename Ty, typename Key>
+      void sort(Ty* const src, Ty* const tmp, const size_t N)
+    {
+      /* perform single threaded sort for small N */
+      if (N<SINGLE_THREAD_THRESHOLD) 
+        std::sort(src,src+N,compare<Ty,Key>);
+      else
+        radixsort<Ty,Key,char>(src,tmp,NULL,NULL,N);
+    }
 
-	      const unsigned char *__restrict const byte = (const unsigned char*)&key;
-	      prefetch<PFHINT_NT>((char*)byte + 2*64);
+    /*! sorts the keys and reorders the values in separate arrays the same way */
+    template<typename Key, typename Val>
+      void sort(Key* const keys, Key* const tmpKeys, Val* const vals, Val* const tmpVals, const size_t N) {
+      radixsort<Key,Key,Val>(keys,tmpKeys,vals,tmpVals,N);
+    }
 
-	      const unsigned int index = byte[b];
+  private:
 
-	      assert(index < BUCKETS);
-	      dst[offset[index]] = src[i];
-	      prefetch<PFHINT_L2EX>(&dst[offset[index]+L1_PREFETCH_ITEMS]);
-	      offset[index]++;
-	    }
+    /*! makes sure state for numBlocks blocks is allocated */
+    void allocBlocks(const size_t numBlocks)
+    {
+      if (numBlocks <= numAllocatedBlocks) return;
+      alignedFree(blocks);
+      blocks = (Block*) alignedMalloc(numBlocks*sizeof(Block));
+      numAllocatedBlocks = numBlocks;
+    }
 
-	    if (b<byte_iteration-1) parent->barrier.wait(threadIndex,threadCount);
-	    std::swap(src,dst);
-	  }
-	
+    template<typename Ty, typename Key, typename Val>
+      void radixsort(Ty* src, Ty* tmp, Val* vsrc, Val* vtmp, const size_t N)
+    {
+      if (N == 0) return;
+      const size_t numBlocks = max(size_t(1),min(getNumParallelThreads(),N/MIN_BLOCK_SIZE));
+      allocBlocks(numBlocks);
+
+      /* find key bits that are not equal for all keys */
+      const Key first = (Key)src[0];
+      parallel_for(numBlocks, [&](const size_t block) {
+          const size_t startID = (block+0)*N/numBlocks;
+          const size_t endID   = (block+1)*N/numBlocks;
+          Key bits = 0;
+          for (size_t i=startID; i<endID; i++)
+            bits |= (Key)src[i] ^ first;
+          blocks[block].bits = bits;
+        });
+      uint64 bits = 0;
+      for (size_t i=0; i<numBlocks; i++)
+        bits |= blocks[i].bits;
+
+      size_t passes = 0;
+      const Key mask = BUCKETS-1;
+      for (size_t shift=0; shift<8*sizeof(Key); shift+=BITS)
+      {
+        /* skip pass if all keys have the same digit */
+        if (((bits >> shift) & mask) == 0) continue;
+
+        /* count how many items of each block go into the buckets */
+        parallel_for(numBlocks, [&](const size_t block) {
+            const size_t startID = (block+0)*N/numBlocks;
+            const size_t endID   = (block+1)*N/numBlocks;
+            size_t* __restrict const count = blocks[block].count;
+            for (size_t i=0; i<BUCKETS; i++)
+              count[i] = 0;
+            for (size_t i=startID; i<endID; i++)
+              count[((Key)src[i] >> shift) & mask]++;
+          });
+
+        /* calculate start offset of each bucket for each block */
+        size_t start = 0;
+        for (size_t i=0; i<BUCKETS; i++) {
+          for (size_t j=0; j<numBlocks; j++) {
+            const size_t n = blocks[j].count[i];
+            blocks[j].count[i] = start;
+            start += n;
+          }
+        }
+
+        /* copy items into their buckets */
+        parallel_for(numBlocks, [&](const size_t block) {
+            const size_t startID = (block+0)*N/numBlocks;
+            const size_t endID   = (block+1)*N/numBlocks;
+            __aligned(64) size_t offset[BUCKETS];
+            for (size_t i=0; i<BUCKETS; i++)
+              offset[i] = blocks[block].count[i];
+
+            if (vsrc) {
+              for (size_t i=startID; i<endID; i++) {
+                const size_t index = offset[((Key)src[i] >> shift) & mask]++;
+                tmp[index] = src[i];
+                vtmp[index] = vsrc[i];
+              }
+            } 
+            else {
+              for (size_t i=startID; i<endID; i++) 
+                tmp[offset[((Key)src[i] >> shift) & mask]++] = src[i];
+            }
+          });
+
+        std::swap(src,tmp);
+        std::swap(vsrc,vtmp);
+        passes++;
       }
 
-      
-#endif
-      void radixsort(const size_t threadIndex, const size_t numThreads)
+      /* after an odd number of passes the sorted items are in the temporary array */
+      if (passes % 2) 
       {
-	const size_t startID = (threadIndex+0)*N/numThreads;
-	const size_t endID   = (threadIndex+1)*N/numThreads;
-
-#if !defined(__MIC__)
-	if (sizeof(Key) == sizeof(uint32)) {
-	  radixIteration(0*BITS,0,src,tmp,startID,endID,threadIndex,numThreads);
-	  radixIteration(1*BITS,0,tmp,src,startID,endID,threadIndex,numThreads);
-	  radixIteration(2*BITS,0,src,tmp,startID,endID,threadIndex,numThreads);
-	  radixIteration(3*BITS,1,tmp,src,startID,endID,threadIndex,numThreads);
-	}
-	else if (sizeof(Key) == sizeof(uint64))
-	{
-	  radixIteration(0*BITS,0,src,tmp,startID,endID,threadIndex,numThreads);
-	  radixIteration(1*BITS,0,tmp,src,startID,endID,threadIndex,numThreads);
-	  radixIteration(2*BITS,0,src,tmp,startID,endID,threadIndex,numThreads);
-	  radixIteration(3*BITS,0,tmp,src,startID,endID,threadIndex,numThreads);
-	  radixIteration(4*BITS,0,src,tmp,startID,endID,threadIndex,numThreads);
-	  radixIteration(5*BITS,0,tmp,src,startID,endID,threadIndex,numThreads);
-	  radixIteration(6*BITS,0,src,tmp,startID,endID,threadIndex,numThreads);
-	  radixIteration(7*BITS,1,tmp,src,startID,endID,threadIndex,numThreads);
-	}
-#else
-	if (sizeof(Key) == sizeof(uint32)) 
-	  radixIteration(src,tmp,startID,endID,threadIndex,numThreads,4);
-	else if (sizeof(Key) == sizeof(uint64)) 
-	  radixIteration(src,tmp,startID,endID,threadIndex,numThreads,8);
-#endif
-
-      }
-      
-      static void task_radixsort (void* data, const size_t threadIndex, const size_t threadCount) { 
-	((Task*)data)->radixsort(threadIndex,threadCount);                          
+        parallel_for(numBlocks, [&](const size_t block) {
+            const size_t startID = (block+0)*N/numBlocks;
+            const size_t endID   = (block+1)*N/numBlocks;
+            for (size_t i=startID; i<endID; i++) tmp[i] = src[i];
+            if (vsrc) for (size_t i=startID; i<endID; i++) vtmp[i] = vsrc[i];
+          });
       }
+    }
 
-    private:
-      ParallelRadixSort* const parent;
-      Ty* const src;
-      Ty* const tmp;
-      const size_t N;
-    };
-    
   private:
-    __aligned(64) TyRadixCount radixCount;
-/* #if defined(__MIC__) */
-/*     __aligned(64) QuadTreeBarrier barrier; */
-/* #else */
-    LinearBarrierActive barrier; // FIXME: should be able to speficy number of threads here
-/* #endif */
+    Block* blocks;             //!< state for each block
+    size_t numAllocatedBlocks; //!< number of allocated blocks
   };
 
-  /*! shared state for parallel radix sort */
-  //extern ParallelRadixSort shared_radix_sort_state;
-
   /*! parallel radix sort */
   template<typename Key>
   struct ParallelRadixSortT
@@ -455,7 +363,7 @@ namespace embree
 
     template<typename Ty>
     void operator() (Ty* const src, Ty* const tmp, const size_t N) {
-      ParallelRadixSort::Task<Ty,Key>(&state,src,tmp,N);
+      state.sort<Ty,Key>(src,tmp,N);
     }
 
     ParallelRadixSort& state;
@@ -465,8 +373,14 @@ namespace embree
     void radix_sort(Ty* const src, Ty* const tmp, const size_t N)
   {
     ParallelRadixSort radix_sort_state;
-    ParallelRadixSortT<Key> sort(radix_sort_state);
-    sort(src,tmp,N);
+    radix_sort_state.sort<Ty,Key>(src,tmp,N);
+  }
+
+  template<typename Key, typename Val>
+    void radix_sort(Key* const keys, Key* const tmpKeys, Val* const vals, Val* const tmpVals, const size_t N)
+  {
+    ParallelRadixSort radix_sort_state;
+    radix_sort_state.sort<Key,Val>(keys,tmpKeys,vals,tmpVals,N);
   }
 
   template<typename Ty>
@@ -28,11 +28,13 @@ namespace embree
   public:
 
     typedef RTCIntersectFunc IntersectFunc;
+    typedef RTCIntersectFuncN IntersectFuncN;
     typedef RTCIntersectFunc4 IntersectFunc4;
     typedef RTCIntersectFunc8 IntersectFunc8;
     typedef RTCIntersectFunc16 IntersectFunc16;
     
     typedef RTCOccludedFunc OccludedFunc;
+    typedef RTCOccludedFuncN OccludedFuncN;
     typedef RTCOccludedFunc4 OccludedFunc4;
     typedef RTCOccludedFunc8 OccludedFunc8;
     typedef RTCOccludedFunc16 OccludedFunc16;
@@ -69,6 +71,16 @@ namespace embree
         OccludedFunc occluded;  
       };
       
+      struct IntersectorN
+      {
+        IntersectorN () 
+        : intersect(NULL), occluded(NULL) {}
+
+      public:
+        IntersectFuncN intersect;
+        OccludedFuncN occluded;  
+      };
+      
       struct Intersector4 
       {
         Intersector4 (ErrorFunc error = NULL) 
@@ -126,7 +138,7 @@ namespace embree
     public:
       
       /*! Construction */
-      AccelSet (size_t numItems) : numItems(numItems) {
+      AccelSet (size_t numItems) : numItems(numItems), boundsFunc(NULL), boundsFuncN(NULL) {
         intersectors.ptr = NULL; 
       }
       
@@ -148,8 +160,16 @@ namespace embree
       __forceinline BBox3fa bounds (size_t item) const
       {
         BBox3fa box; 
-        boundsFunc(intersectors.ptr,item,(RTCBounds&)box);
-        return box;
+        if (boundsFunc) {
+          boundsFunc(intersectors.ptr,item,(RTCBounds&)box);
+          return box;
+        }
+
+        /* only the batched bounding function got set */
+        assert(boundsFuncN);
+        float lower_x, lower_y, lower_z, upper_x, upper_y, upper_z;
+        boundsFuncN(intersectors.ptr,item,item+1,&lower_x,&lower_y,&lower_z,&upper_x,&upper_y,&upper_z);
+        return BBox3fa(Vec3fa(lower_x,lower_y,lower_z),Vec3fa(upper_x,upper_y,upper_z));
       }
       
       /*! Intersects a single ray with the scene. */
@@ -158,6 +178,17 @@ namespace embree
         intersectors.intersector1.intersect(intersectors.ptr,ray,item);
       }
       
+      /*! checks if a stream intersect function is set */
+      __forceinline bool hasIntersectN () const {
+        return intersectors.intersectorN.intersect != NULL;
+      }
+
+      /*! Intersects N (ray, item) pairs with the scene. */
+      __forceinline void intersectN (RTCRay* rays, const unsigned* rayIDs, const size_t* items, size_t N) {
+        assert(intersectors.intersectorN.intersect);
+        intersectors.intersectorN.intersect(intersectors.ptr,rays,rayIDs,items,N);
+      }
+      
       /*! Intersects a packet of 4 rays with the scene. */
       __forceinline void intersect4 (const void* valid, RTCRay4& ray, size_t item) {
 #if defined(__SSE__)
@@ -196,6 +227,17 @@ namespace embree
         intersectors.intersector1.occluded(intersectors.ptr,ray,item);
       }
       
+      /*! checks if a stream occlusion function is set */
+      __forceinline bool hasOccludedN () const {
+        return intersectors.intersectorN.occluded != NULL;
+      }
+
+      /*! Tests if the rays of N (ray, item) pairs are occluded by the scene. */
+      __forceinline void occludedN (RTCRay* rays, const unsigned* rayIDs, const size_t* items, size_t N) {
+        assert(intersectors.intersectorN.occluded);
+        intersectors.intersectorN.occluded(intersectors.ptr,rays,rayIDs,items,N);
+      }
+      
       /*! Tests if a packet of 4 rays is occluded by the scene. */
 #if defined(__SSE__)
       __forceinline void occluded4 (const void* valid, RTCRay4& ray, size_t item) {
@@ -231,6 +273,7 @@ namespace embree
     public:
       size_t numItems;
       RTCBoundsFunc boundsFunc;
+      RTCBoundsFuncN boundsFuncN;
 
       struct Intersectors 
       {
@@ -238,6 +281,7 @@ namespace embree
       public:
         void* ptr;
         Intersector1 intersector1;
+        IntersectorN intersectorN;
         Intersector4 intersector4;
         Intersector8 intersector8;
         Intersector16 intersector16;
@@ -75,12 +75,12 @@ namespace embree
     }
     
     /*! Returns all allocated blocks to Alloc class. */
-    ~AllocatorBase () {
-      clear();
+    virtual ~AllocatorBase () {
+      AllocatorBase::clear();
     }
 
     /*! clears the allocator */
-    void clear () 
+    virtual void clear () 
     {
       for (size_t i=0; i<blocks.size(); i++) {
         Alloc::global.free(blocks[i]); 
@@ -210,10 +210,13 @@ namespace embree
       size_t bytesUsed = block.getUsedBytes();
       size_t bytesFree = block.getFreeBytes();
       
-      printf("allocated = %3.2fMB, reserved = %3.2fMB, used = %3.2fMB (%3.2f%%), free = %3.2fMB (%3.2f%%)\n",
-	     1E-6f*bytesAllocated, 1E-6f*bytesReserved,
-	     1E-6f*bytesUsed, 100.0f*bytesUsed/bytesAllocated,
-	     1E-6f*bytesFree, 100.0f*bytesFree/bytesAllocated);
+      /* print through std::cout as the callers print the prefix through std::cout */
+      char str[256];
+      snprintf(str,sizeof(str),"allocated = %3.2fMB, reserved = %3.2fMB, used = %3.2fMB (%3.2f%%), free = %3.2fMB (%3.2f%%)\n",
+	       1E-6f*bytesAllocated, 1E-6f*bytesReserved,
+	       1E-6f*bytesUsed, 100.0f*bytesUsed/bytesAllocated,
+	       1E-6f*bytesFree, 100.0f*bytesFree/bytesAllocated);
+      std::cout << str << std::flush;
     }
 
   private:
@@ -506,11 +509,13 @@ namespace embree
 	bytesWasted += thread_local_allocators.threads[t]->getWastedBytes();
       }
       
-      printf("allocated = %3.2fMB, reserved = %3.2fMB, used = %3.2fMB (%3.2f%%), wasted = %3.2fMB (%3.2f%%), free = %3.2fMB (%3.2f%%)\n",
-	     1E-6f*bytesAllocated, 1E-6f*bytesReserved,
-	     1E-6f*bytesUsed, 100.0f*bytesUsed/bytesAllocated,
-	     1E-6f*bytesWasted, 100.0f*bytesWasted/bytesAllocated,
-	     1E-6f*bytesFree, 100.0f*bytesFree/bytesAllocated);
+      char str[256];
+      snprintf(str,sizeof(str),"allocated = %3.2fMB, reserved = %3.2fMB, used = %3.2fMB (%3.2f%%), wasted = %3.2fMB (%3.2f%%), free = %3.2fMB (%3.2f%%)\n",
+	       1E-6f*bytesAllocated, 1E-6f*bytesReserved,
+	       1E-6f*bytesUsed, 100.0f*bytesUsed/bytesAllocated,
+	       1E-6f*bytesWasted, 100.0f*bytesWasted/bytesAllocated,
+	       1E-6f*bytesFree, 100.0f*bytesFree/bytesAllocated);
+      std::cout << str << std::flush;
     }
 
   private:
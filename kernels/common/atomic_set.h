@@ -60,6 +60,12 @@ namespace embree
       {
         item* ptr; 
         while (!try_take(ptr));
+
+        /* start fetching the following element while this one gets processed */
+        if (ptr && ptr->next) {
+          for (size_t i=0; i<prefetchLines; i++)
+            prefetchL2((char*)ptr->next + 64*i);
+        }
         return ptr;
       }
 
@@ -72,6 +78,7 @@ namespace embree
       }
   
     private:
+      static const size_t prefetchLines = 4;
       item* root;
     };
 
@@ -84,6 +84,10 @@ namespace embree
 
   /* global settings */
   extern size_t g_numThreads;
+  extern std::string g_tasking_system;
+  extern std::string g_thread_affinity;
+  extern size_t g_idle_spin_rounds;
+  extern size_t g_idle_yield_rounds;
   extern size_t g_verbose;
 
   extern std::string g_tri_accel;
@@ -101,6 +105,9 @@ namespace embree
   extern double g_hair_builder_replication_factor;
 
   extern std::string g_subdiv_accel;
+  extern std::string g_subdiv_displacement_bounds;
+
+  extern std::string g_point_accel;
 
   extern int g_scene_flags;
   extern size_t g_benchmark;
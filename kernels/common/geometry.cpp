@@ -21,7 +21,7 @@ namespace embree
 {
   Geometry::Geometry (Scene* parent, GeometryTy type, size_t numPrimitives, RTCGeometryFlags flags) 
     : parent(parent), type(type), numPrimitives(numPrimitives), id(0), flags(flags), state(ENABLING),
-      intersectionFilter1(NULL), occlusionFilter1(NULL),
+      intersectionFilter1(NULL), occlusionFilter1(NULL), intersectionFilterN(NULL), occlusionFilterN(NULL),
       intersectionFilter4(NULL), occlusionFilter4(NULL), ispcIntersectionFilter4(NULL), ispcOcclusionFilter4(NULL), 
       intersectionFilter8(NULL), occlusionFilter8(NULL), ispcIntersectionFilter8(NULL), ispcOcclusionFilter8(NULL), 
       intersectionFilter16(NULL), occlusionFilter16(NULL), ispcIntersectionFilter16(NULL), ispcOcclusionFilter16(NULL), 
@@ -162,6 +162,15 @@ namespace embree
     intersectionFilter1 = filter;
   }
     
+  void Geometry::setIntersectionFilterFunctionN (RTCFilterFuncN filter) 
+  {
+    if (type != TRIANGLE_MESH && type != BEZIER_CURVES) {
+      process_error(RTC_INVALID_OPERATION,"filter functions only supported for triangle meshes and hair geometries"); 
+      return;
+    }
+    intersectionFilterN = filter;
+  }
+    
   void Geometry::setIntersectionFilterFunction4 (RTCFilterFunc4 filter, bool ispc) 
   { 
     if (type != TRIANGLE_MESH && type != BEZIER_CURVES) {
@@ -210,6 +219,15 @@ namespace embree
     occlusionFilter1 = filter;
   }
     
+  void Geometry::setOcclusionFilterFunctionN (RTCFilterFuncN filter) 
+  {
+    if (type != TRIANGLE_MESH && type != BEZIER_CURVES) {
+      process_error(RTC_INVALID_OPERATION,"filter functions only supported for triangle meshes and hair geometries"); 
+      return;
+    }
+    occlusionFilterN = filter;
+  }
+    
   void Geometry::setOcclusionFilterFunction4 (RTCFilterFunc4 filter, bool ispc) 
   { 
     if (type != TRIANGLE_MESH && type != BEZIER_CURVES) {
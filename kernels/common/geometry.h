@@ -24,7 +24,7 @@ namespace embree
   class Scene;
 
   /*! type of geometry */
-  enum GeometryTy { TRIANGLE_MESH = 1, USER_GEOMETRY = 2, BEZIER_CURVES = 4, SUBDIV_MESH = 8 /*, INSTANCES = 16*/ };
+  enum GeometryTy { TRIANGLE_MESH = 1, USER_GEOMETRY = 2, BEZIER_CURVES = 4, SUBDIV_MESH = 8 /*, INSTANCES = 16*/, POINTS = 32 };
   
 #if defined(__SSE__)
   typedef void (*ISPCFilterFunc4)(void* ptr, RTCRay4& ray, __m128 valid);
@@ -116,6 +116,11 @@ namespace embree
       process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
     }
 
+    /*! Sets alpha mask. */
+    virtual void setAlphaMask (const void* bits, size_t width, size_t height) { 
+      process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
+    }
+
     /*! Maps specified buffer. */
     virtual void* map(RTCBufferType type) { 
       process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
@@ -137,9 +142,28 @@ namespace embree
       process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
     }
 
+    /*! Set edge level function. */
+    virtual void setEdgeLevelFunction (RTCEdgeLevelFunc func) {
+      process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
+    }
+
+    /*! Set camera for view dependent edge levels. */
+    virtual void setEdgeLevelCamera (const float* pos, float levelFactor) {
+      process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
+    }
+
+    /*! Interpolates vertex data to multiple u/v locations. */
+    virtual void interpolateN(const void* valid, const unsigned* primIDs, const float* u, const float* v, size_t numUVs, 
+                              RTCBufferType buffer, float* P, float* dPdu, float* dPdv, size_t numFloats) {
+      process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
+    }
+
     /*! Set intersection filter function for single rays. */
     virtual void setIntersectionFilterFunction (RTCFilterFunc filter, bool ispc = false);
     
+    /*! Set batched intersection filter function for single rays. */
+    virtual void setIntersectionFilterFunctionN (RTCFilterFuncN filterN);
+    
     /*! Set intersection filter function for ray packets of size 4. */
     virtual void setIntersectionFilterFunction4 (RTCFilterFunc4 filter4, bool ispc = false);
     
@@ -152,6 +176,9 @@ namespace embree
     /*! Set occlusion filter function for single rays. */
     virtual void setOcclusionFilterFunction (RTCFilterFunc filter, bool ispc = false);
     
+    /*! Set batched occlusion filter function for single rays. */
+    virtual void setOcclusionFilterFunctionN (RTCFilterFuncN filterN);
+    
     /*! Set occlusion filter function for ray packets of size 4. */
     virtual void setOcclusionFilterFunction4 (RTCFilterFunc4 filter4, bool ispc = false);
     
@@ -181,12 +208,22 @@ namespace embree
     virtual void setBoundsFunction (RTCBoundsFunc bounds) { 
       process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
     }
+
+    /*! Set batched bounds function. */
+    virtual void setBoundsFunctionN (RTCBoundsFuncN boundsN) { 
+      process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
+    }
     
     /*! Set intersect function for single rays. */
     virtual void setIntersectFunction (RTCIntersectFunc intersect, bool ispc = false) { 
       process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
     }
     
+    /*! Set intersect function for streams of single rays. */
+    virtual void setIntersectFunctionN (RTCIntersectFuncN intersectN) { 
+      process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
+    }
+    
     /*! Set intersect function for ray packets of size 4. */
     virtual void setIntersectFunction4 (RTCIntersectFunc4 intersect4, bool ispc = false) { 
       process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
@@ -207,6 +244,11 @@ namespace embree
       process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
     }
     
+    /*! Set occlusion function for streams of single rays. */
+    virtual void setOccludedFunctionN (RTCOccludedFuncN occludedN) { 
+      process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
+    }
+    
     /*! Set occlusion function for ray packets of size 4. */
     virtual void setOccludedFunction4 (RTCOccludedFunc4 occluded4, bool ispc = false) { 
       process_error(RTC_INVALID_OPERATION,"operation not supported for this geometry"); 
@@ -241,6 +283,9 @@ namespace embree
     RTCFilterFunc intersectionFilter1;
     RTCFilterFunc occlusionFilter1;
 
+    RTCFilterFuncN intersectionFilterN; //!< batched filter, replaces intersectionFilter1 when set
+    RTCFilterFuncN occlusionFilterN;    //!< batched filter, replaces occlusionFilter1 when set
+
     RTCFilterFunc4 intersectionFilter4;
     RTCFilterFunc4 occlusionFilter4;
     void* ispcIntersectionFilter4; // FIXME: this ISPC mode can be encoded more compactly
@@ -256,14 +301,17 @@ namespace embree
     void* ispcIntersectionFilter16;
     void* ispcOcclusionFilter16;
 
-    __forceinline bool hasIntersectionFilter1() const { return intersectionFilter1 != NULL; }
+    __forceinline bool hasIntersectionFilter1() const { return (intersectionFilter1 != NULL) | (intersectionFilterN != NULL); }
     __forceinline bool hasIntersectionFilter4() const { return intersectionFilter4 != NULL; }
     __forceinline bool hasIntersectionFilter8() const { return intersectionFilter8 != NULL; }
     __forceinline bool hasIntersectionFilter16() const { return intersectionFilter16 != NULL; }
 
-    __forceinline bool hasOcclusionFilter1() const { return occlusionFilter1 != NULL; }
+    __forceinline bool hasOcclusionFilter1() const { return (occlusionFilter1 != NULL) | (occlusionFilterN != NULL); }
     __forceinline bool hasOcclusionFilter4() const { return occlusionFilter4 != NULL; }
     __forceinline bool hasOcclusionFilter8() const { return occlusionFilter8 != NULL; }
     __forceinline bool hasOcclusionFilter16() const { return occlusionFilter16 != NULL; }
+
+    __forceinline bool hasIntersectionFilterN() const { return intersectionFilterN != NULL; }
+    __forceinline bool hasOcclusionFilterN() const { return occlusionFilterN != NULL; }
   };
 }
@@ -24,7 +24,9 @@
 #include "common/alloc.h"
 #include "embree2/rtcore.h"
 #include "common/scene.h"
+#include "common/subdiv/tessellation_cache.h"
 #include "sys/taskscheduler.h"
+#include "sys/taskscheduler_app.h"
 #include "sys/thread.h"
 #include "raystream_log.h"
 
@@ -89,10 +91,23 @@ namespace embree
   float       g_memory_preallocation_factor = 1.0f; 
 
   std::string g_subdiv_accel = "default";               //!< acceleration structure to use for subdivision surfaces
+  std::string g_subdiv_displacement_bounds = "user";    //!< use user specified or estimated per patch displacement bounds
+  size_t g_tessellation_cache_size = SharedTessellationCache::DEFAULT_64B_BLOCKS*64/(1024*1024);         //!< initial size of the tessellation cache in MB
+  size_t g_tessellation_cache_max_size = SharedTessellationCache::DEFAULT_MAX_64B_BLOCKS*64/(1024*1024); //!< maximal size the tessellation cache may grow to in MB
+  size_t g_tessellation_cache_segments = SharedTessellationCache::DEFAULT_SEGMENTS;                      //!< number of segments of the tessellation cache
+
+  std::string g_point_accel = "default";                //!< acceleration structure to use for points
 
   int g_scene_flags = -1;                               //!< scene flags to use
   size_t g_verbose = 0;                                 //!< verbosity of output
   size_t g_numThreads = 0;                              //!< number of threads to use in builders
+  std::string g_tasking_system = "default";             //!< task scheduler implementation to use
+  std::string g_thread_affinity = "default";            //!< placement policy of the worker threads
+  RTCSpawnFunc g_spawn_function = NULL;                 //!< spawns tasks into the thread pool of the application
+  RTCWaitFunc g_wait_function = NULL;                   //!< lets a thread help the thread pool of the application
+  void* g_tasking_user_ptr = NULL;                      //!< user pointer passed to the tasking callbacks
+  size_t g_idle_spin_rounds = IdlePolicy::DEFAULT_SPIN_ROUNDS;   //!< pause rounds of waiting threads before yielding
+  size_t g_idle_yield_rounds = IdlePolicy::DEFAULT_YIELD_ROUNDS; //!< yield rounds of waiting threads before sleeping
   size_t g_benchmark = 0;
   size_t g_regression_testing = 0;                      //!< enables regression tests at startup
 
@@ -114,10 +129,20 @@ namespace embree
     g_memory_preallocation_factor = 1.0f;
 
     g_subdiv_accel = "default";
+    g_subdiv_displacement_bounds = "user";
+    g_tessellation_cache_size = SharedTessellationCache::DEFAULT_64B_BLOCKS*64/(1024*1024);
+    g_tessellation_cache_max_size = SharedTessellationCache::DEFAULT_MAX_64B_BLOCKS*64/(1024*1024);
+    g_tessellation_cache_segments = SharedTessellationCache::DEFAULT_SEGMENTS;
+
+    g_point_accel = "default";
 
     g_scene_flags = -1;
     g_verbose = 0;
     g_numThreads = 0;
+    g_tasking_system = "default";
+    g_thread_affinity = "default";
+    g_idle_spin_rounds = IdlePolicy::DEFAULT_SPIN_ROUNDS;
+    g_idle_yield_rounds = IdlePolicy::DEFAULT_YIELD_ROUNDS;
     g_benchmark = 0;
   }
 
@@ -125,6 +150,10 @@ namespace embree
   {
     std::cout << "general:" << std::endl;
     std::cout << "  build threads = " << g_numThreads << std::endl;
+    std::cout << "  tasking       = " << g_tasking_system << std::endl;
+    std::cout << "  affinity      = " << g_thread_affinity << std::endl;
+    std::cout << "  idle spin     = " << g_idle_spin_rounds << std::endl;
+    std::cout << "  idle yield    = " << g_idle_yield_rounds << std::endl;
     std::cout << "  verbosity     = " << g_verbose << std::endl;
 
     std::cout << "triangles:" << std::endl;
@@ -146,6 +175,13 @@ namespace embree
 
     std::cout << "subdivision surfaces:" << std::endl;
     std::cout << "  accel         = " << g_subdiv_accel << std::endl;
+    std::cout << "  displ. bounds = " << g_subdiv_displacement_bounds << std::endl;
+    std::cout << "  cache size    = " << g_tessellation_cache_size << " MB" << std::endl;
+    std::cout << "  cache maxsize = " << g_tessellation_cache_max_size << " MB" << std::endl;
+    std::cout << "  cache segments= " << g_tessellation_cache_segments << std::endl;
+
+    std::cout << "points:" << std::endl;
+    std::cout << "  accel         = " << g_point_accel << std::endl;
 
 #if defined(__MIC__)
     std::cout << "memory allocation:" << std::endl;
@@ -269,6 +305,14 @@ namespace embree
           }
 #endif
         }
+        else if (tok == "tasking_system" && parseSymbol (cfg,'=',pos))
+          g_tasking_system = parseIdentifier (cfg,pos);
+        else if (tok == "affinity" && parseSymbol (cfg,'=',pos))
+          g_thread_affinity = parseIdentifier (cfg,pos);
+        else if (tok == "idle_spin" && parseSymbol (cfg,'=',pos))
+          g_idle_spin_rounds = parseInt (cfg,pos);
+        else if (tok == "idle_yield" && parseSymbol (cfg,'=',pos))
+          g_idle_yield_rounds = parseInt (cfg,pos);
         else if (tok == "isa" && parseSymbol (cfg,'=',pos)) 
 	{
 	  std::string isa = parseIdentifier (cfg,pos);
@@ -312,6 +356,18 @@ namespace embree
 
         else if (tok == "subdiv_accel" && parseSymbol (cfg,'=',pos))
             g_subdiv_accel = parseIdentifier (cfg,pos);
+        else if (tok == "subdiv_displacement_bounds" && parseSymbol (cfg,'=',pos))
+            g_subdiv_displacement_bounds = parseIdentifier (cfg,pos);
+
+        else if (tok == "tessellation_cache_size" && parseSymbol (cfg,'=',pos))
+          g_tessellation_cache_size = parseInt (cfg,pos);
+        else if (tok == "tessellation_cache_max_size" && parseSymbol (cfg,'=',pos))
+          g_tessellation_cache_max_size = parseInt (cfg,pos);
+        else if (tok == "tessellation_cache_segments" && parseSymbol (cfg,'=',pos))
+          g_tessellation_cache_segments = parseInt (cfg,pos);
+
+        else if (tok == "point_accel" && parseSymbol (cfg,'=',pos))
+            g_point_accel = parseIdentifier (cfg,pos);
 	
         else if (tok == "verbose" && parseSymbol (cfg,'=',pos))
             g_verbose = parseInt (cfg,pos);
@@ -389,6 +445,10 @@ namespace embree
 
     init_globals();
 
+    sharedTessellationCache.configure(g_tessellation_cache_size*1024*1024,
+                                      g_tessellation_cache_max_size*1024*1024,
+                                      g_tessellation_cache_segments);
+
 #if !defined(__MIC__)
     BVH4Register();
 #else
@@ -405,10 +465,17 @@ namespace embree
     
     InstanceIntersectorsRegister();
 
+    if (g_spawn_function)
+      g_tasking_system = "app";
+
     if (g_verbose >= 2) 
       printSettings();
     
-    TaskScheduler::create(g_numThreads);
+    IdlePolicy::set(g_idle_spin_rounds,g_idle_yield_rounds);
+    if (g_spawn_function) 
+      TaskSchedulerApp::create(g_numThreads,(TaskSchedulerApp::spawnFunction)g_spawn_function,(TaskSchedulerApp::waitFunction)g_wait_function,g_tasking_user_ptr);
+    else
+      TaskScheduler::create(g_numThreads,g_tasking_system,g_thread_affinity);
 
     /* execute regression tests */
     if (g_regression_testing) 
@@ -497,6 +564,21 @@ namespace embree
     g_error_function = func;
   }
 
+  RTCORE_API void rtcSetTaskingSystem(RTCSpawnFunc spawn, RTCWaitFunc wait, void* userPtr) 
+  {
+    Lock<MutexSys> lock(g_mutex);
+    TRACE(rtcSetTaskingSystem);
+    if (g_initialized) {
+      g_mutex.unlock();
+      process_error(RTC_INVALID_OPERATION,"tasking system has to get set before rtcInit");
+      g_mutex.lock();
+      return;
+    }
+    g_spawn_function = spawn;
+    g_wait_function = wait;
+    g_tasking_user_ptr = userPtr;
+  }
+
   RTCORE_API void rtcDebug()
   {
     Lock<MutexSys> lock(g_mutex);
@@ -512,6 +594,25 @@ namespace embree
 #endif
   }
   
+  RTCORE_API void rtcGetTessellationCacheStats(RTCTessellationCacheStats* stats, bool reset)
+  {
+    CATCH_BEGIN;
+    TRACE(rtcGetTessellationCacheStats);
+    if (stats == NULL) {
+      process_error(RTC_INVALID_ARGUMENT,"invalid argument");
+      return;
+    }
+    const SharedTessellationCache::Stats s = sharedTessellationCache.getStats();
+    stats->size      = s.size;
+    stats->accesses  = s.accesses;
+    stats->hits      = s.hits;
+    stats->misses    = s.misses;
+    stats->evictions = s.evictions;
+    stats->clears    = s.clears;
+    if (reset) sharedTessellationCache.resetStats();
+    CATCH_END;
+  }
+  
   RTCORE_API RTCScene rtcNewScene (RTCSceneFlags flags, RTCAlgorithmFlags aflags) 
   {
     CATCH_BEGIN;
@@ -848,6 +949,16 @@ namespace embree
     return -1;
   }
 
+  RTCORE_API unsigned rtcNewPointGeometry (RTCScene scene, RTCGeometryFlags flags, size_t numPoints) 
+  {
+    CATCH_BEGIN;
+    TRACE(rtcNewPointGeometry);
+    VERIFY_HANDLE(scene);
+    return ((Scene*)scene)->newPoints(flags,numPoints);
+    CATCH_END;
+    return -1;
+  }
+
   RTCORE_API void rtcSetMask (RTCScene scene, unsigned geomID, int mask) 
   {
     CATCH_BEGIN;
@@ -858,6 +969,16 @@ namespace embree
     CATCH_END;
   }
 
+  RTCORE_API void rtcSetAlphaMask (RTCScene scene, unsigned geomID, const void* bits, size_t width, size_t height) 
+  {
+    CATCH_BEGIN;
+    TRACE(rtcSetAlphaMask);
+    VERIFY_HANDLE(scene);
+    VERIFY_GEOMID(geomID);
+    ((Scene*)scene)->get_locked(geomID)->setAlphaMask(bits,width,height);
+    CATCH_END;
+  }
+
   RTCORE_API void* rtcMapBuffer(RTCScene scene, unsigned geomID, RTCBufferType type) 
   {
     CATCH_BEGIN;
@@ -959,6 +1080,16 @@ namespace embree
     CATCH_END;
   }
 
+  RTCORE_API void rtcSetBoundsFunctionN (RTCScene scene, unsigned geomID, RTCBoundsFuncN boundsN) 
+  {
+    CATCH_BEGIN;
+    TRACE(rtcSetBoundsFunctionN);
+    VERIFY_HANDLE(scene);
+    VERIFY_GEOMID(geomID);
+    ((Scene*)scene)->get_locked(geomID)->setBoundsFunctionN(boundsN);
+    CATCH_END;
+  }
+
   RTCORE_API void rtcSetDisplacementFunction (RTCScene scene, unsigned geomID, RTCDisplacementFunc func, RTCBounds* bounds)
   {
     CATCH_BEGIN;
@@ -969,6 +1100,57 @@ namespace embree
     CATCH_END;
   }
 
+  RTCORE_API void rtcSetEdgeLevelFunction (RTCScene scene, unsigned geomID, RTCEdgeLevelFunc func)
+  {
+    CATCH_BEGIN;
+    TRACE(rtcSetEdgeLevelFunction);
+    VERIFY_HANDLE(scene);
+    VERIFY_GEOMID(geomID);
+    ((Scene*)scene)->get_locked(geomID)->setEdgeLevelFunction(func);
+    CATCH_END;
+  }
+
+  RTCORE_API void rtcSetEdgeLevelCamera (RTCScene scene, unsigned geomID, const float* pos, float levelFactor)
+  {
+    CATCH_BEGIN;
+    TRACE(rtcSetEdgeLevelCamera);
+    VERIFY_HANDLE(scene);
+    VERIFY_GEOMID(geomID);
+    ((Scene*)scene)->get_locked(geomID)->setEdgeLevelCamera(pos,levelFactor);
+    CATCH_END;
+  }
+
+  RTCORE_API void rtcInterpolate (RTCScene scene, unsigned geomID, unsigned primID, float u, float v, RTCBufferType buffer, 
+                                  float* P, float* dPdu, float* dPdv, size_t numFloats)
+  {
+    CATCH_BEGIN;
+    TRACE(rtcInterpolate);
+    VERIFY_HANDLE(scene);
+    VERIFY_GEOMID(geomID);
+    if (geomID >= ((Scene*)scene)->size() || ((Scene*)scene)->get(geomID) == NULL) {
+      process_error(RTC_INVALID_ARGUMENT,"invalid geometry ID");
+      return;
+    }
+    ((Scene*)scene)->get(geomID)->interpolateN(NULL,&primID,&u,&v,1,buffer,P,dPdu,dPdv,numFloats);
+    CATCH_END;
+  }
+
+  RTCORE_API void rtcInterpolateN (RTCScene scene, unsigned geomID, 
+                                   const void* valid, const unsigned* primIDs, const float* u, const float* v, size_t numUVs, 
+                                   RTCBufferType buffer, float* P, float* dPdu, float* dPdv, size_t numFloats)
+  {
+    CATCH_BEGIN;
+    TRACE(rtcInterpolateN);
+    VERIFY_HANDLE(scene);
+    VERIFY_GEOMID(geomID);
+    if (geomID >= ((Scene*)scene)->size() || ((Scene*)scene)->get(geomID) == NULL) {
+      process_error(RTC_INVALID_ARGUMENT,"invalid geometry ID");
+      return;
+    }
+    ((Scene*)scene)->get(geomID)->interpolateN(valid,primIDs,u,v,numUVs,buffer,P,dPdu,dPdv,numFloats);
+    CATCH_END;
+  }
+
   RTCORE_API void rtcSetIntersectFunction (RTCScene scene, unsigned geomID, RTCIntersectFunc intersect) 
   {
     CATCH_BEGIN;
@@ -979,6 +1161,16 @@ namespace embree
     CATCH_END;
   }
 
+  RTCORE_API void rtcSetIntersectFunctionN (RTCScene scene, unsigned geomID, RTCIntersectFuncN intersectN) 
+  {
+    CATCH_BEGIN;
+    TRACE(rtcSetIntersectFunctionN);
+    VERIFY_HANDLE(scene);
+    VERIFY_GEOMID(geomID);
+    ((Scene*)scene)->get_locked(geomID)->setIntersectFunctionN(intersectN);
+    CATCH_END;
+  }
+
   RTCORE_API void rtcSetIntersectFunction4 (RTCScene scene, unsigned geomID, RTCIntersectFunc4 intersect4) 
   {
     CATCH_BEGIN;
@@ -1019,6 +1211,16 @@ namespace embree
     CATCH_END;
   }
 
+  RTCORE_API void rtcSetOccludedFunctionN (RTCScene scene, unsigned geomID, RTCOccludedFuncN occludedN) 
+  {
+    CATCH_BEGIN;
+    TRACE(rtcSetOccludedFunctionN);
+    VERIFY_HANDLE(scene);
+    VERIFY_GEOMID(geomID);
+    ((Scene*)scene)->get_locked(geomID)->setOccludedFunctionN(occludedN);
+    CATCH_END;
+  }
+
   RTCORE_API void rtcSetOccludedFunction4 (RTCScene scene, unsigned geomID, RTCOccludedFunc4 occluded4) 
   {
     CATCH_BEGIN;
@@ -1059,6 +1261,16 @@ namespace embree
     CATCH_END;
   }
 
+  RTCORE_API void rtcSetIntersectionFilterFunctionN (RTCScene scene, unsigned geomID, RTCFilterFuncN filterN) 
+  {
+    CATCH_BEGIN;
+    TRACE(rtcSetIntersectionFilterFunctionN);
+    VERIFY_HANDLE(scene);
+    VERIFY_GEOMID(geomID);
+    ((Scene*)scene)->get_locked(geomID)->setIntersectionFilterFunctionN(filterN);
+    CATCH_END;
+  }
+
   RTCORE_API void rtcSetIntersectionFilterFunction4 (RTCScene scene, unsigned geomID, RTCFilterFunc4 filter4) 
   {
     CATCH_BEGIN;
@@ -1099,6 +1311,16 @@ namespace embree
     CATCH_END;
   }
 
+  RTCORE_API void rtcSetOcclusionFilterFunctionN (RTCScene scene, unsigned geomID, RTCFilterFuncN filterN) 
+  {
+    CATCH_BEGIN;
+    TRACE(rtcSetOcclusionFilterFunctionN);
+    VERIFY_HANDLE(scene);
+    VERIFY_GEOMID(geomID);
+    ((Scene*)scene)->get_locked(geomID)->setOcclusionFilterFunctionN(filterN);
+    CATCH_END;
+  }
+
   RTCORE_API void rtcSetOcclusionFilterFunction4 (RTCScene scene, unsigned geomID, RTCFilterFunc4 filter4) 
   {
     CATCH_BEGIN;
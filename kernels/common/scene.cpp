@@ -27,13 +27,16 @@
 
 namespace embree
 {
+  /*! counts commits of all scenes */
+  static volatile atomic_t g_commit_counter = 0;
+
   Scene::Scene (RTCSceneFlags sflags, RTCAlgorithmFlags aflags)
     : flags(sflags), aflags(aflags), numMappedBuffers(0), is_build(false), needTriangles(false), needVertices(false),
       numTriangles(0), numTriangles2(0), 
       numBezierCurves(0), numBezierCurves2(0), 
       numSubdivPatches(0), numSubdivPatches2(0), 
-      numUserGeometries1(0), 
-      numIntersectionFilters4(0), numIntersectionFilters8(0), numIntersectionFilters16(0),
+      numUserGeometries1(0), numPoints(0),
+      numIntersectionFilters4(0), numIntersectionFilters8(0), numIntersectionFilters16(0), numAlphaMasks(0),
       commitCounter(0)
   {
 #if !defined(__MIC__)
@@ -113,6 +116,8 @@ namespace embree
     createHairAccel();
     accels.add(BVH4::BVH4OBBBezier1iMB(this,false));
     createSubdivAccel();
+    accels.add(BVH4::BVH4SubdivGridEagerMB(this));
+    createPointAccel();
 
 #endif
   }
@@ -225,6 +230,23 @@ namespace embree
     else THROW_RUNTIME_ERROR("unknown subdiv accel "+g_subdiv_accel);
   }
 
+  void Scene::createPointAccel()
+  {
+    if (g_point_accel == "default") 
+    {
+#if defined (__TARGET_AVX__)
+      if (has_feature(AVX)) accels.add(BVH4::BVH4Sphere8(this));
+      else
+#endif
+        accels.add(BVH4::BVH4Sphere4(this));
+    }
+    else if (g_point_accel == "bvh4.sphere4") accels.add(BVH4::BVH4Sphere4(this));
+#if defined (__TARGET_AVX__)
+    else if (g_point_accel == "bvh4.sphere8") accels.add(BVH4::BVH4Sphere8(this));
+#endif
+    else THROW_RUNTIME_ERROR("unknown point acceleration structure "+g_point_accel);
+  }
+
 #endif
 
   Scene::~Scene () 
@@ -271,6 +293,14 @@ namespace embree
       process_error(RTC_INVALID_OPERATION,"only 1 or 2 time steps supported");
       return -1;
     }
+
+#if defined(__MIC__)
+    /* the Xeon Phi subdivision builder would ignore motion blur meshes */
+    if (numTimeSteps != 1) {
+      process_error(RTC_INVALID_OPERATION,"motion blur subdivision meshes are not supported on Xeon Phi");
+      return -1;
+    }
+#endif
     
     Geometry* geom = new SubdivMesh(this,gflags,numFaces,numEdges,numVertices,numEdgeCreases,numVertexCreases,numHoles,numTimeSteps);
     return geom->id;
@@ -293,6 +323,22 @@ namespace embree
     return geom->id;
   }
 
+  unsigned Scene::newPoints (RTCGeometryFlags gflags, size_t numPoints) 
+  {
+    if (isStatic() && (gflags != RTC_GEOMETRY_STATIC)) {
+      process_error(RTC_INVALID_OPERATION,"static scenes can only contain static geometries");
+      return -1;
+    }
+
+#if defined(__MIC__)
+    process_error(RTC_INVALID_OPERATION,"point geometries are not supported on Xeon Phi");
+    return -1;
+#endif
+    
+    Geometry* geom = new Points(this,gflags,numPoints);
+    return geom->id;
+  }
+
   unsigned Scene::add(Geometry* geometry) 
   {
     Lock<AtomicMutex> lock(geometriesMutex);
@@ -354,8 +400,8 @@ namespace embree
     }
 #endif
 
-    /* select fast code path if no intersection filter is present */
-    accels.select(numIntersectionFilters4,numIntersectionFilters8,numIntersectionFilters16);
+    /* select fast code path if no intersection filter or alpha mask is present */
+    accels.select(numIntersectionFilters4+numAlphaMasks,numIntersectionFilters8+numAlphaMasks,numIntersectionFilters16+numAlphaMasks);
 
     /* if user provided threads use them */
     if (threadCount)
@@ -416,8 +462,9 @@ namespace embree
       intersectors.print(2);
     }
     
-    /* update commit counter */
-    commitCounter++;
+    /* update commit counter, counters are unique over all scenes as
+     * cached tessellations of deleted scenes are found by address */
+    commitCounter = atomic_add(&g_commit_counter,1)+1;
   }
 
   void Scene::write(std::ofstream& file)
@@ -22,6 +22,7 @@
 #include "scene_user_geometry.h"
 #include "scene_bezier_curves.h"
 #include "scene_subdiv_mesh.h"
+#include "scene_points.h"
 
 #include "common/acceln.h"
 #include "geometry.h"
@@ -34,7 +35,9 @@ namespace embree
     ALIGNED_CLASS;
 
   public:
-    template<typename Ty> // FIXME: give motion blur meshes different type to iterate over them here
+    /*! iterates over all enabled geometries of some type, motion blur
+     *  geometries are only returned if mblur is set */
+    template<typename Ty, bool mblur = false>
     class Iterator
     {
     public:
@@ -49,6 +52,7 @@ namespace embree
         if (geom == NULL) return NULL;
         if (!geom->isEnabled()) return NULL;
         if (geom->type != Ty::geom_type) return NULL;
+        if ((((Ty*)geom)->numTimeSteps != 1) != mblur) return NULL;
         return (Ty*) geom;
       }
 
@@ -68,6 +72,7 @@ namespace embree
     void createTriangleAccel();
     void createHairAccel();
     void createSubdivAccel();
+    void createPointAccel();
 
     /*! Scene destruction */
     ~Scene ();
@@ -87,6 +92,9 @@ namespace embree
     /*! Creates a new subdivision mesh. */
     unsigned int newSubdivisionMesh (RTCGeometryFlags flags, size_t numFaces, size_t numEdges, size_t numVertices, size_t numEdgeCreases, size_t numVertexCreases, size_t numHoles, size_t numTimeSteps);
 
+    /*! Creates a new collection of points. */
+    unsigned int newPoints (RTCGeometryFlags flags, size_t numPoints);
+
     /*! Builds acceleration structure for the scene. */
     void build (size_t threadIndex, size_t threadCount);
 
@@ -163,6 +171,12 @@ namespace embree
       assert(geometries[i]->type == BEZIER_CURVES);
       return (BezierCurves*) geometries[i]; 
     }
+    __forceinline Points* getPoints(size_t i) { 
+      assert(i < geometries.size()); 
+      assert(geometries[i]);
+      assert(geometries[i]->type == POINTS);
+      return (Points*) geometries[i]; 
+    }
 
     /* test if this is a static scene */
     __forceinline bool isStatic() const { return embree::isStatic(flags); }
@@ -205,9 +219,11 @@ namespace embree
     atomic_t numSubdivPatches;         //!< number of enabled subdivision patches
     atomic_t numSubdivPatches2;        //!< number of enabled motion blur subdivision patches
     atomic_t numUserGeometries1;       //!< number of enabled user geometries
+    atomic_t numPoints;                //!< number of enabled points
 
     atomic_t numIntersectionFilters4;   //!< number of enabled intersection/occlusion filters for 4-wide ray packets
     atomic_t numIntersectionFilters8;   //!< number of enabled intersection/occlusion filters for 8-wide ray packets
     atomic_t numIntersectionFilters16;  //!< number of enabled intersection/occlusion filters for 16-wide ray packets
+    atomic_t numAlphaMasks;             //!< number of triangle meshes with alpha mask
   };
 }
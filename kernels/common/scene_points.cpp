@@ -0,0 +1,124 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "scene_points.h"
+#include "scene.h"
+
+namespace embree
+{
+  Points::Points (Scene* parent, RTCGeometryFlags flags, size_t numPoints) 
+    : Geometry(parent,POINTS,numPoints,flags), mask(-1), numPoints(numPoints)
+  {
+    vertices.init(numPoints,sizeof(Vertex));
+    enabling();
+  }
+
+  void Points::enabling() { 
+    atomic_add(&parent->numPoints,numPoints); 
+  }
+  
+  void Points::disabling() { 
+    atomic_add(&parent->numPoints,-(ssize_t)numPoints); 
+  }
+  
+  void Points::setMask (unsigned mask) 
+  {
+    if (parent->isStatic() && parent->isBuild()) {
+      process_error(RTC_INVALID_OPERATION,"static geometries cannot get modified");
+      return;
+    }
+    this->mask = mask; 
+  }
+
+  void Points::setBuffer(RTCBufferType type, void* ptr, size_t offset, size_t stride) 
+  { 
+    if (parent->isStatic() && parent->isBuild()) {
+      process_error(RTC_INVALID_OPERATION,"static geometries cannot get modified");
+      return;
+    }
+
+    /* verify that all accesses are 4 bytes aligned */
+    if (((size_t(ptr) + offset) & 0x3) || (stride & 0x3)) {
+      process_error(RTC_INVALID_OPERATION,"data must be 4 bytes aligned");
+      return;
+    }
+
+    switch (type) {
+    case RTC_VERTEX_BUFFER0: 
+      vertices.set(ptr,offset,stride); 
+      break;
+    default: 
+      process_error(RTC_INVALID_ARGUMENT,"unknown buffer type");
+      break;
+    }
+  }
+
+  void* Points::map(RTCBufferType type) 
+  {
+    if (parent->isStatic() && parent->isBuild()) {
+      process_error(RTC_INVALID_OPERATION,"static geometries cannot get modified");
+      return NULL;
+    }
+
+    switch (type) {
+    case RTC_VERTEX_BUFFER0: return vertices.map(parent->numMappedBuffers);
+    default                : process_error(RTC_INVALID_ARGUMENT,"unknown buffer type"); return NULL;
+    }
+  }
+
+  void Points::unmap(RTCBufferType type) 
+  {
+    if (parent->isStatic() && parent->isBuild()) {
+      process_error(RTC_INVALID_OPERATION,"static geometries cannot get modified");
+      return;
+    }
+
+    switch (type) {
+    case RTC_VERTEX_BUFFER0: vertices.unmap(parent->numMappedBuffers); break;
+    default                : process_error(RTC_INVALID_ARGUMENT,"unknown buffer type"); break;
+    }
+  }
+
+  void Points::setUserData (void* ptr, bool ispc) {
+    userPtr = ptr;
+  }
+
+  void Points::immutable () 
+  {
+    /* the sphere leaves store a copy of all points */
+    vertices.free();
+  }
+
+  bool Points::verify () 
+  {
+    for (size_t i=0; i<numPoints; i++) {
+      if (!inFloatRange(vertices[i].x)) return false;
+      if (!inFloatRange(vertices[i].y)) return false;
+      if (!inFloatRange(vertices[i].z)) return false;
+      if (!inFloatRange(vertices[i].r)) return false;
+    }
+    return true;
+  }
+
+  void Points::write(std::ofstream& file)
+  {
+    int type = POINTS;
+    file.write((char*)&type,sizeof(int));
+    file.write((char*)&numPoints,sizeof(int));
+    while ((file.tellp() % 16) != 0) { char c = 0; file.write(&c,1); }
+    for (size_t i=0; i<numPoints; i++) file.write((char*)&vertex(i),sizeof(Vec3fa));  
+  }
+}
@@ -0,0 +1,89 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "common/default.h"
+#include "common/geometry.h"
+#include "common/primref.h"
+#include "common/buffer.h"
+
+namespace embree
+{
+    struct Points : public Geometry
+    {
+      struct Vertex {
+        float x,y,z,r;
+      };
+
+      static const GeometryTy geom_type = POINTS;
+
+    public:
+      Points (Scene* parent, RTCGeometryFlags flags, size_t numPoints); 
+    
+      void write(std::ofstream& file);
+
+    public:
+      void enabling();
+      void disabling();
+      void setMask (unsigned mask);
+      void setBuffer(RTCBufferType type, void* ptr, size_t offset, size_t stride);
+      void* map(RTCBufferType type);
+      void unmap(RTCBufferType type);
+      void setUserData (void* ptr, bool ispc);
+      void immutable ();
+      bool verify ();
+
+    public:
+
+      /*! returns number of points */
+      __forceinline size_t size() const {
+	return numPoints;
+      }
+
+      /*! returns center of i'th point */
+      __forceinline const Vec3fa& vertex(size_t i) const {
+        assert(i < numPoints);
+        return (Vec3fa&)vertices[i];
+      }
+
+      /*! returns radius of i'th point */
+      __forceinline float radius(size_t i) const {
+        assert(i < numPoints);
+        return vertices[i].r;
+      }
+
+      /*! check if the i'th primitive is valid */
+      __forceinline bool valid(size_t i, BBox3fa* bbox = NULL) const 
+      {
+        const float r = radius(i);
+        if (!inFloatRange(r) || r < 0.0f) return false;
+        if (!inFloatRange(vertex(i))) return false;
+	if (bbox) *bbox = bounds(i);
+	return true;
+      }
+
+      /*! calculates bounding box of i'th point */
+      __forceinline BBox3fa bounds(size_t i) const {
+        return enlarge(BBox3fa(vertex(i)),Vec3fa(radius(i)));
+      }
+
+    public:
+      unsigned int mask;                //!< for masking out geometry
+      BufferT<Vertex> vertices;         //!< vertex array
+      size_t numPoints;                 //!< number of points
+    };
+}
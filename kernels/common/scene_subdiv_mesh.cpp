@@ -16,8 +16,10 @@
 
 #include "scene_subdiv_mesh.h"
 #include "scene.h"
+#include "subdiv/feature_adaptive_eval.h"
+#include "subdiv/feature_adaptive_gregory.h"
+#include "subdiv/gregory_patch.h"
 
-#include "algorithms/sort.h"
 #include "algorithms/prefix.h"
 #include "algorithms/parallel_for.h"
 
@@ -34,7 +36,11 @@ namespace embree
       numVertices(numVertices),
       displFunc(NULL), 
       displBounds(empty),
-      levelUpdate(false)
+      levelFunc(NULL),
+      levelCamera(zero),
+      levelFactor(0.0f),
+      levelUpdate(false), vertexUpdate(false),
+      regularPatchPointsModified(false)
   {
     for (size_t i=0; i<numTimeSteps; i++)
        vertices[i].init(numVertices,sizeof(Vec3fa));
@@ -47,6 +53,8 @@ namespace embree
     vertex_creases.init(numVertexCreases,sizeof(unsigned int));
     vertex_crease_weights.init(numVertexCreases,sizeof(float));
     levels.init(numEdges,sizeof(float));
+    userbuffers[0].init(numVertices,sizeof(Vec3fa));
+    userbuffers[1].init(numVertices,sizeof(Vec3fa));
     enabling();
   }
 
@@ -106,6 +114,8 @@ namespace embree
     case RTC_VERTEX_CREASE_INDEX_BUFFER : vertex_creases.set(ptr,offset,stride); break;
     case RTC_VERTEX_CREASE_WEIGHT_BUFFER: vertex_crease_weights.set(ptr,offset,stride); break;
     case RTC_LEVEL_BUFFER               : levels.set(ptr,offset,stride); break;
+    case RTC_USER_VERTEX_BUFFER0        : userbuffers[0].set(ptr,offset,stride); break;
+    case RTC_USER_VERTEX_BUFFER1        : userbuffers[1].set(ptr,offset,stride); break;
 
     case RTC_VERTEX_BUFFER0: 
       vertices[0].set(ptr,offset,stride); 
@@ -147,6 +157,8 @@ namespace embree
     case RTC_VERTEX_CREASE_INDEX_BUFFER  : return vertex_creases.map(parent->numMappedBuffers); 
     case RTC_VERTEX_CREASE_WEIGHT_BUFFER : return vertex_crease_weights.map(parent->numMappedBuffers); 
     case RTC_LEVEL_BUFFER                : return levels.map(parent->numMappedBuffers); 
+    case RTC_USER_VERTEX_BUFFER0         : return userbuffers[0].map(parent->numMappedBuffers); 
+    case RTC_USER_VERTEX_BUFFER1         : return userbuffers[1].map(parent->numMappedBuffers); 
     default                              : process_error(RTC_INVALID_ARGUMENT,"unknown buffer type"); return NULL;
     }
   }
@@ -169,6 +181,8 @@ namespace embree
     case RTC_VERTEX_CREASE_INDEX_BUFFER : vertex_creases.unmap(parent->numMappedBuffers); break;
     case RTC_VERTEX_CREASE_WEIGHT_BUFFER: vertex_crease_weights.unmap(parent->numMappedBuffers); break;
     case RTC_LEVEL_BUFFER               : levels.unmap(parent->numMappedBuffers); break;
+    case RTC_USER_VERTEX_BUFFER0        : userbuffers[0].unmap(parent->numMappedBuffers); break;
+    case RTC_USER_VERTEX_BUFFER1        : userbuffers[1].unmap(parent->numMappedBuffers); break;
     default                             : process_error(RTC_INVALID_ARGUMENT,"unknown buffer type"); break;
     }
   }
@@ -201,6 +215,8 @@ namespace embree
     case RTC_VERTEX_CREASE_INDEX_BUFFER : vertex_creases.setModified(true); break;
     case RTC_VERTEX_CREASE_WEIGHT_BUFFER: vertex_crease_weights.setModified(true); break;
     case RTC_LEVEL_BUFFER               : levels.setModified(true); break;
+    case RTC_USER_VERTEX_BUFFER0        : userbuffers[0].setModified(true); break;
+    case RTC_USER_VERTEX_BUFFER1        : userbuffers[1].setModified(true); break;
     default                             : process_error(RTC_INVALID_ARGUMENT,"unknown buffer type"); break;
     }
     Geometry::update();
@@ -219,6 +235,39 @@ namespace embree
     this->displFunc   = func;
     if (bounds) this->displBounds = *(BBox3fa*)bounds; 
     else        this->displBounds = empty;
+    faceDisplBounds.clear();
+  }
+
+  void SubdivMesh::setEdgeLevelFunction (RTCEdgeLevelFunc func) 
+  {
+    if (parent->isStatic() && parent->isBuild()) {
+      process_error(RTC_INVALID_OPERATION,"static geometries cannot get modified");
+      return;
+    }
+    this->levelFunc = func;
+    levels.setModified(true);
+    if (!parent->isStatic()) Geometry::update();
+  }
+
+  void SubdivMesh::setEdgeLevelCamera (const float* pos, float levelFactor) 
+  {
+    if (parent->isStatic() && parent->isBuild()) {
+      process_error(RTC_INVALID_OPERATION,"static geometries cannot get modified");
+      return;
+    }
+    if (pos && levelFactor <= 0.0f) {
+      process_error(RTC_INVALID_ARGUMENT,"level factor has to be positive");
+      return;
+    }
+    if (pos) {
+      this->levelCamera = Vec3fa(pos[0],pos[1],pos[2]);
+      this->levelFactor = levelFactor;
+    } else {
+      this->levelCamera = Vec3fa(zero);
+      this->levelFactor = 0.0f;
+    }
+    levels.setModified(true);
+    if (!parent->isStatic()) Geometry::update();
   }
 
   void SubdivMesh::immutable () 
@@ -235,11 +284,11 @@ namespace embree
 
   void SubdivMesh::calculateHalfEdges()
   {
-    /* allocate temporary array */
-    halfEdges0.resize(numEdges);
-    halfEdges1.resize(numEdges);
+    /* the hash table gets at least one and a half slots per half edge, as
+     * each of the up to numHalfEdges edges occupies one slot */
+    edgeTable.init(numHalfEdges+numHalfEdges/2);
 
-    /* create all half edges */
+    /* create all half edges and insert them into the hash table */
 #if defined(__MIC__)
     parallel_for( size_t(0), numFaces, [&](const range<size_t>& r)
 #else
@@ -257,6 +306,7 @@ namespace embree
 
 	const size_t N = faceVertices[f];
 	const size_t e = faceStartEdge[f];
+        const bool hole = holeSet.lookup(f);
 	
 	for (size_t de=0; de<N; de++)
 	{
@@ -264,7 +314,6 @@ namespace embree
 
 #if defined(__MIC__)
 	  prefetch<PFHINT_L1>(edge + 2);
-	  prefetch<PFHINT_L1EX>(&halfEdges1[e+de+2]);
 #endif
 
 	  const unsigned int startVertex = vertexIndices[e+de];
@@ -286,61 +335,62 @@ namespace embree
 	  edge->vertex_crease_weight   = vertexCreaseMap.lookup(startVertex,0.0f);
 	  edge->edge_level             = edge_level;
 
-	  if (unlikely(holeSet.lookup(f))) 
-	    halfEdges1[e+de] = KeyHalfEdge(-1,edge);
-	  else
-	    halfEdges1[e+de] = KeyHalfEdge(key,edge);
+          /* edges of holes have no opposite edges */
+	  if (unlikely(hole)) continue;
+          EdgeSlot* slot = edgeTable.insert(key);
+          assert(slot);
+          slot->add(int(e+de));
 	}
       }
     });
 
-    /* sort half edges to find adjacent edges */
-    radix_sort_u64(halfEdges1.data(),halfEdges0.data(),numHalfEdges);
-
     /* link all adjacent pairs of edges */
 #if defined(__MIC__)
-    parallel_for( size_t(0), numHalfEdges, [&](const range<size_t>& r) 
+    parallel_for( size_t(0), numFaces, [&](const range<size_t>& r) 
 #else
-    parallel_for( size_t(0), numHalfEdges, size_t(4096), [&](const range<size_t>& r) 
+    parallel_for( size_t(0), numFaces, size_t(4096), [&](const range<size_t>& r) 
 #endif
     {
-      size_t e=r.begin();
-      if (e && (halfEdges1[e].key == halfEdges1[e-1].key)) {
-	const uint64 key = halfEdges1[e].key;
-	while (e<r.end() && halfEdges1[e].key == key) e++;
-      }
-
-      while (e<r.end())
+      for (size_t f=r.begin(); f<r.end(); f++) 
       {
-	const uint64 key = halfEdges1[e].key;
-	if (key == -1) break;
-	int N=1; while (e+N<numHalfEdges && halfEdges1[e+N].key == key) N++;
-	if (N == 1) {
-	}
-	else if (N == 2) {
-	  halfEdges1[e+0].edge->setOpposite(halfEdges1[e+1].edge);
-	  halfEdges1[e+1].edge->setOpposite(halfEdges1[e+0].edge);
-	} else {
-	  for (size_t i=0; i<N; i++) {
-	    halfEdges1[e+i].edge->vertex_crease_weight = inf;
-	    halfEdges1[e+i].edge->next()->vertex_crease_weight = inf;
+	if (unlikely(holeSet.lookup(f))) continue;
+
+	const size_t N = faceVertices[f];
+	const size_t e = faceStartEdge[f];
+	for (size_t de=0; de<N; de++)
+	{
+	  HalfEdge* edge = &halfEdges[e+de];
+	  const uint64 key = Edge(edge->vtx_index,edge->next()->vtx_index);
+	  const EdgeSlot* slot = edgeTable.lookup(key);
+	  assert(slot);
+
+          /* border edge */
+	  if (slot->edge1 == EdgeSlot::NONE) 
+	    continue;
+
+          /* non-manifold edge */
+	  if (slot->edge1 == EdgeSlot::MULTIPLE) {
+	    edge->vertex_crease_weight = inf;
+	    edge->next()->vertex_crease_weight = inf;
+	    continue;
 	  }
+
+	  const int opposite = slot->edge0 == int(e+de) ? slot->edge1 : slot->edge0;
+	  edge->setOpposite(&halfEdges[opposite]);
 	}
-	e+=N;
       }
     });
   }
 
   void SubdivMesh::updateHalfEdges()
   {
-    /* assume we do no longer recalculate in the future and clear these arrays */
-    halfEdges0.clear();
-    halfEdges1.clear();
+    /* assume we do no longer recalculate in the future and clear the hash table */
+    edgeTable.clear();
 
     /* calculate which data to update */
     const bool updateEdgeCreases = edge_creases.isModified() || edge_crease_weights.isModified();
     const bool updateVertexCreases = vertex_creases.isModified() || vertex_crease_weights.isModified(); 
-    const bool updateLevels = levels.isModified();
+    const bool updateLevels = levels.isModified() && !hasAutoEdgeLevels();
 
     /* parallel loop over all half edges */
     parallel_for( size_t(0), numHalfEdges, size_t(4096), [&](const range<size_t>& r) 
@@ -368,6 +418,201 @@ namespace embree
     });
   }
 
+  void SubdivMesh::calculateEdgeLevels()
+  {
+    static const size_t BLOCK_SIZE = 256;
+    const BufferT<Vec3fa>& verts = vertices[0];
+
+    /* the edge level function gets called for blocks of edges */
+    parallel_for( size_t(0), numHalfEdges, BLOCK_SIZE, [&](const range<size_t>& r) 
+    {
+      for (size_t b=r.begin(); b<r.end(); b+=BLOCK_SIZE)
+      {
+        const size_t N = min(BLOCK_SIZE,r.end()-b);
+        __aligned(64) float x0[BLOCK_SIZE], y0[BLOCK_SIZE], z0[BLOCK_SIZE];
+        __aligned(64) float x1[BLOCK_SIZE], y1[BLOCK_SIZE], z1[BLOCK_SIZE];
+        __aligned(64) float l[BLOCK_SIZE];
+
+        /* gather start and end vertex of each edge */
+        for (size_t i=0; i<N; i++) 
+        {
+          const HalfEdge& edge = halfEdges[b+i];
+          const Vec3fa v0 = verts[edge.vtx_index];
+          const Vec3fa v1 = verts[edge.next()->vtx_index];
+          x0[i] = v0.x; y0[i] = v0.y; z0[i] = v0.z;
+          x1[i] = v1.x; y1[i] = v1.y; z1[i] = v1.z;
+          l[i] = 1.0f;
+        }
+
+        /* let the application calculate the levels */
+        if (levelFunc) 
+          levelFunc(userPtr,id,b,x0,y0,z0,x1,y1,z1,l,N);
+
+        /* otherwise use the distance to the camera */
+        else {
+          for (size_t i=0; i<N; i++) {
+            const Vec3fa v0(x0[i],y0[i],z0[i]), v1(x1[i],y1[i],z1[i]);
+            const float d = length(levelCamera-0.5f*(v0+v1));
+            l[i] = levelFactor*length(v1-v0)*rcp(max(d,float(ulp)));
+          }
+        }
+
+        for (size_t i=0; i<N; i++)
+          halfEdges[b+i].edge_level = clamp(l[i],1.0f,4096.0f);
+      }
+    });
+  }
+
+  /*! gathers the vertex indices of the 1-ring of an inner vertex of valence 4 with only quads */
+  static __forceinline void getRegularRingIndices(const SubdivMesh::HalfEdge* const h, uint32 ring[8])
+  {
+    const SubdivMesh::HalfEdge* p = h;
+    for (size_t i=0; i<8; i+=2) {
+      ring[i+0] = p->next()->getStartVertexIndex();
+      ring[i+1] = p->next()->next()->getStartVertexIndex();
+      p = p->prev()->opposite();
+    }
+    assert(p == h);
+  }
+
+  void SubdivMesh::calculateRegularPatches()
+  {
+    const BufferT<Vec3fa>& verts = vertices[0];
+    faceRegularPatch.resize(numFaces);
+
+    /* a face gets tessellated as a single B-spline patch exactly when the
+     * builders would do so, border patches are excluded as their control
+     * points are not plain vertices */
+    parallel_for( size_t(0), numFaces, size_t(1024), [&](const range<size_t>& r) 
+    {
+      for (size_t f=r.begin(); f<r.end(); f++) 
+      {
+        faceRegularPatch[f] = 0;
+        const HalfEdge* h = getHalfEdge(f);
+        if (!h->isRegularFace()) continue;
+
+        const GeneralCatmullClarkPatch gpatch(h,verts);
+        if (!gpatch.isQuadPatch()) continue;
+        CatmullClarkPatch patch; gpatch.init(patch);
+        if (!patch.isGregoryOrFinal(0) || !patch.isRegularOrFinal(0)) continue;
+        faceRegularPatch[f] = 1;
+      }
+    });
+
+    size_t numRegularPatches = 0;
+    for (size_t f=0; f<numFaces; f++)
+      faceRegularPatch[f] = faceRegularPatch[f] ? numRegularPatches++ : uint32(-1);
+
+    /* store control point indices in the order of BSplinePatch::init */
+    regularPatchIndices.resize(16*numRegularPatches);
+    regularPatchPoints.resize(16*numRegularPatches);
+    parallel_for( size_t(0), numFaces, size_t(1024), [&](const range<size_t>& r) 
+    {
+      for (size_t f=r.begin(); f<r.end(); f++) 
+      {
+        if (faceRegularPatch[f] == uint32(-1)) continue;
+        const HalfEdge* h = getHalfEdge(f);
+        uint32 ring[4][8];
+        for (size_t i=0; i<4; i++, h=h->next()) 
+          getRegularRingIndices(h,ring[i]);
+
+        uint32* const cv = &regularPatchIndices[16*faceRegularPatch[f]];
+        cv[ 5] = getHalfEdge(f)->getStartVertexIndex(); cv[ 1] = ring[0][6]; cv[ 0] = ring[0][5]; cv[ 4] = ring[0][4];
+        cv[ 6] = ring[0][0];                            cv[ 7] = ring[1][6]; cv[ 3] = ring[1][5]; cv[ 2] = ring[1][4];
+        cv[10] = ring[0][1];                            cv[14] = ring[2][6]; cv[15] = ring[2][5]; cv[11] = ring[2][4];
+        cv[ 9] = ring[0][2];                            cv[ 8] = ring[3][6]; cv[12] = ring[3][5]; cv[13] = ring[3][4];
+      }
+    });
+  }
+
+  void SubdivMesh::updateRegularPatches()
+  {
+    /* displaced faces do not use the control points and static scenes
+     * get built only once, thus the control points would never get reused */
+    if (displFunc || parent->isStatic()) {
+      clearRegularPatches();
+      return;
+    }
+
+    if (faceRegularPatch.size() != numFaces) {
+      calculateRegularPatches();
+      regularPatchPointsModified = true;
+    }
+    if (!regularPatchPointsModified) 
+      return;
+
+    const BufferT<Vec3fa>& verts = vertices[0];
+    parallel_for( size_t(0), regularPatchIndices.size(), size_t(4096), [&](const range<size_t>& r) 
+    {
+      for (size_t i=r.begin(); i<r.end(); i++) 
+        regularPatchPoints[i] = verts[regularPatchIndices[i]];
+    });
+    regularPatchPointsModified = false;
+  }
+
+  void SubdivMesh::clearRegularPatches()
+  {
+    std::vector<uint32>().swap(faceRegularPatch);
+    std::vector<uint32>().swap(regularPatchIndices);
+    std::vector<Vec3fa>().swap(regularPatchPoints);
+  }
+
+  void SubdivMesh::estimateDisplacementBounds()
+  {
+    /* number of samples per edge of each sub-patch */
+    static const size_t N = 5;
+
+    const BufferT<Vec3fa>& verts = vertices[0];
+    faceDisplBounds.resize(numFaces);
+
+    parallel_for( size_t(0), numFaces, size_t(256), [&](const range<size_t>& r) 
+    {
+      for (size_t f=r.begin(); f<r.end(); f++) 
+      {
+        BBox3fa bounds = empty;
+        if (valid(f)) 
+        {
+          feature_adaptive_subdivision_eval(getHalfEdge(f),verts,
+                                            [&](const CatmullClarkPatch& patch, const Vec2f uv[4], const int subdiv[4], const int id)
+          {
+            /* evaluate coarse grid over sub-patch */
+            Vec3fa P[N*N], Ng[N*N];
+            feature_adaptive_eval(patch,0,N-1,0,N-1,N,N,P,Ng,N,N);
+
+            __aligned(64) float qu[N*N], qv[N*N];
+            __aligned(64) float nx[N*N], ny[N*N], nz[N*N];
+            __aligned(64) float px[N*N], py[N*N], pz[N*N];
+            for (size_t y=0; y<N; y++) {
+              for (size_t x=0; x<N; x++) {
+                const size_t i = y*N+x;
+                const float fx = float(x)/float(N-1);
+                const float fy = float(y)/float(N-1);
+                const Vec2f uv01 = (1.0f-fx) * uv[0] + fx * uv[1];
+                const Vec2f uv32 = (1.0f-fx) * uv[3] + fx * uv[2];
+                const Vec2f uvxy = (1.0f-fy) * uv01  + fy * uv32;
+                qu[i] = uvxy.x; qv[i] = uvxy.y;
+                nx[i] = Ng[i].x; ny[i] = Ng[i].y; nz[i] = Ng[i].z;
+                px[i] = P[i].x;  py[i] = P[i].y;  pz[i] = P[i].z;
+              }
+            }
+
+            /* bound displacement vectors */
+            displFunc(userPtr,this->id,f,qu,qv,nx,ny,nz,px,py,pz,N*N);
+            for (size_t i=0; i<N*N; i++)
+              bounds.extend(Vec3fa(px[i],py[i],pz[i])-P[i]);
+          });
+
+          /* enlarge by a safety margin for features missed by the
+           * sampling, user specified bounds are always conservative */
+          const Vec3fa margin = 0.25f*bounds.size();
+          bounds = BBox3fa(bounds.lower-margin,bounds.upper+margin);
+          if (!displBounds.empty()) bounds = intersect(bounds,displBounds);
+        }
+        faceDisplBounds[f] = bounds;
+      }
+    });
+  }
+
   void SubdivMesh::initializeHalfEdgeStructures ()
   {
     double t0 = getSeconds();
@@ -380,6 +625,10 @@ namespace embree
     if (faceVertices.isModified()) 
       numHalfEdges = parallel_prefix_sum(faceVertices,faceStartEdge,numFaces);
 
+    /* view dependent edge levels have to get recalculated when vertices change */
+    if (hasAutoEdgeLevels() && vertices[0].isModified())
+      levels.setModified(true);
+
     /* create set with all holes */
     if (holes.isModified())
       holeSet.init(holes);
@@ -408,21 +657,43 @@ namespace embree
 
     /* check whether we can simply update the bvh in cached mode */
     levelUpdate = false;
-    if (!(recalculate || edge_creases.size() != 0 || vertex_creases.size() !=0) && levels.isModified())
+    if (!(recalculate || edge_creases.size() != 0 || vertex_creases.size() !=0) && levels.isModified() && !vertices[0].isModified())
       levelUpdate = true;
 
+    /* patches stay the same if only vertices and edge levels changed, thus the bvh can get refitted for deformable meshes */
+    vertexUpdate = !(recalculate || edge_creases.isModified() || edge_crease_weights.isModified() || 
+                     vertex_creases.isModified() || vertex_crease_weights.isModified());
+    vertexUpdate &= flags == RTC_GEOMETRY_DEFORMABLE || !vertices[0].isModified();
+
     /* now either recalculate or update the half edges */
     if (recalculate) calculateHalfEdges();
     else if (update) updateHalfEdges();
 
+    /* calculate edge levels if requested by the application */
+    if (hasAutoEdgeLevels() && (recalculate || levels.isModified()))
+      calculateEdgeLevels();
+
+    /* regular patches depend on topology and creases, their control points only on the vertices,
+     * the cached subdivision builder recalculates them on demand */
+    const bool creases = edge_creases.isModified() || edge_crease_weights.isModified() || vertex_creases.isModified() || vertex_crease_weights.isModified();
+    if (recalculate || creases) clearRegularPatches();
+    if (vertices[0].isModified()) regularPatchPointsModified = true;
+
+    /* estimate displacement bounds if requested */
+    if (displFunc && g_subdiv_displacement_bounds == "estimate") {
+      if (recalculate || creases || vertices[0].isModified() || !hasEstimatedDisplacementBounds()) 
+        estimateDisplacementBounds();
+    }
+    else faceDisplBounds.clear();
+
     /* cleanup some state for static scenes */
     if (parent->isStatic()) 
     {
       holeSet.cleanup();
-      halfEdges0.clear();
-      halfEdges1.clear();
+      edgeTable.clear();
       vertexCreaseMap.clear();
       edgeCreaseMap.clear();
+      clearRegularPatches();
     }
 
     /* clear modified state of all buffers */
@@ -459,6 +730,150 @@ namespace embree
 
   }
 
+  /*! patch of some face used for interpolation, converted as in SubdivPatch1Base */
+  struct InterpolationPatch
+  {
+    BSplinePatch patch;    //!< B-spline control points or dense Gregory control points
+    Vec2f uv[4];           //!< u/v coordinates of patch corners as reported by hits
+    bool regular;          //!< true for B-spline patches
+  };
+
+  /*! calculates the local patch coordinates of some u/v location and the
+   *  derivatives of u/v with respect to them, returns the distance of
+   *  the location to the patch domain */
+  static float invertPatchUV(const Vec2f c[4], const Vec2f& p, Vec2f& st, Vec2f& dds, Vec2f& ddt)
+  {
+    /* newton iterations, the residual rejects solutions that did not converge */
+    st = Vec2f(0.5f);
+    Vec2f f(zero);
+    for (size_t i=0; i<16; i++) 
+    {
+      const float s = st.x, t = st.y;
+      f = (1.0f-s)*(1.0f-t)*c[0] + s*(1.0f-t)*c[1] + s*t*c[2] + (1.0f-s)*t*c[3] - p;
+      if (max(abs(f.x),abs(f.y)) < 1E-6f) break;
+      dds = (1.0f-t)*(c[1]-c[0]) + t*(c[2]-c[3]);
+      ddt = (1.0f-s)*(c[3]-c[0]) + s*(c[2]-c[1]);
+      const float det = dds.x*ddt.y - dds.y*ddt.x;
+      if (det == 0.0f) break;
+      st = st - Vec2f(ddt.y*f.x - ddt.x*f.y, dds.x*f.y - dds.y*f.x) * rcp(det);
+    }
+    const float residual = max(abs(f.x),abs(f.y));
+    const float outside = max(max(-st.x,st.x-1.0f),max(-st.y,st.y-1.0f));
+    const float dist = residual < 1E-4f ? outside : max(outside,residual);
+    st = Vec2f(clamp(st.x,0.0f,1.0f),clamp(st.y,0.0f,1.0f));
+    dds = (1.0f-st.y)*(c[1]-c[0]) + st.y*(c[2]-c[3]);
+    ddt = (1.0f-st.x)*(c[3]-c[0]) + st.x*(c[2]-c[1]);
+    return dist;
+  }
+
+  void SubdivMesh::interpolateN(const void* valid_i, const unsigned* primIDs, const float* u, const float* v, size_t numUVs, 
+                                RTCBufferType buffer, float* P, float* dPdu, float* dPdv, size_t numFloats)
+  {
+#if defined(__MIC__)
+    process_error(RTC_INVALID_OPERATION,"rtcInterpolate not supported on Xeon Phi");
+#else
+    const BufferT<Vec3fa>* src = NULL;
+    switch (buffer) {
+    case RTC_VERTEX_BUFFER0      : src = &vertices[0]; break;
+    case RTC_VERTEX_BUFFER1      : src = &vertices[1]; break;
+    case RTC_USER_VERTEX_BUFFER0 : src = &userbuffers[0]; break;
+    case RTC_USER_VERTEX_BUFFER1 : src = &userbuffers[1]; break;
+    default                      : process_error(RTC_INVALID_ARGUMENT,"unknown buffer type"); return;
+    }
+    if (src->getPtr() == NULL) {
+      process_error(RTC_INVALID_OPERATION,"buffer is not set");
+      return;
+    }
+    if (faceStartEdge.size() != numFaces) {
+      process_error(RTC_INVALID_OPERATION,"geometry has to get committed before interpolation");
+      return;
+    }
+
+    const int* valid = (const int*) valid_i;
+    vector_t<InterpolationPatch> patches;
+
+    /* interpolate 3 floats at a time, as the patch construction
+     * works on Vec3fa and the 4th component is used internally */
+    for (size_t c=0; c<numFloats; c+=3)
+    {
+      BufferT<Vec3fa> chunk; 
+      chunk.init(numVertices,src->getBufferStride());
+      chunk.set(src->getPtr(),c*sizeof(float),src->getBufferStride());
+      const size_t M = min(size_t(3),numFloats-c);
+
+      unsigned lastPrimID = -1;
+      for (size_t i=0; i<numUVs; i++)
+      {
+        if (valid && valid[i] != -1) continue;
+
+        const unsigned primID = primIDs[i];
+        if (primID >= numFaces) {
+          process_error(RTC_INVALID_ARGUMENT,"invalid primitive ID");
+          return;
+        }
+
+        /* convert face into patches, reusing them for consecutive locations of the same face, 
+         * creased faces get subdivided the same way as by the cached tessellation */
+        if (primID != lastPrimID)
+        {
+          patches.resize(0);
+          feature_adaptive_subdivision_gregory(primID,getHalfEdge(primID),chunk,
+                                               [&](const CatmullClarkPatch& ipatch, const Vec2f uv[4], const int subdiv[4])
+          {
+            patches.resize(patches.size()+1);
+            InterpolationPatch& patch = patches.back();
+            for (size_t j=0; j<4; j++) patch.uv[j] = Vec2f(uv[j].y,uv[j].x);
+            patch.regular = ipatch.isRegularOrFinal(0);
+            if (patch.regular) patch.patch.init(ipatch);
+            else {
+              GregoryPatch gpatch; gpatch.init(ipatch); 
+              gpatch.exportDenseConrolPoints(patch.patch.v);
+            }
+          });
+          lastPrimID = primID;
+        }
+
+        /* find patch that contains the location */
+        size_t best = 0;
+        float bestDist = inf;
+        Vec2f st(zero), dds(zero), ddt(zero);
+        for (size_t j=0; j<patches.size(); j++) 
+        {
+          Vec2f st_j, dds_j, ddt_j;
+          const float dist = invertPatchUV(patches[j].uv,Vec2f(u[i],v[i]),st_j,dds_j,ddt_j);
+          if (dist >= bestDist) continue;
+          best = j; bestDist = dist; st = st_j; dds = dds_j; ddt = ddt_j;
+          if (dist <= 0.0f) break;
+        }
+
+        /* evaluate patch and its derivatives */
+        const InterpolationPatch& patch = patches[best];
+        Vec3fa p, dps, dpt;
+        if (patch.regular) {
+          p   = patch.patch.eval(st.x,st.y);
+          dps = patch.patch.tangentU(st.x,st.y)*(1.0f/12.0f);
+          dpt = patch.patch.tangentV(st.x,st.y)*(1.0f/12.0f);
+        } else {
+          p   = GregoryPatch::eval    (patch.patch.v,st.x,st.y);
+          dps = GregoryPatch::tangentU(patch.patch.v,st.x,st.y);
+          dpt = GregoryPatch::tangentV(patch.patch.v,st.x,st.y);
+        }
+
+        /* transform derivatives from patch to face u/v coordinates */
+        const float rcpDet = rcp(dds.x*ddt.y - dds.y*ddt.x);
+        const Vec3fa dpu = (dps*ddt.y - dpt*dds.y)*rcpDet;
+        const Vec3fa dpv = (dpt*dds.x - dps*ddt.x)*rcpDet;
+
+        for (size_t k=0; k<M; k++) {
+          if (P   ) P   [(c+k)*numUVs+i] = p[k];
+          if (dPdu) dPdu[(c+k)*numUVs+i] = dpu[k];
+          if (dPdv) dPdv[(c+k)*numUVs+i] = dpv[k];
+        }
+      }
+    }
+#endif
+  }
+
   bool SubdivMesh::verify () 
   {
     float range = sqrtf(0.5f*FLT_MAX);
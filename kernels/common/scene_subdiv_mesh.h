@@ -303,24 +303,27 @@ namespace embree
       float align;                    //!< aligns the structure to 32 bytes
     };
 
-    struct KeyHalfEdge 
+    /*! slot of the hash table that links the two half edges of an edge */
+    struct EdgeSlot
     {
-      KeyHalfEdge() {}
-      
-      KeyHalfEdge (uint64 key, HalfEdge* edge) 
-      : key(key), edge(edge) {}
-      
-      __forceinline operator uint64() const { 
-	return key; 
-      }
+      static const int NONE = -1;      //!< no half edge added
+      static const int MULTIPLE = -2;  //!< more than two half edges added, thus the edge is non-manifold
+
+      __forceinline EdgeSlot () 
+        : key(phash<uint64,EdgeSlot>::EMPTY), edge0(NONE), edge1(NONE) {}
 
-      friend __forceinline bool operator<(const KeyHalfEdge& e0, const KeyHalfEdge& e1) {
-        return e0.key < e1.key;
+      /*! adds a half edge to the edge (thread safe) */
+      __forceinline void add(const int edge) 
+      {
+        if (atomic_cmpxchg(&edge0,NONE,edge) == NONE) return;
+        if (atomic_cmpxchg(&edge1,NONE,edge) == NONE) return;
+        edge1 = MULTIPLE;
       }
-      
+
     public:
       uint64 key;
-      HalfEdge* edge;
+      volatile int32 edge0;  //!< index of the first half edge of the edge
+      volatile int32 edge1;  //!< index of the second half edge of the edge
     };
 
   public:
@@ -340,6 +343,10 @@ namespace embree
     void immutable ();
     bool verify ();
     void setDisplacementFunction (RTCDisplacementFunc func, RTCBounds* bounds);
+    void setEdgeLevelFunction (RTCEdgeLevelFunc func);
+    void setEdgeLevelCamera (const float* pos, float levelFactor);
+    void interpolateN(const void* valid, const unsigned* primIDs, const float* u, const float* v, size_t numUVs, 
+                      RTCBufferType buffer, float* P, float* dPdu, float* dPdv, size_t numFloats);
 
   public:
 
@@ -362,6 +369,9 @@ namespace embree
     /*! initializes the half edge data structure */
     void initializeHalfEdgeStructures ();
 
+    /*! precomputes the B-spline control points of all regular faces, only used by the cached subdivision builder */
+    void updateRegularPatches();
+
   private:
 
     /*! recalculates the half edges */
@@ -370,12 +380,46 @@ namespace embree
     /*! updates half edges when recalculation is not necessary */
     void updateHalfEdges();
 
+    /*! calculates the edge levels using the edge level function or camera */
+    void calculateEdgeLevels();
+
+    /*! finds all regular faces and gathers the vertex indices of their B-spline control points */
+    void calculateRegularPatches();
+
+    /*! frees the regular patch data */
+    void clearRegularPatches();
+
+    /*! estimates the displacement bounds of each face by sampling the displacement function */
+    void estimateDisplacementBounds();
+
+    /*! checks if edge levels are calculated by the implementation */
+    __forceinline bool hasAutoEdgeLevels() const { 
+      return levelFunc || levelFactor > 0.0f; 
+    }
+
   public:
     /*! returns the start half edge for some face */
     __forceinline const HalfEdge* getHalfEdge ( const size_t f ) const { 
       return &halfEdges[faceStartEdge[f]]; 
     }    
 
+    /*! returns the 4x4 B-spline control points of some face if it is a regular patch and NULL otherwise */
+    __forceinline const Vec3fa* getRegularPatch ( const size_t f ) const {
+      if (faceRegularPatch.size() == 0) return NULL;
+      const uint32 i = faceRegularPatch[f];
+      return i != uint32(-1) ? &regularPatchPoints[16*i] : NULL;
+    }
+
+    /*! returns estimated displacement bounds of some face, or the user specified bounds if not estimated */
+    __forceinline const BBox3fa& getDisplacementBounds ( const size_t f ) const {
+      return faceDisplBounds.size() ? faceDisplBounds[f] : displBounds;
+    }
+
+    /*! checks if displacement bounds got estimated per face */
+    __forceinline bool hasEstimatedDisplacementBounds() const {
+      return faceDisplBounds.size() != 0;
+    }
+
     /*! returns the vertex buffer for some time step */
     __forceinline const BufferT<Vec3fa>& getVertexBuffer( const size_t t = 0 ) const {
       return vertices[t];
@@ -390,6 +434,10 @@ namespace embree
     RTCDisplacementFunc displFunc;    //!< displacement function
     BBox3fa             displBounds;  //!< bounds for maximal displacement 
 
+    RTCEdgeLevelFunc    levelFunc;    //!< edge level function
+    Vec3fa              levelCamera;  //!< camera position for view dependent edge levels
+    float               levelFactor;  //!< scaling of view dependent edge levels, 0 if disabled
+
   private:
     size_t numFaces;                  //!< number of faces
     size_t numEdges;                  //!< number of edges
@@ -426,6 +474,9 @@ namespace embree
     /*! buffer that marks specific faces as holes */
     BufferT<unsigned> holes;
 
+    /*! user data buffers that can get interpolated */
+    BufferT<Vec3fa> userbuffers[2];
+
     /*! all data in this section if generated by initializeHalfEdgeStructures function */
   private:
 
@@ -438,13 +489,27 @@ namespace embree
     /*! set with all holes */
     pset<uint32> holeSet;
 
+    /*! index of the regular patch of each face, -1 for faces that are not regular */
+    std::vector<uint32> faceRegularPatch;
+
+    /*! vertex indices of the 16 B-spline control points of each regular patch */
+    std::vector<uint32> regularPatchIndices;
+
+    /*! 16 B-spline control points of each regular patch, updated whenever the vertices change */
+    std::vector<Vec3fa> regularPatchPoints;
+
+    /*! flag whether the control points of the regular patches are outdated */
+    bool regularPatchPointsModified;
+
+    /*! estimated displacement bounds of each face, empty if not estimated */
+    std::vector<BBox3fa> faceDisplBounds;
+
     /*! the following data is only required during construction of the
      *  half edge structure and can be cleared for static scenes */
   private:
 
-    /*! two arrays used to sort the half edges */
-    std::vector<KeyHalfEdge> halfEdges0;
-    std::vector<KeyHalfEdge> halfEdges1;
+    /*! hash table used to find the opposite half edges */
+    phash<uint64,EdgeSlot> edgeTable;
 
     /*! map with all vertex creases */
     pmap<uint32,float> vertexCreaseMap;
@@ -456,9 +521,16 @@ namespace embree
      *  allows for simple bvh update instead of full rebuild in cached mode */
     bool levelUpdate;
 
+    /*! flag whether topology and creases are unchanged, allows for
+     *  refitting the bvh instead of full rebuild in cached mode */
+    bool vertexUpdate;
+
   public:
     /* check for simple edge level update */
     __forceinline bool checkLevelUpdate() { return levelUpdate; }
 
+    /* check if topology and creases are unchanged, thus only the patch control points need an update */
+    __forceinline bool checkVertexUpdate() { return vertexUpdate; }
+
   };
 };
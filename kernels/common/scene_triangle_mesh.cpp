@@ -22,9 +22,11 @@ namespace embree
   TriangleMesh::TriangleMesh (Scene* parent, RTCGeometryFlags flags, size_t numTriangles, size_t numVertices, size_t numTimeSteps)
     : Geometry(parent,TRIANGLE_MESH,numTriangles,flags), 
       mask(-1), numTimeSteps(numTimeSteps),
-      numTriangles(numTriangles), numVertices(numVertices)
+      numTriangles(numTriangles), numVertices(numVertices),
+      alphaMaskWidth(0), alphaMaskHeight(0)
   {
     triangles.init(numTriangles,sizeof(Triangle));
+    texcoords.init(numVertices,sizeof(Vec2f));
     for (size_t i=0; i<numTimeSteps; i++) {
       vertices[i].init(numVertices,sizeof(Vec3fa));
     }
@@ -35,12 +37,14 @@ namespace embree
   { 
     if (numTimeSteps == 1) { atomic_add(&parent->numTriangles ,numTriangles); }
     else                   { atomic_add(&parent->numTriangles2,numTriangles); }
+    atomic_add(&parent->numAlphaMasks,alphaMask.size() != 0);
   }
   
   void TriangleMesh::disabling() 
   { 
     if (numTimeSteps == 1) { atomic_add(&parent->numTriangles ,-(ssize_t)numTriangles); }
     else                   { atomic_add(&parent->numTriangles2,-(ssize_t)numTriangles); }
+    atomic_sub(&parent->numAlphaMasks,alphaMask.size() != 0);
   }
 
   void TriangleMesh::setMask (unsigned mask) 
@@ -52,6 +56,58 @@ namespace embree
     this->mask = mask; 
   }
 
+  /*! checks if the triangle acceleration structure selected through
+   *  the tri_accel option uses the Triangle4 or Triangle8 intersectors */
+  static bool alphaMaskAccel(const std::string& accel)
+  {
+#if defined(__MIC__)
+    return false;
+#else
+    return accel == "default"        || accel == "bvh4.bvh4.triangle4" || 
+           accel == "bvh4.triangle4" || accel == "bvh4.triangle8" || 
+           accel == "bvh8.triangle4" || accel == "bvh8.triangle8";
+#endif
+  }
+
+  void TriangleMesh::setAlphaMask (const void* bits, size_t width, size_t height) 
+  {
+    if (parent->isStatic() && parent->isBuild()) {
+      process_error(RTC_INVALID_OPERATION,"static geometries cannot get modified");
+      return;
+    }
+
+    /* only the Triangle4 and Triangle8 intersectors perform the alpha test */
+    if (bits && (parent->isRobust() || parent->isCompact()) && g_tri_accel == "default") {
+      process_error(RTC_INVALID_OPERATION,"alpha masks are not supported in robust or compact scenes");
+      return;
+    }
+    if (bits && numTimeSteps != 1) {
+      process_error(RTC_INVALID_OPERATION,"alpha masks are not supported for motion blur meshes");
+      return;
+    }
+    if (bits && !alphaMaskAccel(g_tri_accel)) {
+      process_error(RTC_INVALID_OPERATION,"alpha masks are not supported by the selected triangle acceleration structure");
+      return;
+    }
+
+    /* only enabled geometries are counted, see enabling and disabling */
+    const bool counted = state >= ENABLING && state <= MODIFIED;
+    if (counted) atomic_sub(&parent->numAlphaMasks,alphaMask.size() != 0);
+
+    if (bits == NULL || width == 0 || height == 0) {
+      alphaMask.clear();
+      alphaMaskWidth = alphaMaskHeight = 0;
+      return;
+    }
+    
+    /* copy the bits, thus the application can release its texture */
+    alphaMask.resize((width*height+31)/32);
+    memcpy(&alphaMask[0],bits,alphaMask.size()*sizeof(unsigned int));
+    alphaMaskWidth = width;
+    alphaMaskHeight = height;
+    if (counted) atomic_add(&parent->numAlphaMasks,+1);
+  }
+
   void TriangleMesh::setBuffer(RTCBufferType type, void* ptr, size_t offset, size_t stride) 
   { 
     if (parent->isStatic() && parent->isBuild()) {
@@ -93,6 +149,9 @@ namespace embree
         volatile int w = *((int*)vertices[1].getPtr(numVertices-1)+3); // FIXME: is failing hard avoidable?
       }
       break;
+    case RTC_TEXCOORD_BUFFER: 
+      texcoords.set(ptr,offset,stride); 
+      break;
     default: 
       process_error(RTC_INVALID_ARGUMENT,"unknown buffer type");
       break;
@@ -110,6 +169,7 @@ namespace embree
     case RTC_INDEX_BUFFER  : return triangles  .map(parent->numMappedBuffers);
     case RTC_VERTEX_BUFFER0: return vertices[0].map(parent->numMappedBuffers);
     case RTC_VERTEX_BUFFER1: return vertices[1].map(parent->numMappedBuffers);
+    case RTC_TEXCOORD_BUFFER: return texcoords.map(parent->numMappedBuffers);
     default                : process_error(RTC_INVALID_ARGUMENT,"unknown buffer type"); return NULL;
     }
   }
@@ -125,6 +185,7 @@ namespace embree
     case RTC_INDEX_BUFFER  : triangles  .unmap(parent->numMappedBuffers); break;
     case RTC_VERTEX_BUFFER0: vertices[0].unmap(parent->numMappedBuffers); break;
     case RTC_VERTEX_BUFFER1: vertices[1].unmap(parent->numMappedBuffers); break;
+    case RTC_TEXCOORD_BUFFER: texcoords.unmap(parent->numMappedBuffers); break;
     default                : process_error(RTC_INVALID_ARGUMENT,"unknown buffer type"); break;
     }
   }
@@ -135,7 +196,7 @@ namespace embree
 
   void TriangleMesh::immutable () 
   {
-    bool freeTriangles = !parent->needTriangles;
+    bool freeTriangles = !parent->needTriangles && !alphaMask.size(); // alpha mask lookup needs the triangles
     bool freeVertices  = !parent->needVertices;
     if (freeTriangles) triangles.free();
     if (freeVertices ) vertices[0].free();
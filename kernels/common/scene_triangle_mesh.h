@@ -40,6 +40,7 @@ namespace embree
     void enabling();
     void disabling();
     void setMask (unsigned mask);
+    void setAlphaMask (const void* bits, size_t width, size_t height);
     void setBuffer(RTCBufferType type, void* ptr, size_t offset, size_t stride);
     void* map(RTCBufferType type);
     void unmap(RTCBufferType type);
@@ -76,6 +77,25 @@ namespace embree
       return vertices[j].getPtr(i);
     }
     
+    /*! returns texture coordinate of i'th vertex */
+    __forceinline const Vec2f& texcoord(size_t i) const {
+      assert(i < numVertices);
+      return texcoords[i];
+    }
+
+    /*! checks if an alpha mask and the texture coordinates to look it up are set */
+    __forceinline bool hasAlphaMask() const {
+      return alphaMask.size() && texcoords.getPtr();
+    }
+
+    /*! checks if texel (x,y) of the alpha mask is opaque */
+    __forceinline bool isOpaque(size_t x, size_t y) const 
+    {
+      assert(x < alphaMaskWidth && y < alphaMaskHeight);
+      const size_t i = y*alphaMaskWidth+x;
+      return (alphaMask[i/32] >> (i%32)) & 1;
+    }
+
     /*! returns the stride in bytes of the triangle buffer */
     __forceinline size_t getTriangleBufferStride() const {
       return triangles.getBufferStride();
@@ -190,6 +210,11 @@ namespace embree
     
     BufferT<Vec3fa> vertices[2];    //!< vertex array
     size_t numVertices;               //!< number of vertices
+
+    BufferT<Vec2f> texcoords;         //!< texture coordinates for alpha mask lookup
+    std::vector<unsigned int> alphaMask; //!< opacity bits of alpha mask
+    size_t alphaMaskWidth;            //!< width of alpha mask in texels
+    size_t alphaMaskHeight;           //!< height of alpha mask in texels
   };
 
   __forceinline std::ostream &operator<<(std::ostream &o, const TriangleMesh::Triangle &t)
@@ -43,10 +43,18 @@ namespace embree
     this->boundsFunc = bounds;
   }
 
+  void UserGeometry::setBoundsFunctionN (RTCBoundsFuncN boundsN) {
+    this->boundsFuncN = boundsN;
+  }
+
   void UserGeometry::setIntersectFunction (RTCIntersectFunc intersect1, bool ispc) {
     intersectors.intersector1.intersect = intersect1;
   }
 
+  void UserGeometry::setIntersectFunctionN (RTCIntersectFuncN intersectN) {
+    intersectors.intersectorN.intersect = intersectN;
+  }
+
   void UserGeometry::setIntersectFunction4 (RTCIntersectFunc4 intersect4, bool ispc) 
   {
     intersectors.intersector4.intersect = (void*)intersect4;
@@ -69,6 +77,10 @@ namespace embree
     intersectors.intersector1.occluded = occluded1;
   }
 
+  void UserGeometry::setOccludedFunctionN (RTCOccludedFuncN occludedN) {
+    intersectors.intersectorN.occluded = occludedN;
+  }
+
   void UserGeometry::setOccludedFunction4 (RTCOccludedFunc4 occluded4, bool ispc) 
   {
     intersectors.intersector4.occluded = (void*)occluded4;
@@ -42,6 +42,36 @@ namespace embree
       return inFloatRange(b);
     }
 
+    /*! calls func(i,bounds) for each valid primitive i in [begin,end) */
+    template<typename Func>
+      __forceinline void forallValid(size_t begin, size_t end, const Func& func) const
+    {
+      if (boundsFuncN == NULL) 
+      {
+        for (size_t i=begin; i<end; i++) {
+          BBox3fa bounds = empty;
+          if (!valid(i,&bounds)) continue;
+          func(i,bounds);
+        }
+        return;
+      }
+
+      /* query the bounds in blocks to keep the SoA arrays on the stack */
+      static const size_t blockSize = 256;
+      __aligned(64) float lower_x[blockSize], lower_y[blockSize], lower_z[blockSize];
+      __aligned(64) float upper_x[blockSize], upper_y[blockSize], upper_z[blockSize];
+      for (size_t b=begin; b<end; b+=blockSize) 
+      {
+        const size_t n = min(end-b,blockSize);
+        boundsFuncN(intersectors.ptr,b,b+n,lower_x,lower_y,lower_z,upper_x,upper_y,upper_z);
+        for (size_t i=0; i<n; i++) {
+          const BBox3fa bounds(Vec3fa(lower_x[i],lower_y[i],lower_z[i]),Vec3fa(upper_x[i],upper_y[i],upper_z[i]));
+          if (!inFloatRange(bounds)) continue;
+          func(b+i,bounds);
+        }
+      }
+    }
+
     void enabling ();
     void disabling();
   };
@@ -52,11 +82,14 @@ namespace embree
     UserGeometry (Scene* parent, size_t items); 
     virtual void setUserData (void* ptr, bool ispc);
     virtual void setBoundsFunction (RTCBoundsFunc bounds);
+    virtual void setBoundsFunctionN (RTCBoundsFuncN boundsN);
     virtual void setIntersectFunction (RTCIntersectFunc intersect, bool ispc);
+    virtual void setIntersectFunctionN (RTCIntersectFuncN intersectN);
     virtual void setIntersectFunction4 (RTCIntersectFunc4 intersect4, bool ispc);
     virtual void setIntersectFunction8 (RTCIntersectFunc8 intersect8, bool ispc);
     virtual void setIntersectFunction16 (RTCIntersectFunc16 intersect16, bool ispc);
     virtual void setOccludedFunction (RTCOccludedFunc occluded, bool ispc);
+    virtual void setOccludedFunctionN (RTCOccludedFuncN occludedN);
     virtual void setOccludedFunction4 (RTCOccludedFunc4 occluded4, bool ispc);
     virtual void setOccludedFunction8 (RTCOccludedFunc8 occluded8, bool ispc);
     virtual void setOccludedFunction16 (RTCOccludedFunc16 occluded16, bool ispc);
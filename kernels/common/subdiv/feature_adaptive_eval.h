@@ -21,6 +21,46 @@
 
 namespace embree
 {
+#if !defined(__MIC__)
+
+  /*! Evaluates positions and normalized normals of a patch at SIZE
+   *  parameter locations at once, 8-wide with AVX and 4-wide with SSE. */
+  struct PatchEvalSIMD
+  {
+#if defined(__AVX__)
+    enum { SIZE = 8 };
+#else
+    enum { SIZE = 4 };
+#endif
+
+    /*! u and v have to be aligned and hold SIZE entries, only the first N <= SIZE results are stored, normals are skipped if Ng is NULL */
+    template<typename Patch>
+    static __forceinline void eval(const Patch& patch, const float* u, const float* v, const size_t N, Vec3fa* P, Vec3fa* Ng)
+    {
+      assert(N <= SIZE);
+#if defined(__AVX__)
+      const avxf uu = load8f(u), vv = load8f(v);
+      const avx3f p = patch.eval8(uu,vv);
+#else
+      const ssef uu = load4f(u), vv = load4f(v);
+      const sse3f p = patch.eval4(uu,vv);
+#endif
+      for (size_t i=0; i<N; i++) 
+        P[i] = Vec3fa(p.x[i],p.y[i],p.z[i]);
+      if (Ng == NULL) return;
+
+#if defined(__AVX__)
+      const avx3f n = normalize_safe(patch.normal8(uu,vv));
+#else
+      const sse3f n = normalize_safe(patch.normal4(uu,vv));
+#endif
+      for (size_t i=0; i<N; i++) 
+        Ng[i] = Vec3fa(n.x[i],n.y[i],n.z[i]);
+    }
+  };
+
+#endif
+
   struct FeatureAdaptiveEval
   {
     const size_t x0,x1;
@@ -56,6 +96,26 @@ namespace embree
       {
 	BSplinePatch patcheval; patcheval.init(patch);
 	//GregoryPatch patcheval; patcheval.init(patch);
+#if !defined(__MIC__)
+	__aligned(64) float u[PatchEvalSIMD::SIZE], v[PatchEvalSIMD::SIZE];
+	for (float y=ly0; y<ly1; y++) 
+	{
+	  assert(y<sheight);
+	  const float fy = (float(y)-srange.lower.y)*scale_y;
+	  const size_t iy = (size_t) y;
+	  for (size_t i=0; i<PatchEvalSIMD::SIZE; i++) v[i] = fy;
+
+	  for (float x=lx0; x<lx1; x+=PatchEvalSIMD::SIZE) 
+	  { 
+	    assert(x<swidth);
+	    const size_t N = min(size_t(ceilf(lx1-x)),size_t(PatchEvalSIMD::SIZE));
+	    for (size_t i=0; i<PatchEvalSIMD::SIZE; i++) u[i] = (float(x+i)-srange.lower.x)*scale_x;
+	    const size_t ix = (size_t) x;
+	    assert(ix-x0+N <= dwidth && iy-y0 < dheight);
+	    PatchEvalSIMD::eval(patcheval,u,v,N,&P[(iy-y0)*dwidth+(ix-x0)],&Ng[(iy-y0)*dwidth+(ix-x0)]);
+	  }
+	}
+#else
 	for (float y=ly0; y<ly1; y++) 
 	{
 	  for (float x=lx0; x<lx1; x++) 
@@ -70,9 +130,20 @@ namespace embree
 	    Ng[(iy-y0)*dwidth+(ix-x0)] = normalize_safe(patcheval.normal(fx,fy));
 	  }
 	}
+#endif
       }
       else 
       {
+	const Vec3fa P0 = patch.ring[0].getLimitVertex();
+	const Vec3fa P1 = patch.ring[1].getLimitVertex();
+	const Vec3fa P2 = patch.ring[2].getLimitVertex();
+	const Vec3fa P3 = patch.ring[3].getLimitVertex();
+
+	const Vec3fa Ng0 = patch.ring[0].getNormal();
+	const Vec3fa Ng1 = patch.ring[1].getNormal();
+	const Vec3fa Ng2 = patch.ring[2].getNormal();
+	const Vec3fa Ng3 = patch.ring[3].getNormal();
+
 	for (float y=ly0; y<ly1; y++) 
 	{
 	  for (float x=lx0; x<lx1; x++) 
@@ -84,16 +155,7 @@ namespace embree
 	    const size_t ix = (size_t) x, iy = (size_t) y;
 	    assert(ix-x0 < dwidth && iy-y0 < dheight);
 
-	    const Vec3fa P0 = patch.ring[0].getLimitVertex();
-	    const Vec3fa P1 = patch.ring[1].getLimitVertex();
-	    const Vec3fa P2 = patch.ring[2].getLimitVertex();
-	    const Vec3fa P3 = patch.ring[3].getLimitVertex();
 	    P [(iy-y0)*dwidth+(ix-x0)] = sy0*(sx0*P0+sx1*P1) + sy1*(sx0*P3+sx1*P2);
-
-	    const Vec3fa Ng0 = patch.ring[0].getNormal();
-	    const Vec3fa Ng1 = patch.ring[1].getNormal();
-	    const Vec3fa Ng2 = patch.ring[2].getNormal();
-	    const Vec3fa Ng3 = patch.ring[3].getNormal();
 	    Ng[(iy-y0)*dwidth+(ix-x0)] = normalize_safe(sy0*(sx0*Ng0+sx1*Ng1) + sy1*(sx0*Ng3+sx1*Ng2));
 	  }
 	}
@@ -307,6 +307,37 @@ namespace embree
       }
     } 
     
+    /*! derivatives of the inner vertices of computeInnerVertices in u and v
+     *  direction, in the order 11, 12, 22, 21, zero at the patch border */
+    static __forceinline void computeInnerVertexDerivatives(const Vec3fa matrix[4][4],
+                                                            const Vec3fa f_m[2][2],
+                                                            const float uu,
+                                                            const float vv,
+                                                            Vec3fa_t dFdu[4],
+                                                            Vec3fa_t dFdv[4])
+    {
+      if (unlikely(uu == 0.0f || uu == 1.0f || vv == 0.0f || vv == 1.0f)) 
+      {
+        for (size_t i=0; i<4; i++) dFdu[i] = dFdv[i] = Vec3fa_t(0.0f);
+        return;
+      }
+
+      /* F = (a*x + b*y)/(a+b) has the derivatives b*(x-y)/(a+b)^2 in a and a*(y-x)/(a+b)^2 in b */
+      const Vec3fa_t d0 = (Vec3fa_t)matrix[1][1] - (Vec3fa_t)f_m[0][0];
+      const Vec3fa_t d1 = (Vec3fa_t)matrix[1][2] - (Vec3fa_t)f_m[0][1];
+      const Vec3fa_t d2 = (Vec3fa_t)matrix[2][2] - (Vec3fa_t)f_m[1][1];
+      const Vec3fa_t d3 = (Vec3fa_t)matrix[2][1] - (Vec3fa_t)f_m[1][0];
+      const float rcp0 = 1.0f/sqr(uu+vv);
+      const float rcp1 = 1.0f/sqr(1.0f-uu+vv);
+      const float rcp2 = 1.0f/sqr(2.0f-uu-vv);
+      const float rcp3 = 1.0f/sqr(1.0f+uu-vv);
+
+      dFdu[0] =        vv  * d0 * rcp0;  dFdv[0] = -       uu  * d0 * rcp0;
+      dFdu[1] =        vv  * d1 * rcp1;  dFdv[1] =   (1.0f-uu) * d1 * rcp1;
+      dFdu[2] = -(1.0f-vv) * d2 * rcp2;  dFdv[2] =   (1.0f-uu) * d2 * rcp2;
+      dFdu[3] = -(1.0f-vv) * d3 * rcp3;  dFdv[3] = -       uu  * d3 * rcp3;
+    }
+
     static __forceinline Vec3fa normal(const Vec3fa matrix[4][4],
 				       const Vec3fa f_m[2][2],
 				       const float uu,
@@ -679,6 +710,64 @@ namespace embree
       return normal(matrix,f_m,uu,vv);
     }
     
+    static __forceinline Vec3fa tangentU(const Vec3fa matrix[4][4],
+                                         const float uu,
+                                         const float vv) 
+    {
+      Vec3fa f_m[2][2];
+      f_m[0][0] = extract_f_m_Vec3fa(matrix,0);
+      f_m[0][1] = extract_f_m_Vec3fa(matrix,1);
+      f_m[1][1] = extract_f_m_Vec3fa(matrix,2);
+      f_m[1][0] = extract_f_m_Vec3fa(matrix,3);      
+
+      Vec3fa_t matrix_11, matrix_12, matrix_22, matrix_21;
+      computeInnerVertices(matrix,f_m,uu,vv,matrix_11, matrix_12, matrix_22, matrix_21);
+
+      const Vec3fa_t col0 = deCasteljau_t(vv, (Vec3fa_t)matrix[0][0], (Vec3fa_t)matrix[1][0], (Vec3fa_t)matrix[2][0], (Vec3fa_t)matrix[3][0]);
+      const Vec3fa_t col1 = deCasteljau_t(vv, (Vec3fa_t)matrix[0][1], (Vec3fa_t)matrix_11   , (Vec3fa_t)matrix_21   , (Vec3fa_t)matrix[3][1]);
+      const Vec3fa_t col2 = deCasteljau_t(vv, (Vec3fa_t)matrix[0][2], (Vec3fa_t)matrix_12   , (Vec3fa_t)matrix_22   , (Vec3fa_t)matrix[3][2]);
+      const Vec3fa_t col3 = deCasteljau_t(vv, (Vec3fa_t)matrix[0][3], (Vec3fa_t)matrix[1][3], (Vec3fa_t)matrix[2][3], (Vec3fa_t)matrix[3][3]);
+
+      /* the inner vertices depend on u as well */
+      Vec3fa_t dFdu[4], dFdv[4];
+      computeInnerVertexDerivatives(matrix,f_m,uu,vv,dFdu,dFdv);
+      const float one_minus_uu = 1.0f - uu, one_minus_vv = 1.0f - vv;
+      const float B1_u = 3.0f * one_minus_uu * one_minus_uu * uu, B2_u = 3.0f * one_minus_uu * uu * uu;
+      const float B1_v = 3.0f * one_minus_vv * one_minus_vv * vv, B2_v = 3.0f * one_minus_vv * vv * vv;
+      const Vec3fa_t inner = (B1_u * dFdu[0] + B2_u * dFdu[1]) * B1_v + (B1_u * dFdu[3] + B2_u * dFdu[2]) * B2_v;
+      
+      return 3.0f*deCasteljau_tangent_t(uu, col0, col1, col2, col3) + inner;
+    }
+
+    static __forceinline Vec3fa tangentV(const Vec3fa matrix[4][4],
+                                         const float uu,
+                                         const float vv) 
+    {
+      Vec3fa f_m[2][2];
+      f_m[0][0] = extract_f_m_Vec3fa(matrix,0);
+      f_m[0][1] = extract_f_m_Vec3fa(matrix,1);
+      f_m[1][1] = extract_f_m_Vec3fa(matrix,2);
+      f_m[1][0] = extract_f_m_Vec3fa(matrix,3);      
+
+      Vec3fa_t matrix_11, matrix_12, matrix_22, matrix_21;
+      computeInnerVertices(matrix,f_m,uu,vv,matrix_11, matrix_12, matrix_22, matrix_21);
+
+      const Vec3fa_t row0 = deCasteljau_t(uu, (Vec3fa_t)matrix[0][0], (Vec3fa_t)matrix[0][1], (Vec3fa_t)matrix[0][2], (Vec3fa_t)matrix[0][3]);
+      const Vec3fa_t row1 = deCasteljau_t(uu, (Vec3fa_t)matrix[1][0], (Vec3fa_t)matrix_11   , (Vec3fa_t)matrix_12   , (Vec3fa_t)matrix[1][3]);
+      const Vec3fa_t row2 = deCasteljau_t(uu, (Vec3fa_t)matrix[2][0], (Vec3fa_t)matrix_21   , (Vec3fa_t)matrix_22   , (Vec3fa_t)matrix[2][3]);
+      const Vec3fa_t row3 = deCasteljau_t(uu, (Vec3fa_t)matrix[3][0], (Vec3fa_t)matrix[3][1], (Vec3fa_t)matrix[3][2], (Vec3fa_t)matrix[3][3]);
+
+      /* the inner vertices depend on v as well */
+      Vec3fa_t dFdu[4], dFdv[4];
+      computeInnerVertexDerivatives(matrix,f_m,uu,vv,dFdu,dFdv);
+      const float one_minus_uu = 1.0f - uu, one_minus_vv = 1.0f - vv;
+      const float B1_u = 3.0f * one_minus_uu * one_minus_uu * uu, B2_u = 3.0f * one_minus_uu * uu * uu;
+      const float B1_v = 3.0f * one_minus_vv * one_minus_vv * vv, B2_v = 3.0f * one_minus_vv * vv * vv;
+      const Vec3fa_t inner = (B1_u * dFdv[0] + B2_u * dFdv[1]) * B1_v + (B1_u * dFdv[3] + B2_u * dFdv[2]) * B2_v;
+
+      return 3.0f*deCasteljau_tangent_t(vv, row0, row1, row2, row3) + inner;
+    }
+    
     __forceinline Vec3fa eval(const float uu, const float vv) const
     {
       Vec3fa_t v_11, v_12, v_22, v_21;
@@ -731,4 +820,26 @@ namespace embree
       return o;
     } 
   };
+
+#if !defined(__MIC__)
+
+  /*! Gregory patch with its control points exported once into the
+   *  dense matrix layout, for repeated SIMD evaluation. */
+  struct DenseGregoryPatch
+  {
+    __forceinline DenseGregoryPatch (const GregoryPatch& patch) {
+      patch.exportDenseConrolPoints(matrix);
+    }
+
+#if defined(__AVX__)
+    __forceinline avx3f eval8  (const avxf& uu, const avxf& vv) const { return GregoryPatch::eval8  (matrix,uu,vv); }
+    __forceinline avx3f normal8(const avxf& uu, const avxf& vv) const { return GregoryPatch::normal8(matrix,uu,vv); }
+#endif
+    __forceinline sse3f eval4  (const ssef& uu, const ssef& vv) const { return GregoryPatch::eval4  (matrix,uu,vv); }
+    __forceinline sse3f normal4(const ssef& uu, const ssef& vv) const { return GregoryPatch::normal4(matrix,uu,vv); }
+
+    Vec3fa matrix[4][4];
+  };
+
+#endif
 }
@@ -133,6 +133,32 @@ namespace embree
 #endif
   }
 
+  SubdivPatch1Base::SubdivPatch1Base (const Vec3fa controlPoints[16],
+                                      const unsigned int gID,
+                                      const unsigned int pID,
+                                      const SubdivMesh *const mesh,
+                                      const Vec2f uv[4],
+                                      const float edge_level[4]) 
+    : geom(gID),
+      prim(pID),  
+      flags(REGULAR_PATCH)
+  {
+    assert(mesh->displFunc == NULL);
+
+    for (size_t i=0;i<4;i++)
+      {
+        /* need to reverse input here */
+        u[i] = (unsigned short)(uv[i].y * 65535.0f);
+        v[i] = (unsigned short)(uv[i].x * 65535.0f);
+      }
+
+    updateEdgeLevels(edge_level,mesh);
+
+    for (size_t y=0;y<4;y++)
+      for (size_t x=0;x<4;x++)
+        patch.v[y][x] = controlPoints[4*y+x];
+  }
+
   BBox3fa SubdivPatch1Base::bounds(const SubdivMesh* const mesh) const
   {
 #if FORCE_TESSELLATION_BOUNDS == 1
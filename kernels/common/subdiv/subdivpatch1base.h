@@ -464,6 +464,14 @@ namespace embree
                       const Vec2f uv[4],
                       const float edge_level[4]);
 
+    /*! Construction from precomputed B-spline control points of a regular face. */
+    SubdivPatch1Base (const Vec3fa controlPoints[16],
+                      const unsigned int gID,
+                      const unsigned int pID,
+                      const SubdivMesh *const mesh,
+                      const Vec2f uv[4],
+                      const float edge_level[4]);
+
     __forceinline bool needsStiching() const
     {
       return (flags & TRANSITION_PATCH) == TRANSITION_PATCH;      
@@ -15,6 +15,7 @@
 // ======================================================================== //
 
 #include "tessellation_cache.h"
+#include "sys/thread.h"
 
 namespace embree
 {
@@ -51,6 +52,198 @@ namespace embree
               AtomicCounter TessellationCache::cache_evictions = 0;                
               );           
 
+
+  SharedTessellationCache sharedTessellationCache;
+
+  __thread SharedTessellationCache::ThreadState* SharedTessellationCache::thread_state = NULL;
+  __thread SharedTessellationCache::ThreadState* SharedTessellationCache::active_state = NULL;
+
+  const float SharedTessellationCache::GROW_MISS_RATE   = 0.10f;
+  const float SharedTessellationCache::SHRINK_MISS_RATE = 0.01f;
+
+  SharedTessellationCache::Storage::Storage (size_t blocks, size_t segments)
+    : retireTime(0), next(NULL)
+  {
+    segmentBlocks = blocks / segments;
+    data = (char*) _mm_malloc(64*segmentBlocks*segments,64);
+    numTags = 1; while (numTags < blocks/16) numTags *= 2;
+    tags = (volatile int64*) _mm_malloc(numTags*sizeof(int64),64);
+    for (size_t i=0; i<numTags; i++) tags[i] = 0;
+  }
+
+  SharedTessellationCache::Storage::~Storage () 
+  {
+    _mm_free(data);
+    _mm_free((void*)tags);
+  }
+
+  SharedTessellationCache::SharedTessellationCache ()
+    : state((int64)DEFAULT_SEGMENTS << 32), storage(NULL), retired(NULL), numSegments(DEFAULT_SEGMENTS), 
+      minBlocks(DEFAULT_64B_BLOCKS), maxBlocks(DEFAULT_MAX_64B_BLOCKS), threads(NULL), switching(0),
+      lastAccesses(0), lastHits(0), resetAccesses(0), resetHits(0), evictions(0), clears(0) {}
+
+  SharedTessellationCache::~SharedTessellationCache ()
+  {
+    clear();
+    for (ThreadState* t = threads; t; ) {
+      ThreadState* next = t->next;
+      delete t; t = next;
+    }
+  }
+
+  void SharedTessellationCache::clear()
+  {
+    delete storage; storage = NULL;
+    while (retired) {
+      Storage* next = retired->next;
+      delete retired; retired = next;
+    }
+  }
+
+  void SharedTessellationCache::configure(size_t bytes, size_t maxBytes, size_t segments)
+  {
+    Lock<MutexSys> lock(mutex);
+    numSegments = clamp(segments,(size_t)2,MAX_64B_BLOCKS/MIN_SEGMENT_64B_BLOCKS);
+    minBlocks = min(max(bytes/64,numSegments*MIN_SEGMENT_64B_BLOCKS),MAX_64B_BLOCKS);
+    maxBlocks = min(max(maxBytes/64,minBlocks),MAX_64B_BLOCKS);
+
+    /* old tags must not be valid in the new time */
+    clear();
+
+    /* private memory is only referenced while rays are traced */
+    for (ThreadState* t = threads; t; t=t->next) {
+      if (t->privateData) _mm_free(t->privateData);
+      t->privateData = NULL; t->privateBlocks = 0;
+    }
+    state = (int64)(time()+numSegments) << 32;
+
+    /* registered threads expect storage, otherwise it gets allocated lazily */
+    if (threads) storage = new Storage(minBlocks,numSegments);
+  }
+
+  SharedTessellationCache::Stats SharedTessellationCache::getStats()
+  {
+    Lock<MutexSys> lock(mutex);
+    Stats stats;
+    stats.size = storage ? 64*storage->segmentBlocks*numSegments : 0;
+    stats.accesses = stats.hits = 0;
+    for (ThreadState* t = threads; t; t=t->next) {
+      stats.accesses += t->accesses;
+      stats.hits += t->hits;
+    }
+    stats.accesses -= resetAccesses;
+    stats.hits -= resetHits;
+    stats.misses = stats.accesses - stats.hits;
+    stats.evictions = evictions;
+    stats.clears = clears;
+    return stats;
+  }
+
+  void SharedTessellationCache::resetStats()
+  {
+    /* the counters only get written by the owners of the states, thus the reset only remembers their current values */
+    Lock<MutexSys> lock(mutex);
+    resetAccesses = resetHits = 0;
+    for (ThreadState* t = threads; t; t=t->next) {
+      resetAccesses += t->accesses;
+      resetHits += t->hits;
+    }
+    evictions = clears = 0;
+  }
+
+  SharedTessellationCache::EntryHeader* SharedTessellationCache::allocPrivate(ThreadState* t, const size_t blocks, unsigned int& entryTime)
+  {
+    if (t->privateBlocks < blocks) 
+    {
+      if (t->privateData) _mm_free(t->privateData);
+      t->privateData = (char*) _mm_malloc(64*blocks,64);
+      t->privateBlocks = blocks;
+    }
+    entryTime = THREAD_IDLE;
+    return (EntryHeader*) t->privateData;
+  }
+
+  SharedTessellationCache::ThreadState* SharedTessellationCache::claimThreadState()
+  {
+    /* reuse the state of some thread that left the cache */
+    for (ThreadState* t = threads; t; t=t->next) {
+      if (t->owned == 0 && atomic_cmpxchg(&t->owned,0,1) == 0) 
+        return thread_state = t;
+    }
+
+    /* states are never removed from the list, thus threads can traverse it without locking */
+    ThreadState* t = new ThreadState;
+    Lock<MutexSys> lock(mutex);
+
+    /* lazily allocate cache memory when the first thread needs it */
+    if (storage == NULL) 
+      storage = new Storage(minBlocks,numSegments);
+
+    t->next = threads;
+    __memory_barrier();
+    threads = t;
+    return thread_state = t;
+  }
+
+  void SharedTessellationCache::switchSegment(const unsigned int observedTime)
+  {
+    /* only one thread switches, the others wait for the next time without blocking the mutex */
+    if (atomic_cmpxchg(&switching,0,1) != 0) {
+      while (time() == observedTime) yield();
+      return;
+    }
+    if (time() != observedTime) {
+      switching = 0;
+      return;
+    }
+
+    /* entries of the segment to reuse might get referenced by threads that work in an earlier time */
+    for (ThreadState* t = threads; t; t=t->next) {
+      while (t->time < observedTime) 
+        yield();
+    }
+
+    Lock<MutexSys> lock(mutex);
+    size_t accesses = 0, hits = 0;
+    for (ThreadState* t = threads; t; t=t->next) {
+      accesses += t->accesses;
+      hits += t->hits;
+    }
+
+    /* free replaced storage no thread can reference anymore */
+    for (Storage** s = &retired; *s; ) 
+    {
+      if ((*s)->retireTime > observedTime) { s = &(*s)->next; continue; }
+      Storage* next = (*s)->next;
+      delete *s; *s = next;
+    }
+
+    /* resize cache based on the miss rate since the last segment switch */
+    const size_t curAccesses = accesses - lastAccesses;
+    const size_t curMisses = curAccesses - (hits - lastHits);
+    const float missRate = curAccesses ? float(curMisses)/float(curAccesses) : 0.0f;
+    lastAccesses = accesses; lastHits = hits;
+    evictions++;
+
+    const size_t blocks = storage->segmentBlocks*numSegments;
+    size_t newBlocks = blocks;
+    if      (missRate > GROW_MISS_RATE   && blocks < maxBlocks) newBlocks = min(2*blocks,maxBlocks);
+    else if (missRate < SHRINK_MISS_RATE && blocks > minBlocks) newBlocks = max(blocks/2,minBlocks);
+
+    if (newBlocks/numSegments != storage->segmentBlocks) 
+    {
+      storage->retireTime = observedTime+1;
+      storage->next = retired;
+      retired = storage;
+      storage = new Storage(newBlocks,numSegments);
+      clears++;
+    }
+
+    __memory_barrier();
+    state = (int64)(observedTime+1) << 32;
+    __memory_barrier();
+    switching = 0;
+  }
 };
 
 extern "C" void printTessCacheStats()
@@ -419,4 +419,260 @@ namespace embree
 
   };
 
+  /*! Tessellation cache shared by all rendering threads. The cache
+   *  memory is split into segments that get filled one after the
+   *  other. Entries are found lock free through a direct mapped tag
+   *  table and stay valid for 'segments-1' segment switches. A segment
+   *  is only reused once no thread can reference one of its entries
+   *  anymore. At each segment switch the cache may get resized based
+   *  on the miss rate observed since the last switch. */
+  class SharedTessellationCache 
+  {
+  public:
+
+    static const size_t DEFAULT_SEGMENTS       = 4;
+    static const size_t DEFAULT_64B_BLOCKS     = ((size_t)1<<20); // 64MB initial size
+    static const size_t DEFAULT_MAX_64B_BLOCKS = ((size_t)1<<23); // 512MB maximal size
+    static const size_t MAX_64B_BLOCKS         = ((size_t)1<<24); // 1GB, larger configured sizes get clamped
+    static const size_t MIN_SEGMENT_64B_BLOCKS = ((size_t)1<<12); // 256KB, smaller configured segments get enlarged
+    static const size_t CACHE_MISS             = (size_t)-1;
+    static const unsigned int THREAD_IDLE      = (unsigned int)-1;
+
+    /*! grow cache if more lookups miss, shrink if less lookups miss */
+    static const float GROW_MISS_RATE;
+    static const float SHRINK_MISS_RATE;
+
+    /*! State of a thread that traverses cached entries, stores the
+     *  cache time the thread works in. States are owned by one thread
+     *  between enterThread and leaveThread, and get reused by other
+     *  threads afterwards. A thread owns multiple states if it traces
+     *  rays from inside a traversal, e.g. in a filter function. */
+    struct __aligned(64) ThreadState 
+    {
+      ALIGNED_STRUCT_(64);
+
+      ThreadState () : time(THREAD_IDLE), owned(1), next(NULL), accesses(0), hits(0), outer(NULL), privateData(NULL), privateBlocks(0) {}
+      ~ThreadState () { if (privateData) _mm_free(privateData); }
+
+      volatile unsigned int time;
+      volatile int32 owned;         //!< 1 while some thread uses this state
+      ThreadState* volatile next;
+      volatile size_t accesses;     //!< number of lookups done with this state, only written by the owner
+      volatile size_t hits;         //!< number of successful lookups done with this state, only written by the owner
+      ThreadState* outer;           //!< state of the enclosing traversal of the same thread, NULL if not nested
+      char* privateData;            //!< memory for an entry that cannot get stored in the cache
+      size_t privateBlocks;         //!< size of private memory in 64 byte blocks
+    };
+
+    /*! header stored in the first 64 bytes block of each entry */
+    struct __aligned(64) EntryHeader 
+    {
+      const void* prim;
+      unsigned int commitCounter;
+      size_t root;
+    };
+
+    /*! cache memory and tag table, replaced as a whole when resizing */
+    struct Storage
+    {
+      Storage (size_t blocks, size_t segments);
+      ~Storage ();
+
+      /*! direct mapped tag table index of primitive */
+      __forceinline size_t tagIndex(const void* prim) const {
+        return (((size_t)prim) >> 6) & (numTags-1);
+      }
+
+    public:
+      char* data;                    //!< cache memory of all segments
+      size_t segmentBlocks;          //!< number of 64 byte blocks per segment
+      volatile int64* tags;          //!< direct mapped tags, time in upper 32 bits, entry block in lower 32 bits
+      size_t numTags;                //!< number of tags, power of 2
+      unsigned int retireTime;       //!< storage can get freed once all threads work in this time
+      Storage* next;                 //!< next retired storage
+    };
+
+    /*! cache statistics */
+    struct Stats
+    {
+      size_t size;        //!< current size of cache memory in bytes
+      size_t accesses;    //!< number of lookups
+      size_t hits;        //!< number of lookups that found their entry
+      size_t misses;      //!< number of lookups that required tessellation
+      size_t evictions;   //!< number of evicted segments
+      size_t clears;      //!< number of times the cache got cleared by a resize
+    };
+
+  public:
+
+    SharedTessellationCache ();
+    ~SharedTessellationCache ();
+
+    /*! Sets initial and maximal cache size in bytes and the number of
+     *  segments. Sizes get enlarged such that each segment has at least
+     *  MIN_SEGMENT_64B_BLOCKS blocks. Must not get called while rays are traced. */
+    void configure(size_t bytes, size_t maxBytes, size_t segments);
+
+    /*! returns statistics */
+    Stats getStats();
+
+    /*! resets statistics */
+    void resetStats();
+
+    /*! Returns a state owned by the calling thread until leaveThread
+     *  gets called. The thread reuses its last state if that is free. */
+    __forceinline ThreadState* enterThread() 
+    {
+      ThreadState* t = thread_state;
+      if (unlikely(!t || atomic_cmpxchg(&t->owned,0,1) != 0)) 
+        t = claimThreadState();
+      t->outer = active_state;
+      active_state = t;
+      return t;
+    }
+
+    /*! releases the state, the thread must not reference any entry anymore */
+    __forceinline void leaveThread(ThreadState* t) 
+    {
+      assert(active_state == t);
+      active_state = t->outer;
+      t->outer = NULL;
+      unlockThread(t);
+      __memory_barrier();
+      t->owned = 0;
+    }
+
+    /*! returns the current cache time */
+    __forceinline unsigned int time() const {
+      return (unsigned int)(state >> 32);
+    }
+
+    /*! Moves thread into the current cache time and returns the
+     *  storage to use. The thread must not reference any entry it
+     *  looked up before. */
+    __forceinline Storage* lockThread(ThreadState* t, unsigned int& current)
+    {
+      while (true) 
+      {
+        current = time();
+        atomic_xchg((volatile atomic32_t*)&t->time,(atomic32_t)current);
+        if (likely(time() == current)) return storage;
+      }
+    }
+
+    /*! marks the thread as not referencing any entry */
+    __forceinline void unlockThread(ThreadState* t) 
+    {
+      __memory_barrier();
+      t->time = THREAD_IDLE;
+    }
+
+    /*! lookup subtree root of primitive, thread has to be locked at 'time' */
+    __forceinline size_t lookup(ThreadState* t, const Storage* s, const void* prim, const unsigned int commitCounter, const unsigned int time) const
+    {
+      t->accesses++;
+      const int64 tag = s->tags[s->tagIndex(prim)];
+      if (unlikely(time - (unsigned int)(tag >> 32) >= numSegments-1))
+        return CACHE_MISS;
+
+      const EntryHeader* entry = (const EntryHeader*) &s->data[64*(size_t)(tag & 0xffffffff)];
+      if (unlikely(entry->prim != prim || entry->commitCounter != commitCounter))
+        return CACHE_MISS;
+
+      t->hits++;
+      return entry->root;
+    }
+
+    /*! Allocates entry of 'blocks' 64 byte blocks including the
+     *  header, thread has to be locked. Entries that cannot get stored
+     *  in the cache are allocated in memory private to the state, which
+     *  stays valid until the next allocation. */
+    __forceinline EntryHeader* alloc(ThreadState* t, Storage*& s, const size_t blocks, unsigned int& entryTime)
+    {
+      while (true)
+      {
+        if (unlikely(blocks > s->segmentBlocks))
+          return allocPrivate(t,blocks,entryTime);
+
+        const int64 st = atomic_add(&state,(int64)blocks);
+        const unsigned int curTime = (unsigned int)(st >> 32);
+        const size_t index = (size_t)(st & 0xffffffff);
+        if (likely(index + blocks <= s->segmentBlocks)) {
+          entryTime = curTime;
+          return (EntryHeader*) &s->data[64*((curTime % numSegments)*s->segmentBlocks + index)];
+        }
+
+        /* the segment switch would wait forever for an enclosing traversal of this thread */
+        if (unlikely(isBlockedByOuter(t,curTime)))
+          return allocPrivate(t,blocks,entryTime);
+
+        /* we reference no entries here, thus we can go idle while waiting for the segment switch */
+        unlockThread(t);
+        switchSegment(curTime);
+        unsigned int newTime;
+        s = lockThread(t,newTime);
+      }
+    }
+
+    /*! publishes entry after its subtree got build */
+    __forceinline void insert(Storage* s, EntryHeader* entry, const unsigned int entryTime, const void* prim, const unsigned int commitCounter, const size_t root)
+    {
+      /* private entries are not visible to other threads */
+      if (unlikely(entryTime == THREAD_IDLE))
+        return;
+
+      entry->prim = prim;
+      entry->commitCounter = commitCounter;
+      entry->root = root;
+      __memory_barrier();
+      const size_t index = ((char*)entry - s->data) / 64;
+      s->tags[s->tagIndex(prim)] = ((int64)entryTime << 32) | (int64)index;
+    }
+
+  private:
+
+    /*! checks if an enclosing traversal of the thread works in a time before 'time' */
+    __forceinline bool isBlockedByOuter(const ThreadState* t, const unsigned int time) const
+    {
+      for (const ThreadState* o = t->outer; o; o=o->outer)
+        if (o->time < time) return true;
+      return false;
+    }
+
+    /*! allocates entry in the private memory of the state */
+    EntryHeader* allocPrivate(ThreadState* t, const size_t blocks, unsigned int& entryTime);
+
+    /*! takes some free state or registers a new one, allocates cache memory on first use */
+    ThreadState* claimThreadState();
+
+    /*! advances cache time once no thread references entries of the next segment */
+    void switchSegment(const unsigned int observedTime);
+
+    /*! frees all storage */
+    void clear();
+
+  private:
+    volatile int64 state;          //!< current time in upper 32 bits, next free block of current segment in lower 32 bits
+    Storage* volatile storage;     //!< current cache memory
+    Storage* retired;              //!< list of replaced storage that may still get referenced
+    size_t numSegments;            //!< number of segments
+    size_t minBlocks;              //!< configured initial size in 64 byte blocks
+    size_t maxBlocks;              //!< configured maximal size in 64 byte blocks
+    ThreadState* volatile threads; //!< list of all thread states, only grows
+    MutexSys mutex;                //!< protects thread registration, statistics, and storage replacement
+    volatile atomic_t switching;   //!< set while some thread switches the segment
+
+    size_t lastAccesses;           //!< accesses at last segment switch
+    size_t lastHits;               //!< hits at last segment switch
+    size_t resetAccesses;          //!< accesses at last reset of statistics
+    size_t resetHits;              //!< hits at last reset of statistics
+    size_t evictions;              //!< number of segment switches
+    size_t clears;                 //!< number of resizes
+
+    static __thread ThreadState* thread_state;
+    static __thread ThreadState* active_state; //!< innermost state owned by the thread
+  };
+
+  /*! tessellation cache used by all threads */
+  extern SharedTessellationCache sharedTessellationCache;
 };
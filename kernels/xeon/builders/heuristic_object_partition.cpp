@@ -15,6 +15,7 @@
 // ======================================================================== //
 
 #include "heuristic_object_partition.h"
+#include "algorithms/parallel_partition.h"
 
 namespace embree
 {
@@ -515,6 +516,73 @@ namespace embree
       linfo_o.add(leftBounds.geomBounds,leftBounds.centBounds,numLeft);
       rinfo_o.add(rightBounds.geomBounds,rightBounds.centBounds,numRight);
     }
+
+    void ObjectPartition::Split::split_nested(size_t threadIndex, PrimRefBlockAlloc<PrimRef>& alloc, 
+                                              PrimRefList& prims, 
+                                              PrimRefList& lprims_o, PrimInfo& linfo_o, 
+                                              PrimRefList& rprims_o, PrimInfo& rinfo_o) const
+    {
+      assert(valid());
+      linfo_o.reset();
+      rinfo_o.reset();
+
+      /* each task takes blocks from the list until the list is empty */
+      const size_t numTasks = min(maxTasks,getNumParallelThreads());
+      PrimInfo linfos[maxTasks];
+      PrimInfo rinfos[maxTasks];
+      PrimRefBlockAlloc<PrimRef>::ThreadPrimBlockAllocator* caches[maxTasks];
+      parallel_for(numTasks, [&](const size_t taskIndex) 
+      {
+        /* tasks do not know their thread, thus they use their own block cache */
+        PrimRefBlockAlloc<PrimRef>::ThreadPrimBlockAllocator* cache = caches[taskIndex] = new PrimRefBlockAlloc<PrimRef>::ThreadPrimBlockAllocator;
+        PrimRefList::item* lblock = lprims_o.insert(alloc.malloc(*cache));
+        PrimRefList::item* rblock = rprims_o.insert(alloc.malloc(*cache));
+        
+        size_t numLeft = 0; CentGeomBBox3fa leftBounds(empty);
+        size_t numRight = 0; CentGeomBBox3fa rightBounds(empty);
+        
+        while (PrimRefList::item* block = prims.take()) 
+        {
+          for (size_t i=0; i<block->size(); i++) 
+          {
+            const PrimRef& prim = block->at(i); 
+            const Vec3fa center = center2(prim.bounds());
+            const ssei bin = ssei(mapping.bin_unsafe(center));
+            
+            if (bin[dim] < pos) 
+            {
+              leftBounds.extend(prim.bounds()); numLeft++;
+              if (likely(lblock->insert(prim))) continue; 
+              lblock = lprims_o.insert(alloc.malloc(*cache));
+              lblock->insert(prim);
+            } 
+            else 
+            {
+              rightBounds.extend(prim.bounds()); numRight++;
+              if (likely(rblock->insert(prim))) continue;
+              rblock = rprims_o.insert(alloc.malloc(*cache));
+              rblock->insert(prim);
+            }
+          }
+          cache->free(block);
+        }
+
+        linfos[taskIndex].reset(); linfos[taskIndex].add(leftBounds.geomBounds,leftBounds.centBounds,numLeft);
+        rinfos[taskIndex].reset(); rinfos[taskIndex].add(rightBounds.geomBounds,rightBounds.centBounds,numRight);
+      });
+
+      /* return the blocks of all task caches to the calling thread */
+      for (size_t i=0; i<numTasks; i++) {
+        alloc.merge(threadIndex,*caches[i]);
+        delete caches[i];
+      }
+
+      /* reduction of bounding info */
+      for (size_t i=0; i<numTasks; i++) {
+	linfo_o.merge(linfos[i]);
+	rinfo_o.merge(rinfos[i]);
+      }
+    }
         
     void ObjectPartition::Split::partition(PrimRef *__restrict__ const prims, const size_t begin, const size_t end, PrimInfo& left, PrimInfo& right) const
     {
@@ -555,6 +623,23 @@ namespace embree
       assert(area(left.geomBounds) >= 0.0f);
       assert(area(right.geomBounds) >= 0.0f);
     }
+
+    void ObjectPartition::Split::partition_parallel(PrimRef *__restrict__ const prims, const size_t begin, const size_t end, PrimInfo& left, PrimInfo& right) const
+    {
+      assert(valid());
+      CentGeomBBox3fa local_left(empty);
+      CentGeomBBox3fa local_right(empty);
+
+      const size_t center = parallel_partition(prims,begin,end,size_t(8*1024),CentGeomBBox3fa(empty),local_left,local_right,
+                                               [&] (const PrimRef& prim) { return mapping.bin_unsafe(center2(prim.bounds()))[dim] < pos; },
+                                               [ ] (CentGeomBBox3fa& bounds, const PrimRef& prim) { bounds.extend(prim.bounds()); },
+                                               [ ] (const CentGeomBBox3fa& a, const CentGeomBBox3fa& b) { CentGeomBBox3fa c = a; c.merge(b); return c; });
+
+      new (&left ) PrimInfo(begin,center,local_left.geomBounds,local_left.centBounds);
+      new (&right) PrimInfo(center,end,local_right.geomBounds,local_right.centBounds);
+      assert(area(left.geomBounds) >= 0.0f);
+      assert(area(right.geomBounds) >= 0.0f);
+    }
     
     template<typename Prim>
     ObjectPartition::TaskSplitParallel<Prim>::TaskSplitParallel(size_t threadIndex, size_t threadCount, LockStepTaskScheduler* scheduler, const Split* split, PrimRefBlockAlloc<Prim>& alloc, List& prims, 
@@ -127,10 +127,20 @@ namespace embree
 		     PrimRefList& lprims_o, PrimInfo& linfo_o, 
 		     PrimRefList& rprims_o, PrimInfo& rinfo_o) const;
 	
+	/*! parallel splitting into two sets from inside a task */
+	void split_nested(size_t threadIndex, PrimRefBlockAlloc<PrimRef>& alloc, 
+			  PrimRefList& prims, 
+			  PrimRefList& lprims_o, PrimInfo& linfo_o, 
+			  PrimRefList& rprims_o, PrimInfo& rinfo_o) const;
+	
 	/*! array partitioning */
 	void partition(PrimRef *__restrict__ const prims, const size_t begin, const size_t end,
 		       PrimInfo& left, PrimInfo& right) const;
 
+	/*! parallel array partitioning, can get invoked from inside a task */
+	void partition_parallel(PrimRef *__restrict__ const prims, const size_t begin, const size_t end,
+				PrimInfo& left, PrimInfo& right) const;
+
 	/*! stream output */
 	friend std::ostream& operator<<(std::ostream& cout, const Split& split) {
 	  return cout << "Split { sah = " << split.sah << ", dim = " << split.dim << ", pos = " << split.pos << "}";
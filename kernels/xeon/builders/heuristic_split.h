@@ -104,6 +104,16 @@ namespace embree
 	  default: THROW_RUNTIME_ERROR("internal error");
 	  }
 	}
+
+      /*! splitting into two sets from inside a task, object splits are performed in parallel */
+      void split_nested(size_t threadIndex, size_t threadCount, PrimRefBlockAlloc<PrimRef>& alloc, 
+			Scene* scene, PrimRefList& prims, 
+			PrimRefList& lprims_o, PrimInfo& linfo_o, 
+			PrimRefList& rprims_o, PrimInfo& rinfo_o) const
+      {
+	if (type == OBJECT_SPLIT) ((ObjectPartition::Split*)&data)->split_nested(threadIndex,alloc,prims,lprims_o,linfo_o,rprims_o,rinfo_o);
+	else split<false>(threadIndex,threadCount,NULL,alloc,scene,prims,lprims_o,linfo_o,rprims_o,rinfo_o);
+      }
       
       private:
       __aligned(16) char data[SIZE]; //!< stores the different split types
@@ -27,31 +27,61 @@ namespace embree
     ALIGNED_CLASS;
   public:
     
+    typedef typename atomic_set<PrimRefBlockT<PrimRef> >::item Block;
+
+    /*! Thread local cache of primitive blocks. Blocks get reused from
+     *  the local free list or carved from a local chunk of memory, only
+     *  allocating a new chunk accesses the shared allocator. */
     struct __aligned(4096) ThreadPrimBlockAllocator 
     {
       ALIGNED_CLASS_(4096);
     public:
+
+      /*! number of blocks allocated at once from the shared allocator */
+      static const size_t blocksPerChunk = sizeof(Block) < Alloc::blockSize ? Alloc::blockSize/sizeof(Block) : 1;
+
+      ThreadPrimBlockAllocator () : cur(0), end(0) {}
       
-      __forceinline typename atomic_set<PrimRefBlockT<PrimRef> >::item* malloc(size_t thread, AllocatorBase* alloc) 
+      __forceinline Block* malloc(size_t thread, AllocatorBase* alloc) 
       {
 	/* try to take a block from local list */
-	typename atomic_set<PrimRefBlockT<PrimRef> >::item* ptr = local_free_blocks.take_unsafe();
-	if (ptr) return new (ptr) typename atomic_set<PrimRefBlockT<PrimRef> >::item();
-	
-	/* if this failed again we have to allocate more memory */
-	//ptr = (typename atomic_set<PrimRefBlockT<PrimRef> >::item*) alloc->malloc_global(sizeof(typename atomic_set<PrimRefBlockT<PrimRef> >::item));
-        ptr = (typename atomic_set<PrimRefBlockT<PrimRef> >::item*) alloc->malloc(sizeof(typename atomic_set<PrimRefBlockT<PrimRef> >::item));
-        
-	/* return first block */
-	return new (ptr) typename atomic_set<PrimRefBlockT<PrimRef> >::item();
+	Block* ptr = local_free_blocks.take_unsafe();
+	if (ptr) return new (ptr) Block();
+
+        /* then carve a block from the local chunk */
+        if (unlikely(cur == end)) {
+          cur = (char*) alloc->malloc(blocksPerChunk*sizeof(Block));
+          end = cur + blocksPerChunk*sizeof(Block);
+        }
+        ptr = (Block*) cur;
+        cur += sizeof(Block);
+	return new (ptr) Block();
       }
       
-      __forceinline void free(typename atomic_set<PrimRefBlockT<PrimRef> >::item* ptr) {
+      __forceinline void free(Block* ptr) {
 	local_free_blocks.insert_unsafe(ptr);
       }
+
+      /*! moves all free blocks of some other cache to this cache */
+      void merge(ThreadPrimBlockAllocator& other) 
+      {
+        while (Block* ptr = other.local_free_blocks.take_unsafe())
+          local_free_blocks.insert_unsafe(ptr);
+        for (; other.cur != other.end; other.cur += sizeof(Block))
+          local_free_blocks.insert_unsafe((Block*)other.cur);
+      }
+
+      /*! forgets all cached blocks, called when their memory gets returned to the shared allocator */
+      void clear() 
+      {
+        local_free_blocks = atomic_set<PrimRefBlockT<PrimRef> >();
+        cur = end = 0;
+      }
       
     public:
       atomic_set<PrimRefBlockT<PrimRef> > local_free_blocks; //!< only accessed from one thread
+      char* cur;                                             //!< next free block of local chunk
+      char* end;                                             //!< end of local chunk
     };
     
   public:
@@ -68,16 +98,35 @@ namespace embree
 	cur = end = 0;*/
     }
     
+    /*! Returns all blocks to the shared allocator. The thread caches
+     *  point into these blocks, thus they get reset, too. */
+    void clear() 
+    {
+      for (size_t i=0; i<getNumberOfLogicalThreads(); i++)
+        threadPrimBlockAllocator[i].clear();
+      AllocatorBase::clear();
+    }
+    
     /*! Allocate a primitive block */
-    __forceinline typename atomic_set<PrimRefBlockT<PrimRef> >::item* malloc(size_t thread) {
+    __forceinline Block* malloc(size_t thread) {
       return threadPrimBlockAllocator[thread].malloc(thread,this);
     }
     
     /*! Frees a primitive block */
-    __forceinline void free(size_t thread, typename atomic_set<PrimRefBlockT<PrimRef> >::item* block) {
+    __forceinline void free(size_t thread, Block* block) {
       return threadPrimBlockAllocator[thread].free(block);
     }
 
+    /*! Allocate a primitive block through some cache that is not bound to a thread */
+    __forceinline Block* malloc(ThreadPrimBlockAllocator& cache) {
+      return cache.malloc(0,this);
+    }
+
+    /*! Returns all blocks of a cache that is not bound to a thread to the cache of some thread */
+    __forceinline void merge(size_t thread, ThreadPrimBlockAllocator& cache) {
+      threadPrimBlockAllocator[thread].merge(cache);
+    }
+
 #if 0
     /*! initializes the allocator */
     void init (size_t numAllocate, size_t numReserve) 
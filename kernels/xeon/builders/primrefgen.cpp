@@ -26,6 +26,23 @@ namespace embree
 
     const size_t single_threaded_primrefgen_threshold = 10000;
 
+    /*! calls func(i,bounds) for each valid primitive i in [begin,end) of a geometry */
+    template<typename Ty, typename Func>
+      __forceinline void forallValid(const Ty* geom, size_t begin, size_t end, const Func& func)
+    {
+      for (size_t i=begin; i<end; i++) {
+        BBox3fa bounds = empty;
+        if (!geom->valid(i,&bounds)) continue;
+        func(i,bounds);
+      }
+    }
+
+    /*! user geometries may calculate the bounds of a range of primitives in one call */
+    template<typename Func>
+      __forceinline void forallValid(const UserGeometryBase* geom, size_t begin, size_t end, const Func& func) {
+      geom->forallValid(begin,end,func);
+    }
+
     void PrimRefListGen::generate(size_t threadIndex, size_t threadCount, LockStepTaskScheduler* scheduler, PrimRefBlockAlloc<PrimRef>* alloc, const Scene* scene, GeometryTy ty, size_t numTimeSteps, PrimRefList& prims, PrimInfo& pinfo) {
       PrimRefListGen gen(threadIndex,threadCount,scheduler,alloc,scene,ty,numTimeSteps,prims,pinfo);
     }
@@ -41,6 +58,7 @@ namespace embree
       if ((ty & BEZIER_CURVES) && (numTimeSteps & 1)) numPrimitives += scene->numBezierCurves;
       if ((ty & BEZIER_CURVES) && (numTimeSteps & 2)) numPrimitives += scene->numBezierCurves2;
       if ((ty & USER_GEOMETRY)                      ) numPrimitives += scene->numUserGeometries1;
+      if ((ty & POINTS       ) && (numTimeSteps & 1)) numPrimitives += scene->numPoints;
       
       pinfo.reset();
       if (numPrimitives <= single_threaded_primrefgen_threshold) 
@@ -132,18 +150,36 @@ namespace embree
 	  const UserGeometryBase* set = (const UserGeometryBase*)geom;
 	  ssize_t s = max(start-cur,ssize_t(0));
 	  ssize_t e = min(end  -cur,ssize_t(set->numItems));
-	  for (ssize_t j=s; j<e; j++) {
-	    BBox3fa bounds = empty;
-	    if (!set->valid(j,&bounds)) continue;
+	  if (s < e) set->forallValid(s,e,[&] (size_t j, const BBox3fa& bounds) {
 	    const PrimRef prim(bounds,i,j);
 	    pinfo.add(prim.bounds(),prim.center2());
-	    if (likely(block->insert(prim))) continue; 
+	    if (likely(block->insert(prim))) return; 
 	    block = prims_o.insert(alloc->malloc(threadIndex));
 	    block->insert(prim);
-	  }
+	  });
 	  cur += set->numItems;
 	  break;
 	}
+
+	  /* handle point sets */
+	case POINTS: {
+	  const Points* set = (const Points*)geom;
+	  if (numTimeSteps & 1) {
+	    ssize_t s = max(start-cur,ssize_t(0));
+	    ssize_t e = min(end  -cur,ssize_t(set->numPoints));
+	    for (ssize_t j=s; j<e; j++) {
+	      BBox3fa bounds = empty;
+	      if (!set->valid(j,&bounds)) continue;
+	      const PrimRef prim(bounds,i,j);
+	      pinfo.add(prim.bounds(),prim.center2());
+	      if (likely(block->insert(prim))) continue;
+	      block = prims_o.insert(alloc->malloc(threadIndex));
+	      block->insert(prim);
+	    }
+	    cur += set->numPoints;
+	  }
+	  break;
+	}
 	}
 	if (cur >= end) break;  
       }
@@ -182,16 +218,14 @@ namespace embree
       PrimInfo pinfo(empty);
       PrimRefList::item* block = prims_o.insert(alloc->malloc(threadIndex)); 
       
-      for (ssize_t j=start; j<end; j++) 
+      forallValid(geom,start,end,[&] (size_t j, const BBox3fa& bounds) 
       {
-	BBox3fa bounds = empty;
-	if (!geom->valid(j,&bounds)) continue;
 	const PrimRef prim(bounds,geom->id,j);
 	pinfo.add(prim.bounds(),prim.center2());
-	if (likely(block->insert(prim))) continue; 
+	if (likely(block->insert(prim))) return; 
 	block = prims_o.insert(alloc->malloc(threadIndex));
 	block->insert(prim);
-      }
+      });
       pinfo_o.atomic_extend(pinfo);
     }
     
@@ -223,6 +257,7 @@ namespace embree
       if ((ty & BEZIER_CURVES) && (numTimeSteps & 1)) numPrimitives += scene->numBezierCurves;
       if ((ty & BEZIER_CURVES) && (numTimeSteps & 2)) numPrimitives += scene->numBezierCurves2;
       if ((ty & USER_GEOMETRY)                      ) numPrimitives += scene->numUserGeometries1;
+      if ((ty & POINTS       ) && (numTimeSteps & 1)) numPrimitives += scene->numPoints;
 
       /*! parallel generation of primref array */
       if (parallel) 
@@ -338,17 +373,32 @@ namespace embree
 	  const UserGeometryBase* set = (const UserGeometryBase*)geom;
 	  ssize_t s = max(start-cur,ssize_t(0));
 	  ssize_t e = min(end  -cur,ssize_t(set->numItems));
-	  for (ssize_t j=s; j<e; j++) {
-	    BBox3fa bounds = empty;
-	    if (!set->valid(j,&bounds)) continue;
+	  if (s < e) set->forallValid(s,e,[&] (size_t j, const BBox3fa& bounds) {
 	    const PrimRef prim(bounds,i,j);
-	    if (!inFloatRange(prim.bounds())) continue;
 	    pinfo.add(prim.bounds(),prim.center2());
 	    prims_o[dest++] = prim;
-	  }
+	  });
 	  cur += set->numItems;
 	  break;
 	}
+
+	  /* handle point sets */
+	case POINTS: {
+	  const Points* set = (const Points*)geom;
+	  if (numTimeSteps & 1) {
+	    ssize_t s = max(start-cur,ssize_t(0));
+	    ssize_t e = min(end  -cur,ssize_t(set->numPoints));
+	    for (ssize_t j=s; j<e; j++) {
+	      BBox3fa bounds = empty;
+	      if (!set->valid(j,&bounds)) continue;
+	      const PrimRef prim(bounds,i,j);
+	      pinfo.add(prim.bounds(),prim.center2());
+	      prims_o[dest++] = prim;
+	    }
+	    cur += set->numPoints;
+	  }
+	  break;
+	}
 	}
 	if (cur >= end) break;  
       }
@@ -415,13 +465,11 @@ namespace embree
       ssize_t cur   = 0;
       
       PrimInfo pinfo(empty);
-      for (ssize_t j=start; j<end; j++) {
-	BBox3fa bounds = empty;
-	if (!geom->valid(j,&bounds)) continue;
+      forallValid(geom,start,end,[&] (size_t j, const BBox3fa& bounds) {
 	const PrimRef prim(bounds,geom->id,j);
 	pinfo.add(prim.bounds(),prim.center2());
 	prims_o[dest++] = prim;
-      }
+      });
       pinfo_o.atomic_extend(pinfo);
       if (dst) dst[taskIndex] = dest - dst[taskIndex];
     }
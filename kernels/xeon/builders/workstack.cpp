@@ -0,0 +1,98 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "common/default.h"
+#include "workstack.h"
+
+namespace embree
+{
+  struct work_deque_regression_test : public RegressionTest
+  {
+    static const size_t numItems = 1000000;
+    static const size_t numThieves = 3;
+
+    work_deque_regression_test(const char* name) : name(name) {
+      registerRegressionTest(this);
+    }
+
+    /* other threads steal items until the owner has finished */
+    static void thief(void* ptr) 
+    {
+      work_deque_regression_test* This = (work_deque_regression_test*) ptr;
+      while (!This->done) {
+        size_t i; 
+        if (This->deque.steal(i)) atomic_add(&This->taken[i],1);
+      }
+    }
+    
+    bool operator() ()
+    {
+      bool passed = true;
+      printf("%s::%s ... ",TOSTRING(isa),name);
+      fflush(stdout);
+
+      deque.reset();
+      taken.resize(numItems);
+      for (size_t i=0; i<numItems; i++) taken[i] = 0;
+      done = 0;
+
+      thread_t threads[numThieves];
+      for (size_t i=0; i<numThieves; i++)
+        threads[i] = createThread(thief,this);
+
+      /* the owner pushes bursts of items and pops some of them again */
+      size_t i=0;
+      while (i<numItems)
+      {
+        const size_t numPush = 1+rand()%32;
+        for (size_t j=0; j<numPush && i<numItems; j++, i++) {
+          while (!deque.push(i)) {
+            size_t k; if (deque.pop(k)) atomic_add(&taken[k],1);
+          }
+        }
+        const size_t numPop = rand()%32;
+        for (size_t j=0; j<numPop; j++) {
+          size_t k; if (deque.pop(k)) atomic_add(&taken[k],1);
+        }
+      }
+
+      /* pop fails only after the deque got empty */
+      size_t k; 
+      while (deque.pop(k)) atomic_add(&taken[k],1);
+      done = 1;
+      for (size_t i=0; i<numThieves; i++)
+        join(threads[i]);
+
+      /* each item has to be taken exactly once */
+      for (size_t i=0; i<numItems; i++)
+        passed &= taken[i] == 1;
+      passed &= deque.isEmpty();
+
+      /* output if test passed or not */
+      if (passed) printf("[passed]\n");
+      else        printf("[failed]\n");
+      
+      return passed;
+    }
+
+    const char* name;
+    WorkDeque<size_t,256> deque;
+    std::vector<atomic_t> taken;
+    volatile atomic_t done;
+  };
+
+  work_deque_regression_test work_deque_regression("work_deque_regression_test");
+}
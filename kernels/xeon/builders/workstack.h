@@ -208,18 +208,90 @@ namespace embree
     }
   };
 
+  /*! Lock-free work stealing deque. The owning thread pushes and pops
+   *  items at the bottom, other threads steal the oldest items from the
+   *  top. When used for recursive builds, the oldest items are the
+   *  largest ones. */
+  template<class T, unsigned int SIZE>
+    class WorkDeque
+  {
+    ALIGNED_CLASS;
+  public:
+
+    __forceinline WorkDeque() : top(0), bottom(0) {}
+
+    __forceinline void reset() {
+      top = bottom = 0;
+    }
+
+    __forceinline bool isEmpty() const {
+      return bottom <= top;
+    }
+
+    /*! pushes an item to the bottom, fails if the deque is full (owner only) */
+    __forceinline bool push(const T& v)
+    {
+      const atomic_t b = bottom, t = top;
+      if (b-t >= (atomic_t)SIZE) return false;
+      items[b%SIZE] = v;
+      __memory_barrier();
+      bottom = b+1;
+      return true;
+    }
+
+    /*! pops the most recent item from the bottom (owner only) */
+    __forceinline bool pop(T& v)
+    {
+      /* the exchange orders the store to bottom before the load of top */
+      const atomic_t b = bottom-1;
+      atomic_xchg(&bottom,b);
+      const atomic_t t = top;
+      if (t > b) { bottom = b+1; return false; }
+      v = items[b%SIZE];
+      if (t < b) return true;
+
+      /* for the last item we race with stealing threads */
+      const bool success = atomic_cmpxchg(&top,t,t+1) == t;
+      bottom = b+1;
+      return success;
+    }
+
+    /*! steals the oldest item from the top (any thread) */
+    __forceinline bool steal(T& v)
+    {
+      const atomic_t t = top;
+      __memory_barrier();
+      const atomic_t b = bottom;
+      if (t >= b) return false;
+
+      /* the item can only get overwritten after some other thread took it, then the exchange fails */
+      v = items[t%SIZE];
+      __memory_barrier();
+      return atomic_cmpxchg(&top,t,t+1) == t;
+    }
+
+  private:
+    volatile atomic_t top;
+    char align0[64-sizeof(atomic_t)];
+    volatile atomic_t bottom;
+    char align1[64-sizeof(atomic_t)];
+    __aligned(64) T items[SIZE];
+  };
+
+  /*! Heap of work items that gets filled by a single thread. After
+   *  sorting, any thread can take the items in order of decreasing
+   *  size without locking. */
   template<class T>
     class WorkHeap 
   {
     ALIGNED_CLASS;
   public:
 
-    WorkHeap() {
-      mutex.reset();
-    }
+    WorkHeap() : next(0) {}
 
     void reset() {
       heap.clear();
+      next = 0;
     }
 
     size_t size() const { 
@@ -230,28 +302,48 @@ namespace embree
     T* begin() { return &heap[0]; }
     T* end  () { return &heap[0]+heap.size(); }
 
+    /*! adds an item (single thread only) */
     void push(T& br)
     {
       heap.push_back(br);
       std::push_heap(heap.begin(),heap.end());
     }
 
+    /*! removes the largest item (single thread only) */
     bool pop(T& br)
     {
-      mutex.lock();
-      if  (heap.size() == 0) {
-	mutex.unlock();
+      if  (heap.size() == 0) 
 	return false;
-      }
       br = heap.front();
       std::pop_heap(heap.begin(),heap.end());
       heap.pop_back();
-      mutex.unlock();
+      return true;
+    }
+
+    /*! sorts the items by decreasing size for taking them */
+    void sort() 
+    {
+      std::sort(heap.begin(),heap.end(),[] (const T& a, const T& b) { return a > b; });
+      next = 0;
+    }
+
+    /*! checks if all items got taken (any thread) */
+    bool isEmpty() const {
+      return size_t(next) >= heap.size();
+    }
+
+    /*! takes the largest remaining item of the sorted heap (any thread) */
+    bool take(T& br)
+    {
+      if (size_t(next) >= heap.size()) return false;
+      const size_t i = atomic_add(&next,1);
+      if (i >= heap.size()) return false;
+      br = heap[i];
       return true;
     }
     
   private:
-    AlignedAtomicMutex __aligned(64) mutex;
+    __aligned(64) volatile atomic_t next; //!< next item to take
     vector_t<T> heap;
   };
 }
@@ -27,7 +27,10 @@
 #include "geometry/triangle4i.h"
 #include "geometry/subdivpatch1.h"
 #include "geometry/subdivpatch1cached.h"
+#include "geometry/grid.h"
 #include "geometry/virtual_accel.h"
+#include "geometry/sphere4.h"
+#include "geometry/sphere8.h"
 
 #include "common/accelinstance.h"
 
@@ -50,7 +53,10 @@ namespace embree
   DECLARE_SYMBOL(Accel::Intersector1,BVH4Subdivpatch1CachedIntersector1);
   DECLARE_SYMBOL(Accel::Intersector1,BVH4GridIntersector1);
   DECLARE_SYMBOL(Accel::Intersector1,BVH4GridLazyIntersector1);
+  DECLARE_SYMBOL(Accel::Intersector1,BVH4GridMBIntersector1);
   DECLARE_SYMBOL(Accel::Intersector1,BVH4VirtualIntersector1);
+  DECLARE_SYMBOL(Accel::Intersector1,BVH4Sphere4Intersector1);
+  DECLARE_SYMBOL(Accel::Intersector1,BVH4Sphere8Intersector1);
 
   DECLARE_SYMBOL(Accel::Intersector4,BVH4Bezier1vIntersector4Chunk);
   DECLARE_SYMBOL(Accel::Intersector4,BVH4Bezier1iIntersector4Chunk);
@@ -76,7 +82,10 @@ namespace embree
   DECLARE_SYMBOL(Accel::Intersector4,BVH4Subdivpatch1CachedIntersector4);
   DECLARE_SYMBOL(Accel::Intersector4,BVH4GridIntersector4);
   DECLARE_SYMBOL(Accel::Intersector4,BVH4GridLazyIntersector4);
+  DECLARE_SYMBOL(Accel::Intersector4,BVH4GridMBIntersector4);
   DECLARE_SYMBOL(Accel::Intersector4,BVH4VirtualIntersector4Chunk);
+  DECLARE_SYMBOL(Accel::Intersector4,BVH4Sphere4Intersector4Chunk);
+  DECLARE_SYMBOL(Accel::Intersector4,BVH4Sphere8Intersector4Chunk);
   
   DECLARE_SYMBOL(Accel::Intersector8,BVH4Bezier1vIntersector8Chunk);
   DECLARE_SYMBOL(Accel::Intersector8,BVH4Bezier1iIntersector8Chunk);
@@ -102,7 +111,10 @@ namespace embree
   DECLARE_SYMBOL(Accel::Intersector8,BVH4Subdivpatch1CachedIntersector8);
   DECLARE_SYMBOL(Accel::Intersector8,BVH4GridIntersector8);
   DECLARE_SYMBOL(Accel::Intersector8,BVH4GridLazyIntersector8);
+  DECLARE_SYMBOL(Accel::Intersector8,BVH4GridMBIntersector8);
   DECLARE_SYMBOL(Accel::Intersector8,BVH4VirtualIntersector8Chunk);
+  DECLARE_SYMBOL(Accel::Intersector8,BVH4Sphere4Intersector8Chunk);
+  DECLARE_SYMBOL(Accel::Intersector8,BVH4Sphere8Intersector8Chunk);
 
   DECLARE_TOPLEVEL_BUILDER(BVH4BuilderTopLevelFast);
 
@@ -137,8 +149,11 @@ namespace embree
   DECLARE_SCENE_BUILDER(BVH4SubdivPatch1CachedBuilderFast);
   DECLARE_SCENE_BUILDER(BVH4SubdivGridBuilderFast);
   DECLARE_SCENE_BUILDER(BVH4SubdivGridEagerBuilderFast);
+  DECLARE_SCENE_BUILDER(BVH4SubdivGridEagerMBBuilderFast);
   DECLARE_SCENE_BUILDER(BVH4SubdivGridLazyBuilderFast);
   DECLARE_SCENE_BUILDER(BVH4UserGeometryBuilderFast);
+  DECLARE_SCENE_BUILDER(BVH4Sphere4BuilderFast);
+  DECLARE_SCENE_BUILDER(BVH4Sphere8BuilderFast);
 
   DECLARE_TRIANGLEMESH_BUILDER(BVH4Triangle1MeshBuilderFast);
   DECLARE_TRIANGLEMESH_BUILDER(BVH4Triangle4MeshBuilderFast);
@@ -204,6 +219,8 @@ namespace embree
     SELECT_SYMBOL_DEFAULT_AVX(features,BVH4Triangle4vBuilderFast);
     SELECT_SYMBOL_DEFAULT_AVX(features,BVH4Triangle4iBuilderFast);
     SELECT_SYMBOL_DEFAULT_AVX(features,BVH4UserGeometryBuilderFast);
+    SELECT_SYMBOL_DEFAULT_AVX(features,BVH4Sphere4BuilderFast);
+    SELECT_SYMBOL_AVX        (features,BVH4Sphere8BuilderFast);
     
     SELECT_SYMBOL_DEFAULT_AVX(features,BVH4Triangle1MeshBuilderFast);
     SELECT_SYMBOL_DEFAULT_AVX(features,BVH4Triangle4MeshBuilderFast);
@@ -215,6 +232,7 @@ namespace embree
     SELECT_SYMBOL_DEFAULT_AVX(features,BVH4SubdivPatch1CachedBuilderFast);
     SELECT_SYMBOL_DEFAULT_AVX(features,BVH4SubdivGridBuilderFast);
     SELECT_SYMBOL_DEFAULT_AVX(features,BVH4SubdivGridEagerBuilderFast);
+    SELECT_SYMBOL_DEFAULT_AVX(features,BVH4SubdivGridEagerMBBuilderFast);
     SELECT_SYMBOL_DEFAULT_AVX(features,BVH4SubdivGridLazyBuilderFast);
     SELECT_SYMBOL_DEFAULT_AVX(features,BVH4UserGeometryMeshBuilderFast);
 
@@ -257,7 +275,10 @@ namespace embree
     SELECT_SYMBOL_DEFAULT_SSE41_AVX_AVX2(features,BVH4Subdivpatch1CachedIntersector1);
     SELECT_SYMBOL_DEFAULT_SSE41_AVX_AVX2(features,BVH4GridIntersector1);
     SELECT_SYMBOL_DEFAULT_SSE41_AVX_AVX2(features,BVH4GridLazyIntersector1);
+    SELECT_SYMBOL_DEFAULT_SSE41_AVX_AVX2(features,BVH4GridMBIntersector1);
     SELECT_SYMBOL_DEFAULT_SSE41_AVX_AVX2(features,BVH4VirtualIntersector1);
+    SELECT_SYMBOL_DEFAULT_SSE41_AVX_AVX2(features,BVH4Sphere4Intersector1);
+    SELECT_SYMBOL_AVX_AVX2              (features,BVH4Sphere8Intersector1);
 
     /* select intersectors4 */
     SELECT_SYMBOL_DEFAULT_AVX_AVX2      (features,BVH4Bezier1vIntersector4Chunk);
@@ -287,7 +308,10 @@ namespace embree
     SELECT_SYMBOL_DEFAULT_AVX_AVX2      (features,BVH4Subdivpatch1CachedIntersector4);
     SELECT_SYMBOL_DEFAULT_AVX_AVX2      (features,BVH4GridIntersector4);
     SELECT_SYMBOL_DEFAULT_AVX_AVX2      (features,BVH4GridLazyIntersector4);
+    SELECT_SYMBOL_DEFAULT_AVX_AVX2      (features,BVH4GridMBIntersector4);
     SELECT_SYMBOL_DEFAULT_SSE41_AVX_AVX2(features,BVH4VirtualIntersector4Chunk);
+    SELECT_SYMBOL_DEFAULT_SSE41_AVX_AVX2(features,BVH4Sphere4Intersector4Chunk);
+    SELECT_SYMBOL_AVX_AVX2              (features,BVH4Sphere8Intersector4Chunk);
    
     /* select intersectors8 */
     SELECT_SYMBOL_AVX_AVX2(features,BVH4Bezier1vIntersector8Chunk);
@@ -314,7 +338,10 @@ namespace embree
     SELECT_SYMBOL_AVX_AVX2(features,BVH4Subdivpatch1CachedIntersector8);
     SELECT_SYMBOL_AVX_AVX2(features,BVH4GridIntersector8);
     SELECT_SYMBOL_AVX_AVX2(features,BVH4GridLazyIntersector8);
+    SELECT_SYMBOL_AVX_AVX2(features,BVH4GridMBIntersector8);
     SELECT_SYMBOL_AVX_AVX2(features,BVH4VirtualIntersector8Chunk);
+    SELECT_SYMBOL_AVX_AVX2(features,BVH4Sphere4Intersector8Chunk);
+    SELECT_SYMBOL_AVX_AVX2(features,BVH4Sphere8Intersector8Chunk);
   }
 
   BVH4::BVH4 (const PrimitiveType& primTy, Scene* scene, bool listMode)
@@ -972,7 +999,7 @@ namespace embree
 
   Accel* BVH4::BVH4SubdivGrid(Scene* scene)
   {
-    BVH4* accel = new BVH4(PrimitiveType2::type,scene,LeafMode); // FIXME: type
+    BVH4* accel = new BVH4(Grid::type,scene,LeafMode);
     Accel::Intersectors intersectors;
     intersectors.ptr = accel; 
     intersectors.intersector1 = BVH4GridIntersector1;
@@ -985,7 +1012,7 @@ namespace embree
 
   Accel* BVH4::BVH4SubdivGridEager(Scene* scene)
   {
-    BVH4* accel = new BVH4(PrimitiveType2::type,scene,LeafMode); // FIXME: type
+    BVH4* accel = new BVH4(Grid::type,scene,LeafMode);
     Accel::Intersectors intersectors;
     intersectors.ptr = accel; 
     intersectors.intersector1 = BVH4GridIntersector1;
@@ -996,9 +1023,22 @@ namespace embree
     return new AccelInstance(accel,builder,intersectors);
   }
 
+  Accel* BVH4::BVH4SubdivGridEagerMB(Scene* scene)
+  {
+    BVH4* accel = new BVH4(Grid::type,scene,LeafMode);
+    Accel::Intersectors intersectors;
+    intersectors.ptr = accel; 
+    intersectors.intersector1 = BVH4GridMBIntersector1;
+    intersectors.intersector4 = BVH4GridMBIntersector4;
+    intersectors.intersector8 = BVH4GridMBIntersector8;
+    intersectors.intersector16 = NULL;
+    Builder* builder = BVH4SubdivGridEagerMBBuilderFast(accel,scene,LeafMode);
+    return new AccelInstance(accel,builder,intersectors);
+  }
+
   Accel* BVH4::BVH4SubdivGridLazy(Scene* scene)
   {
-    BVH4* accel = new BVH4(PrimitiveType2::type,scene,LeafMode); // FIXME: type
+    BVH4* accel = new BVH4(Grid::type,scene,LeafMode);
     Accel::Intersectors intersectors;
     intersectors.ptr = accel; 
     intersectors.intersector1 = BVH4GridLazyIntersector1;
@@ -1022,6 +1062,34 @@ namespace embree
     return new AccelInstance(accel,builder,intersectors);
   }
 
+  Accel* BVH4::BVH4Sphere4(Scene* scene)
+  {
+    BVH4* accel = new BVH4(Sphere4Type::type,scene,LeafMode);
+    Accel::Intersectors intersectors;
+    intersectors.ptr = accel; 
+    intersectors.intersector1 = BVH4Sphere4Intersector1;
+    intersectors.intersector4 = BVH4Sphere4Intersector4Chunk;
+    intersectors.intersector8 = BVH4Sphere4Intersector8Chunk;
+    intersectors.intersector16 = NULL;
+    Builder* builder = BVH4Sphere4BuilderFast(accel,scene,LeafMode);
+    return new AccelInstance(accel,builder,intersectors);
+  }
+
+#if defined (__TARGET_AVX__)
+  Accel* BVH4::BVH4Sphere8(Scene* scene)
+  {
+    BVH4* accel = new BVH4(Sphere8Type::type,scene,LeafMode);
+    Accel::Intersectors intersectors;
+    intersectors.ptr = accel; 
+    intersectors.intersector1 = BVH4Sphere8Intersector1;
+    intersectors.intersector4 = BVH4Sphere8Intersector4Chunk;
+    intersectors.intersector8 = BVH4Sphere8Intersector8Chunk;
+    intersectors.intersector16 = NULL;
+    Builder* builder = BVH4Sphere8BuilderFast(accel,scene,LeafMode);
+    return new AccelInstance(accel,builder,intersectors);
+  }
+#endif
+
   Accel* BVH4::BVH4Triangle1ObjectSplit(TriangleMesh* mesh)
   {
     BVH4* accel = new BVH4(TriangleMeshTriangle1::type,mesh->parent,LeafMode);
@@ -1217,8 +1217,11 @@ namespace embree
     static Accel* BVH4SubdivPatch1Cached(Scene* scene);
     static Accel* BVH4SubdivGrid(Scene* scene);
     static Accel* BVH4SubdivGridEager(Scene* scene);
+    static Accel* BVH4SubdivGridEagerMB(Scene* scene);
     static Accel* BVH4SubdivGridLazy(Scene* scene);
     static Accel* BVH4UserGeometry(Scene* scene);
+    static Accel* BVH4Sphere4(Scene* scene);
+    static Accel* BVH4Sphere8(Scene* scene);
     
     static Accel* BVH4BVH4Triangle1Morton(Scene* scene);
     static Accel* BVH4BVH4Triangle1ObjectSplit(Scene* scene);
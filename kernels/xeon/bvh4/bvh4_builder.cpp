@@ -422,6 +422,7 @@ namespace embree
       bvh->bounds = pinfo.geomBounds;
       
       /* free all temporary memory blocks */
+      alloc.clear();
       Alloc::global.clear();
       //TaskScheduler::enableThreads(threadCountOld); // FIXME: enable
       
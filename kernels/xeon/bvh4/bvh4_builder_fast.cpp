@@ -29,6 +29,8 @@
 #include "geometry/triangle4v.h"
 #include "geometry/triangle4i.h"
 #include "geometry/subdivpatch1.h"
+#include "geometry/sphere4.h"
+#include "geometry/sphere8.h"
 
 #include "geometry/grid.h"
 #include "common/subdiv/feature_adaptive_gregory.h"
@@ -50,11 +52,12 @@ namespace embree
 
     static const size_t THRESHOLD_FOR_SUBTREE_RECURSION = 128;
     static const size_t THRESHOLD_FOR_SINGLE_THREADED = 50000; // FIXME: measure if this is really optimal, maybe disable only parallel splits
+    static const size_t THRESHOLD_FOR_PARALLEL_PARTITION = 64*1024;
 
     BVH4BuilderFast::BVH4BuilderFast (LockStepTaskScheduler* scheduler, BVH4* bvh, size_t listMode, size_t logBlockSize, size_t logSAHBlockSize, 
 				      bool needVertices, size_t primBytes, const size_t minLeafSize, const size_t maxLeafSize)
       : scheduler(scheduler), state(nullptr), bvh(bvh), numPrimitives(0), prims(NULL), bytesPrims(0), listMode(listMode), logBlockSize(logBlockSize), logSAHBlockSize(logSAHBlockSize), 
-	needVertices(needVertices), primBytes(primBytes), minLeafSize(minLeafSize), maxLeafSize(maxLeafSize) { needAllThreads = true; }
+	needVertices(needVertices), primBytes(primBytes), minLeafSize(minLeafSize), maxLeafSize(maxLeafSize), motionBlur(false) { needAllThreads = true; }
 
     template<typename Primitive>
     BVH4BuilderFastT<Primitive>::BVH4BuilderFastT (BVH4* bvh, Scene* scene, size_t listMode, size_t logBlockSize, size_t logSAHBlockSize, 
@@ -81,6 +84,12 @@ namespace embree
       : geom(NULL), BVH4BuilderFastT<Triangle4i>(bvh,scene,listMode,2,2,true,sizeof(Triangle4i),4,inf,true) {}
     template<> BVH4UserGeometryBuilderFastT<AccelSetItem>::BVH4UserGeometryBuilderFastT (BVH4* bvh, Scene* scene, size_t listMode) 
       : geom(NULL), BVH4BuilderFastT<AccelSetItem>(bvh,scene,listMode,0,0,false,sizeof(AccelSetItem),1,1,true) {}
+    template<> BVH4PointsBuilderFast<Sphere4>::BVH4PointsBuilderFast (BVH4* bvh, Scene* scene, size_t listMode) 
+      : BVH4BuilderFastT<Sphere4>(bvh,scene,listMode,2,2,false,sizeof(Sphere4),4,inf,true) {}
+#if defined(__AVX__)
+    template<> BVH4PointsBuilderFast<Sphere8>::BVH4PointsBuilderFast (BVH4* bvh, Scene* scene, size_t listMode) 
+      : BVH4BuilderFastT<Sphere8>(bvh,scene,listMode,3,2,false,sizeof(Sphere8),8,inf,true) {}
+#endif
 
     template<> BVH4BezierBuilderFast  <Bezier1v>   ::BVH4BezierBuilderFast   (BVH4* bvh, BezierCurves* geom, size_t listMode) 
       : geom(geom), BVH4BuilderFastT<Bezier1v>   (bvh,geom->parent,listMode,0,0,false,sizeof(Bezier1v)   ,1,1,geom->size() > THRESHOLD_FOR_SINGLE_THREADED) {}
@@ -110,7 +119,7 @@ namespace embree
       : geom(geom), BVH4BuilderFastT<SubdivPatch1>(bvh,geom->parent,listMode,0,0,false,sizeof(SubdivPatch1),1,1,geom->size() > THRESHOLD_FOR_SINGLE_THREADED) {}
 
     BVH4SubdivPatch1CachedBuilderFast::BVH4SubdivPatch1CachedBuilderFast (BVH4* bvh, Scene* scene, size_t listMode) 
-      : BVH4BuilderFastT<PrimRef>(bvh,scene,listMode,0,0,false,32,1,1,true),fastUpdateMode(false),fastUpdateMode_numFaces(0)
+      : BVH4BuilderFastT<PrimRef>(bvh,scene,listMode,0,0,false,32,1,1,true),fastUpdateMode(false),fastUpdateMode_numFaces(0),refitMode(false)
     { 
       //this->bvh->alloc2.init(4096,4096); 
     
@@ -138,7 +147,7 @@ namespace embree
 
       /* initialize BVH */
       if (numPrimitivesOld != numPrimitives)
-        bvh->init(sizeof(BVH4::Node),numPrimitives, parallel ? (threadCount+1) : 1); // threadCount+1 for toplevel build
+        bvh->init(motionBlur ? sizeof(BVH4::NodeMB) : sizeof(BVH4::Node),numPrimitives, parallel ? (threadCount+1) : 1); // threadCount+1 for toplevel build
 
       /* skip build for empty scene */
       if (numPrimitives == 0) 
@@ -217,6 +226,25 @@ namespace embree
     // =======================================================================================================
     // =======================================================================================================
 
+    template<typename Primitive>
+    size_t BVH4PointsBuilderFast<Primitive>::number_of_primitives() {
+      return this->scene->numPoints;
+    }
+    
+    template<typename Primitive>
+    void BVH4PointsBuilderFast<Primitive>::create_primitive_array_sequential(size_t threadIndex, size_t threadCount, PrimInfo& pinfo) {
+      PrimRefArrayGen::generate_sequential(threadIndex, threadCount, this->scene, POINTS, 1, this->prims, pinfo);
+    }
+
+    template<typename Primitive>
+    void BVH4PointsBuilderFast<Primitive>::create_primitive_array_parallel  (size_t threadIndex, size_t threadCount, LockStepTaskScheduler* scheduler, PrimInfo& pinfo) {
+      PrimRefArrayGen::generate_parallel(threadIndex, threadCount, scheduler, this->scene, POINTS, 1, this->prims, pinfo);
+    }
+    
+    // =======================================================================================================
+    // =======================================================================================================
+    // =======================================================================================================
+
     template<typename Primitive>
     size_t BVH4TriangleBuilderFast<Primitive>::number_of_primitives() 
     {
@@ -242,6 +270,24 @@ namespace embree
     // =======================================================================================================
     // =======================================================================================================
 
+    template<typename Primitive>
+    void BVH4UserGeometryBuilderFastT<Primitive>::build(size_t threadIndex, size_t threadCount) 
+    {
+      /* only the stream callbacks benefit from leaves with multiple items */
+      bool stream = false;
+      if (geom) stream = geom->hasIntersectN();
+      else {
+        for (size_t i=0; i<this->scene->size(); i++) {
+          Geometry* g = this->scene->get(i);
+          if (g == NULL || !g->isEnabled() || g->type != USER_GEOMETRY) continue;
+          stream |= ((UserGeometryBase*)g)->hasIntersectN();
+        }
+      }
+      if (stream) { this->minLeafSize = 4; this->maxLeafSize = inf; }
+      else        { this->minLeafSize = 1; this->maxLeafSize = 1;   }
+      BVH4BuilderFast::build(threadIndex,threadCount);
+    }
+
     template<typename Primitive>
     size_t BVH4UserGeometryBuilderFastT<Primitive>::number_of_primitives() 
     {
@@ -506,6 +552,132 @@ namespace embree
     // =======================================================================================================
     // =======================================================================================================
 
+    BVH4SubdivGridEagerMBBuilderFast::BVH4SubdivGridEagerMBBuilderFast (BVH4* bvh, Scene* scene, size_t listMode) 
+      : BVH4BuilderFastT<PrimRef>(bvh,scene,listMode,0,0,false,0,1,1,true) { this->bvh->alloc2.init(4096,4096); this->motionBlur = true; } 
+
+    void BVH4SubdivGridEagerMBBuilderFast::build(size_t threadIndex, size_t threadCount)
+    {
+      /* initialize all half edge structures */
+      new (&iter) Scene::Iterator<SubdivMesh,true>(this->scene);
+      for (size_t i=0; i<iter.size(); i++)
+	if (iter[i]) iter[i]->initializeHalfEdgeStructures();
+
+      /* initialize allocator and parallel_for_for_prefix_sum */
+      this->bvh->alloc2.reset();
+      pstate.init(iter,size_t(1024));
+
+      BVH4BuilderFast::build(threadIndex,threadCount);
+
+      /* the builder only knows the merged bounds of both time steps */
+      if (numPrimitives) refit(bvh->root);
+    }
+
+    std::pair<BBox3fa,BBox3fa> BVH4SubdivGridEagerMBBuilderFast::refit(NodeRef ref)
+    {
+      if (ref == BVH4::emptyNode)
+	return std::pair<BBox3fa,BBox3fa>(empty,empty);
+
+      if (ref.isLeaf()) {
+	size_t ty; Grid::EagerLeafMB* leaf = (Grid::EagerLeafMB*) ref.leaf(ty);
+	return std::pair<BBox3fa,BBox3fa>(leaf->bounds0,leaf->bounds1);
+      }
+
+      NodeMB* node = ref.nodeMB();
+      BBox3fa bounds0 = empty, bounds1 = empty;
+      for (size_t i=0; i<BVH4::N; i++) {
+	const std::pair<BBox3fa,BBox3fa> bounds = refit(node->child(i));
+	node->set(i,bounds.first,bounds.second);
+	bounds0.extend(bounds.first);
+	bounds1.extend(bounds.second);
+      }
+      return std::pair<BBox3fa,BBox3fa>(bounds0,bounds1);
+    }
+
+    size_t BVH4SubdivGridEagerMBBuilderFast::number_of_primitives() 
+    {
+      PrimInfo pinfo = parallel_for_for_prefix_sum( pstate, iter, PrimInfo(empty), [&](SubdivMesh* mesh, const range<size_t>& r, size_t k, const PrimInfo& base) -> PrimInfo
+      {
+        size_t s = 0;
+        for (size_t f=r.begin(); f!=r.end(); ++f) 
+	{
+          if (!mesh->valid(f)) continue;
+	  
+	  feature_adaptive_subdivision_eval(mesh->getHalfEdge(f),mesh->getVertexBuffer(0),
+					    [&](const CatmullClarkPatch& patch, const Vec2f uv[4], const int subdiv[4], const int id)
+	  {
+ 	    const float l0 = patch.ring[0].edge_level;
+	    const float l1 = patch.ring[1].edge_level;
+	    const float l2 = patch.ring[2].edge_level;
+	    const float l3 = patch.ring[3].edge_level;
+	    const DiscreteTessellationPattern pattern0(l0,subdiv[0]);
+	    const DiscreteTessellationPattern pattern1(l1,subdiv[1]);
+	    const DiscreteTessellationPattern pattern2(l2,subdiv[2]);
+	    const DiscreteTessellationPattern pattern3(l3,subdiv[3]);
+	    const DiscreteTessellationPattern pattern_x = pattern0.size() > pattern2.size() ? pattern0 : pattern2;
+	    const DiscreteTessellationPattern pattern_y = pattern1.size() > pattern3.size() ? pattern1 : pattern3;
+	    s += Grid::getNumEagerLeaves(pattern_x.size(),pattern_y.size());
+	  });
+	}
+        return PrimInfo(s,empty,empty);
+      }, [](const PrimInfo& a, const PrimInfo& b) -> PrimInfo { return PrimInfo(a.size()+b.size(),empty,empty); });
+
+      return pinfo.size();
+    }
+    
+    void BVH4SubdivGridEagerMBBuilderFast::create_primitive_array_sequential(size_t threadIndex, size_t threadCount, PrimInfo& pinfo)
+    {
+      pinfo = parallel_for_for_prefix_sum( pstate, iter, PrimInfo(empty), [&](SubdivMesh* mesh, const range<size_t>& r, size_t k, const PrimInfo& base) -> PrimInfo
+      {
+	FastAllocator::Thread& alloc = *bvh->alloc2.instance();
+	std::vector<CatmullClarkPatch> patches1;
+
+	PrimInfo s(empty);
+        for (size_t f=r.begin(); f!=r.end(); ++f) {
+          if (!mesh->valid(f)) continue;
+
+	  /* the sub-patches of both time steps are generated in the same order as they only depend on the topology */
+	  patches1.clear();
+	  feature_adaptive_subdivision_eval(mesh->getHalfEdge(f),mesh->getVertexBuffer(1),
+					    [&](const CatmullClarkPatch& patch, const Vec2f uv[4], const int subdiv[4], const int id) {
+					      patches1.push_back(patch);
+					    });
+	  
+	  size_t i1 = 0;
+	  feature_adaptive_subdivision_eval(mesh->getHalfEdge(f),mesh->getVertexBuffer(0),
+					    [&](const CatmullClarkPatch& patch, const Vec2f uv[4], const int subdiv[4], const int id)
+	  {
+	    const float l0 = patch.ring[0].edge_level;
+	    const float l1 = patch.ring[1].edge_level;
+	    const float l2 = patch.ring[2].edge_level;
+	    const float l3 = patch.ring[3].edge_level;
+	    const DiscreteTessellationPattern pattern0(l0,subdiv[0]);
+	    const DiscreteTessellationPattern pattern1(l1,subdiv[1]);
+	    const DiscreteTessellationPattern pattern2(l2,subdiv[2]);
+	    const DiscreteTessellationPattern pattern3(l3,subdiv[3]);
+	    const DiscreteTessellationPattern pattern_x = pattern0.size() > pattern2.size() ? pattern0 : pattern2;
+	    const DiscreteTessellationPattern pattern_y = pattern1.size() > pattern3.size() ? pattern1 : pattern3;
+	    const int nx = pattern_x.size();
+	    const int ny = pattern_y.size();
+	    assert(i1 < patches1.size());
+	    const CatmullClarkPatch& patch1 = patches1[i1++];
+	    size_t N = Grid::createEagerMB(mesh->id,f,scene,patch,patch1,alloc,&prims[base.size()+s.size()],0,nx,0,ny,uv,pattern0,pattern1,pattern2,pattern3,pattern_x,pattern_y);
+	    assert(N == Grid::getNumEagerLeaves(nx,ny));
+	    for (size_t i=0; i<N; i++)
+	      s.add(prims[base.size()+s.size()].bounds());
+	  });
+        }
+        return s;
+      }, [](const PrimInfo& a, const PrimInfo& b) -> PrimInfo { return PrimInfo::merge(a,b); });
+    }
+    
+    void BVH4SubdivGridEagerMBBuilderFast::create_primitive_array_parallel  (size_t threadIndex, size_t threadCount, LockStepTaskScheduler* scheduler, PrimInfo& pinfo) {
+      create_primitive_array_sequential(threadIndex, threadCount, pinfo);  // FIXME: parallelize
+    }
+
+    // =======================================================================================================
+    // =======================================================================================================
+    // =======================================================================================================
+
     BVH4SubdivGridLazyBuilderFast::BVH4SubdivGridLazyBuilderFast (BVH4* bvh, Scene* scene, size_t listMode) 
       : BVH4BuilderFastT<Grid::LazyLeaf*>(bvh,scene,listMode,0,0,false,0,1,1,true) { this->bvh->alloc2.init(4096,4096); } 
 
@@ -516,7 +688,6 @@ namespace embree
       BVH4::NodeRef node = prims[current.begin].ID();
       size_t ty = 0;
       Grid::LazyLeaf* leaf = (Grid::LazyLeaf*) node.leaf(ty);
-      leaf->parent = current.parent;
       *current.parent = node;
       assert(ty == 1);
     }
@@ -591,7 +762,7 @@ namespace embree
 	    const DiscreteTessellationPattern pattern_y = pattern1.size() > pattern3.size() ? pattern1 : pattern3;
 	    const int nx = pattern_x.size();
 	    const int ny = pattern_y.size();
-	    size_t N = Grid::createLazy(bvh,NULL,mesh->id,f,id,nx,ny,alloc,&prims[base.size()+s.size()]);
+	    size_t N = Grid::createLazy(bvh,mesh->id,f,id,nx,ny,alloc,&prims[base.size()+s.size()]);
 	    assert(N == Grid::getNumLazyLeaves(nx,ny));
 	    for (size_t i=0; i<N; i++)
 	      s.add(prims[base.size()+s.size()].bounds());
@@ -611,10 +782,46 @@ namespace embree
 
 #define DBG_CACHE_BUILDER(x) 
 
+    /*! calls func for each patch the cached subdivision builder creates for some face */
+    template<typename Func>
+    static __forceinline void createSubdivPatches(const SubdivMesh* mesh, const size_t f, const Func& func)
+    {
+      /* regular faces directly use their precomputed B-spline control points */
+      const Vec3fa* controlPoints = mesh->getRegularPatch(f);
+      if (likely(controlPoints != NULL))
+      {
+        const SubdivMesh::HalfEdge* h = mesh->getHalfEdge(f);
+        const Vec2f uv[4] = { Vec2f(0.0f,0.0f), Vec2f(0.0f,1.0f), Vec2f(1.0f,1.0f), Vec2f(1.0f,0.0f) };
+        float edge_level[4];
+        for (size_t i=0; i<4; i++, h=h->next())
+          edge_level[i] = adjustDiscreteTessellationLevel(h->edge_level,!h->opposite()->isGregoryFace());
+        
+        func(SubdivPatch1Cached(controlPoints, mesh->id, f, mesh, uv, edge_level));
+        return;
+      }
+      
+      feature_adaptive_subdivision_gregory(f,mesh->getHalfEdge(f),mesh->getVertexBuffer(),
+                                           [&](const CatmullClarkPatch& ipatch, const Vec2f uv[4], const int subdiv[4])
+      {
+        float edge_level[4] = {
+          ipatch.ring[0].edge_level,
+          ipatch.ring[1].edge_level,
+          ipatch.ring[2].edge_level,
+          ipatch.ring[3].edge_level
+        };
+        
+        for (size_t i=0;i<4;i++)
+          edge_level[i] = adjustDiscreteTessellationLevel(edge_level[i],subdiv[i]);
+        
+        func(SubdivPatch1Cached(ipatch, mesh->id, f, mesh, uv, edge_level));
+      });
+    }
+
     void BVH4SubdivPatch1CachedBuilderFast::build(size_t threadIndex, size_t threadCount)
     {
       fastUpdateMode = true;
       fastUpdateMode_numFaces = 0;
+      refitMode = true;
 
       /* initialize all half edge structures */
       new (&iter) Scene::Iterator<SubdivMesh>(this->scene);
@@ -622,8 +829,10 @@ namespace embree
         if (iter[i]) 
           {
             iter[i]->initializeHalfEdgeStructures();
+            iter[i]->updateRegularPatches();
             fastUpdateMode_numFaces += iter[i]->size();
             if (!iter[i]->checkLevelUpdate()) fastUpdateMode = false;
+            if (!iter[i]->checkVertexUpdate()) refitMode = false;
           }
       DBG_CACHE_BUILDER( DBG_PRINT( fastUpdateMode_numFaces ) );
 
@@ -637,11 +846,17 @@ namespace embree
           bvh->root          == BVH4::emptyNode)
         fastUpdateMode = false;
 
+      /* the patches can only get refitted if they got created from the same meshes */
+      std::vector<SubdivMesh*> meshes(iter.size());
+      for (size_t i=0; i<iter.size(); i++) meshes[i] = iter[i];
+      if (bvh->numPrimitives == 0 || bvh->root == BVH4::emptyNode || meshes != refitMeshes || fastUpdateMode)
+        refitMode = false;
+      refitMeshes.swap(meshes);
+
       //fastUpdateMode = false;
 
-      /* force sequential code path for fast update */
-      if (fastUpdateMode)
-        needAllThreads = false;
+      /* force sequential code path for fast update and refit */
+      needAllThreads = !(fastUpdateMode || refitMode);
 
       BVH4BuilderFast::build(threadIndex,threadCount);
     }
@@ -651,12 +866,18 @@ namespace embree
       /* in fast update mode we know the number of primitives in advance */
       if (fastUpdateMode) return fastUpdateMode_numFaces;
 
+      /* refitting keeps all patches */
+      if (refitMode) return bvh->numPrimitives;
+
       PrimInfo pinfo = parallel_for_for_prefix_sum( pstate, iter, PrimInfo(empty), [&](SubdivMesh* mesh, const range<size_t>& r, size_t k, const PrimInfo& base) -> PrimInfo
       {
         size_t s = 0;
         for (size_t f=r.begin(); f!=r.end(); ++f) 
         {          
           if (!mesh->valid(f)) continue;
+
+          /* regular faces always create a single patch */
+          if (mesh->getRegularPatch(f)) { s++; continue; }
           
           feature_adaptive_subdivision_gregory(f,mesh->getHalfEdge(f),mesh->getVertexBuffer(),
                                                [&](const CatmullClarkPatch& patch, const Vec2f uv[4], const int subdiv[4])
@@ -706,22 +927,11 @@ namespace embree
 
 	  if (unlikely(fastUpdateMode == false))
           {
-            feature_adaptive_subdivision_gregory(f,mesh->getHalfEdge(f),mesh->getVertexBuffer(),
-                                                 [&](const CatmullClarkPatch& ipatch, const Vec2f uv[4], const int subdiv[4])
+            createSubdivPatches(mesh,f,[&](const SubdivPatch1Cached& patch)
             {
-              float edge_level[4] = {
-                ipatch.ring[0].edge_level,
-                ipatch.ring[1].edge_level,
-                ipatch.ring[2].edge_level,
-                ipatch.ring[3].edge_level
-              };
-              
-              for (size_t i=0;i<4;i++)
-                edge_level[i] = adjustDiscreteTessellationLevel(edge_level[i],subdiv[i]);
-              
               const unsigned int patchIndex = base.size()+s.size();
               assert(patchIndex < numPrimitives);
-              subdiv_patches[patchIndex] = SubdivPatch1Cached(ipatch, mesh->id, f, mesh, uv, edge_level);
+              subdiv_patches[patchIndex] = patch;
               
               /* compute patch bounds */
               const BBox3fa bounds = subdiv_patches[patchIndex].bounds(mesh);
@@ -780,9 +990,89 @@ namespace embree
       *current.parent = bvh->encodeLeaf((char*)&subdiv_patches[patchIndex],1);
     }
 
+    void BVH4SubdivPatch1CachedBuilderFast::update_patches()
+    {
+      SubdivPatch1Cached *const subdiv_patches = (SubdivPatch1Cached *)this->bvh->data_mem;
+
+      /* patches of a face are stored consecutively, find the first patch of each face */
+      std::vector<unsigned char> firstPatch(numPrimitives);
+      parallel_for( size_t(0), numPrimitives, size_t(4096), [&](const range<size_t>& r) 
+      {
+        for (size_t i=r.begin(); i<r.end(); i++) 
+          firstPatch[i] = i == 0 || subdiv_patches[i-1].geom != subdiv_patches[i].geom || subdiv_patches[i-1].prim != subdiv_patches[i].prim;
+      });
+
+      /* recreate all patches of a face from its first patch */
+      parallel_for( size_t(0), numPrimitives, size_t(256), [&](const range<size_t>& r) 
+      {
+        for (size_t i=r.begin(); i<r.end(); i++) 
+        {
+          if (!firstPatch[i]) continue;
+          const SubdivMesh* mesh = this->scene->getSubdivMesh(subdiv_patches[i].geom);
+          size_t patchIndex = i;
+          createSubdivPatches(mesh,subdiv_patches[i].prim,[&](const SubdivPatch1Cached& patch)
+          {
+            assert(patchIndex < numPrimitives);
+            subdiv_patches[patchIndex] = patch;
+            prims[patchIndex] = PrimRef(subdiv_patches[patchIndex].bounds(mesh),patchIndex);
+            patchIndex++;
+          });
+        }
+      });
+    }
+
+    void BVH4SubdivPatch1CachedBuilderFast::collect_subtrees(NodeRef& ref, size_t depth)
+    {
+      if (depth == REFIT_SUBTREE_DEPTH || !ref.isNode()) {
+        refitSubtrees.push_back(&ref);
+        return;
+      }
+      Node* node = ref.node();
+      for (size_t i=0; i<BVH4::N; i++)
+        collect_subtrees(node->child(i),depth+1);
+    }
+
+    BBox3fa BVH4SubdivPatch1CachedBuilderFast::refit_toplevel(NodeRef& ref, size_t depth, size_t& subtree)
+    {
+      if (depth == REFIT_SUBTREE_DEPTH || !ref.isNode())
+        return refitBounds[subtree++];
+
+      Node* node = ref.node();
+      for (size_t i=0; i<BVH4::N; i++)
+        node->set(i,refit_toplevel(node->child(i),depth+1,subtree));
+      return node->bounds();
+    }
+
+    void BVH4SubdivPatch1CachedBuilderFast::refit_parallel()
+    {
+      /* refit subtrees below the top levels in parallel */
+      refitSubtrees.clear();
+      collect_subtrees(bvh->root,0);
+      refitBounds.resize(refitSubtrees.size());
+      parallel_for( size_t(0), refitSubtrees.size(), [&](const range<size_t>& r) 
+      {
+        for (size_t i=r.begin(); i<r.end(); i++) 
+          refitBounds[i] = refit(*refitSubtrees[i]);
+      });
+
+      /* refit the top levels */
+      size_t subtree = 0;
+      bvh->bounds = refit_toplevel(bvh->root,0,subtree);
+    }
+
     void BVH4SubdivPatch1CachedBuilderFast::build_sequential(size_t threadIndex, size_t threadCount)
     {
-      if (fastUpdateMode)
+      if (refitMode)
+      {
+        /* only vertices and edge levels changed, thus keep all patches and the tree structure */
+        double t0 = getSeconds();
+        if (g_verbose >= 1) std::cout << "refit " << std::flush;
+        update_patches();
+        refit_parallel();
+        t0 = getSeconds()-t0;
+        DBG_CACHE_BUILDER(std::cout << "vertex update and refit done in " << 1000.0f*t0 << "ms " << std::endl);
+      }
+      else if (fastUpdateMode)
         {
           double t0 = 0.0;
 
@@ -935,18 +1225,39 @@ namespace embree
       splitFallback(prims,record1,children[2],children[3]);
 
       /* allocate node */
-      Node* node = (Node*) nodeAlloc.malloc(sizeof(Node)); node->clear();
-      *current.parent = bvh->encodeNode(node);
+      BVH4::BaseNode* node = createNode(current,children,4,nodeAlloc);
       
       /* recurse into each child */
       for (size_t i=0; i<4; i++) 
       {
-        node->set(i,children[i].geomBounds);
-        children[i].parent = &node->child(i);
         children[i].depth = current.depth+1;
         createLeaf(children[i],nodeAlloc,leafAlloc,threadIndex,threadCount);
       }
-      BVH4::compact(node); // move empty nodes to the end
+      if (motionBlur) BVH4::compact((NodeMB*)node); // move empty nodes to the end
+      else            BVH4::compact((Node*  )node);
+    }
+
+    BVH4::BaseNode* BVH4BuilderFast::createNode(BuildRecord& current, BuildRecord* children, const size_t numChildren, Allocator& nodeAlloc)
+    {
+      /* motion blur nodes get their bounds of both time steps assigned by a refit after the build */
+      if (motionBlur) 
+      {
+        NodeMB* node = (NodeMB*) nodeAlloc.malloc(sizeof(NodeMB)); node->clear();
+        *current.parent = bvh->encodeNode(node);
+        for (size_t i=0; i<numChildren; i++) {
+          node->set(i,children[i].geomBounds);
+          children[i].parent = &node->child(i);
+        }
+        return node;
+      }
+
+      Node* node = (Node*) nodeAlloc.malloc(sizeof(Node)); node->clear();
+      *current.parent = bvh->encodeNode(node);
+      for (size_t i=0; i<numChildren; i++) {
+        node->set(i,children[i].geomBounds);
+        children[i].parent = &node->child(i);
+      }
+      return node;
     }
 
     // =======================================================================================================
@@ -968,7 +1279,7 @@ namespace embree
       rightChild.init(right,center,current.end);
     }
 
-    __forceinline void BVH4BuilderFast::splitSequential(BuildRecord& current, BuildRecord& leftChild, BuildRecord& rightChild, const size_t threadID, const size_t numThreads)
+    __forceinline void BVH4BuilderFast::splitSequential(BuildRecord& current, BuildRecord& leftChild, BuildRecord& rightChild, const size_t mode, const size_t threadID, const size_t numThreads)
     {
       /* calculate binning function */
       PrimInfo pinfo(current.size(),current.geomBounds,current.centBounds);
@@ -976,6 +1287,10 @@ namespace embree
       
       /* if we cannot find a valid split, enforce an arbitrary split */
       if (unlikely(!split.valid())) splitFallback(prims,current,leftChild,rightChild);
+
+      /* large subtrees get partitioned in parallel, threads that ran out of subtrees help */
+      else if (mode == RECURSE_PARALLEL && current.size() > THRESHOLD_FOR_PARALLEL_PARTITION) 
+        split.partition_parallel(prims, current.begin, current.end, leftChild, rightChild);
       
       /* partitioning of items */
       else split.partition(prims, current.begin, current.end, leftChild, rightChild);
@@ -1000,7 +1315,7 @@ namespace embree
     __forceinline void BVH4BuilderFast::split(BuildRecord& current, BuildRecord& left, BuildRecord& right, const size_t mode, const size_t threadID, const size_t numThreads)
     {
       if (mode == BUILD_TOP_LEVEL) splitParallel(current,left,right,threadID,numThreads);		  
-      else                         splitSequential(current,left,right,threadID,numThreads);
+      else                         splitSequential(current,left,right,mode,threadID,numThreads);
     }
     
     // =======================================================================================================
@@ -1076,22 +1391,32 @@ namespace embree
       }
       
       /* allocate node */
-      Node* node = (Node*) nodeAlloc.malloc(sizeof(Node)); node->clear();
-      *current.parent = bvh->encodeNode(node);
+      createNode(current,children,numChildren,nodeAlloc);
       
       /* recurse into each child */
       for (unsigned int i=0; i<numChildren; i++) 
-      {  
-        node->set(i,children[i].geomBounds);
-        children[i].parent = &node->child(i);
         recurse_continue(children[i],nodeAlloc,leafAlloc,mode,threadID,numThreads);
-      }
     }
     
     // =======================================================================================================
     // =======================================================================================================
     // =======================================================================================================
     
+    bool BVH4BuilderFast::waitForSubTrees(size_t threadID, size_t numThreads)
+    {
+      while (true)
+      {
+        /* only search again when some subtree is visible, otherwise idle threads would keep each other counted */
+        if (!state->heap.isEmpty()) return true;
+        for (size_t i=1; i<numThreads; i++)
+          if (!state->threadStack[(threadID+i)%numThreads].isEmpty()) return true;
+
+        /* subtrees only get pushed by counted threads */
+        if (state->numWorkingThreads == 0) return false;
+        if (!ParallelTaskSet::help()) __pause_cpu();
+      }
+    }
+
     void BVH4BuilderFast::buildSubTrees(size_t threadID, size_t numThreads)
     {
       __aligned(64) Allocator nodeAlloc(&bvh->alloc);
@@ -1099,26 +1424,28 @@ namespace embree
       
       while (true) 
       {
+        /* count this thread before searching, thus other threads cannot leave while it takes the last subtree */
+        atomic_add(&state->numWorkingThreads,1);
+
+        /* take the largest remaining top level subtree or steal the oldest subtree of some other thread */
 	BuildRecord br;
-	if (!state->heap.pop(br))
+        bool found = state->heap.take(br);
+        for (size_t i=1; i<numThreads && !found; i++)
+          found = state->threadStack[(threadID+i)%numThreads].steal(br);
+
+        /* found nothing, wait as long as other threads can still create subtrees */
+        if (!found) 
         {
-          /* global work queue empty => try to steal from neighboring queues */	  
-          bool success = false;
-          for (size_t i=0; i<numThreads; i++)
-          {
-            if (state->threadStack[(threadID+i)%numThreads].pop(br)) {
-              success = true;
-              break;
-            }
-          }
-          /* found nothing to steal ? */
-          if (!success) break; // FIXME: may loose threads
+          atomic_add(&state->numWorkingThreads,-1);
+          if (waitForSubTrees(threadID,numThreads)) continue;
+          break;
         }
         
         /* process local work queue */
 	recurse(br,nodeAlloc,leafAlloc,RECURSE_PARALLEL,threadID,numThreads);
 	while (state->threadStack[threadID].pop(br))
           recurse(br,nodeAlloc,leafAlloc,RECURSE_PARALLEL,threadID,numThreads);
+        atomic_add(&state->numWorkingThreads,-1);
       }
       _mm_sfence(); // make written leaves globally visible
     }
@@ -1191,7 +1518,7 @@ namespace embree
       }
       _mm_sfence(); // make written leaves globally visible
 
-      std::sort(state->heap.begin(),state->heap.end(),BuildRecord::Greater());
+      state->heap.sort();
 
       /* now process all created subtasks on multiple threads */
       scheduler->dispatchTask(task_buildSubTrees, this, threadIndex, threadCount );
@@ -1258,6 +1585,10 @@ namespace embree
     Builder* BVH4Triangle4vBuilderFast (void* bvh, Scene* scene, size_t mode) { return new class BVH4TriangleBuilderFast<Triangle4v>((BVH4*)bvh,scene,mode); }
     Builder* BVH4Triangle4iBuilderFast (void* bvh, Scene* scene, size_t mode) { return new class BVH4TriangleBuilderFast<Triangle4i>((BVH4*)bvh,scene,mode); }
     Builder* BVH4UserGeometryBuilderFast(void* bvh, Scene* scene, size_t mode) { return new class BVH4UserGeometryBuilderFastT<AccelSetItem>((BVH4*)bvh,scene,mode); }
+    Builder* BVH4Sphere4BuilderFast(void* bvh, Scene* scene, size_t mode) { return new class BVH4PointsBuilderFast<Sphere4>((BVH4*)bvh,scene,mode); }
+#if defined(__AVX__)
+    Builder* BVH4Sphere8BuilderFast(void* bvh, Scene* scene, size_t mode) { return new class BVH4PointsBuilderFast<Sphere8>((BVH4*)bvh,scene,mode); }
+#endif
 
     Builder* BVH4Bezier1vMeshBuilderFast    (void* bvh, BezierCurves* geom, size_t mode) { return new class BVH4BezierBuilderFast<Bezier1v>  ((BVH4*)bvh,geom,mode); }
     Builder* BVH4Bezier1iMeshBuilderFast   (void* bvh, BezierCurves* geom, size_t mode) { return new class BVH4BezierBuilderFast<Bezier1i> ((BVH4*)bvh,geom,mode); }
@@ -1274,6 +1605,7 @@ namespace embree
     Builder* BVH4SubdivPatch1BuilderFast(void* bvh, Scene* scene, size_t mode) { return new class BVH4SubdivBuilderFast<SubdivPatch1>((BVH4*)bvh,scene,mode); }
     Builder* BVH4SubdivGridBuilderFast(void* bvh, Scene* scene, size_t mode) { return new class BVH4SubdivGridBuilderFast((BVH4*)bvh,scene,mode); }
     Builder* BVH4SubdivGridEagerBuilderFast(void* bvh, Scene* scene, size_t mode) { return new class BVH4SubdivGridEagerBuilderFast((BVH4*)bvh,scene,mode); }
+    Builder* BVH4SubdivGridEagerMBBuilderFast(void* bvh, Scene* scene, size_t mode) { return new class BVH4SubdivGridEagerMBBuilderFast((BVH4*)bvh,scene,mode); }
     Builder* BVH4SubdivGridLazyBuilderFast(void* bvh, Scene* scene, size_t mode) { return new class BVH4SubdivGridLazyBuilderFast((BVH4*)bvh,scene,mode); }
     Builder* BVH4SubdivPatch1CachedBuilderFast(void* bvh, Scene* scene, size_t mode) { return new class BVH4SubdivPatch1CachedBuilderFast((BVH4*)bvh,scene,mode); }
 
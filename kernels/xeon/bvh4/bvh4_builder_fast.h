@@ -37,6 +37,7 @@ namespace embree
 
     protected:
       typedef BVH4::Node Node;
+      typedef BVH4::NodeMB NodeMB;
       typedef BVH4::NodeRef NodeRef;
       typedef LinearAllocatorPerThread::ThreadAllocator Allocator;
       static const size_t SIZE_WORK_STACK = 64;
@@ -92,8 +93,8 @@ namespace embree
         ALIGNED_CLASS;
       public:
 
-        GlobalState () : numThreads(getNumberOfLogicalThreads()) {
-	  threadStack = new WorkStack<BuildRecord,SIZE_WORK_STACK>[numThreads]; 
+        GlobalState () : numThreads(getNumberOfLogicalThreads()), numWorkingThreads(0) {
+	  threadStack = new WorkDeque<BuildRecord,SIZE_WORK_STACK>[numThreads]; 
         }
         
         ~GlobalState () {
@@ -103,7 +104,8 @@ namespace embree
       public:
 	size_t numThreads;
 	WorkHeap<BuildRecord> heap;
-        __aligned(64) WorkStack<BuildRecord,SIZE_WORK_STACK>* threadStack;
+        __aligned(64) WorkDeque<BuildRecord,SIZE_WORK_STACK>* threadStack;
+        __aligned(64) volatile atomic_t numWorkingThreads; //!< threads that may still push subtrees
         ObjectPartition::ParallelBinner parallelBinner;
       };
 
@@ -126,6 +128,9 @@ namespace embree
       TASK_FUNCTION(BVH4BuilderFast,buildSubTrees);
       TASK_SET_FUNCTION(BVH4BuilderFast,build_parallel);
 
+      /*! waits until some subtree can get taken, returns false if no subtrees get created anymore */
+      bool waitForSubTrees(size_t threadID, size_t numThreads);
+
     public:
 
       /*! compute number of primitives */
@@ -144,7 +149,7 @@ namespace embree
       void split(BuildRecord& current, BuildRecord& left, BuildRecord& right, const size_t mode, const size_t threadID, const size_t numThreads);
       
       /*! perform sequential binning and splitting */
-      void splitSequential(BuildRecord& current, BuildRecord& leftChild, BuildRecord& rightChild, const size_t threadID, const size_t numThreads);
+      void splitSequential(BuildRecord& current, BuildRecord& leftChild, BuildRecord& rightChild, const size_t mode, const size_t threadID, const size_t numThreads);
       
       /*! perform parallel binning and splitting */
       void splitParallel(BuildRecord& current, BuildRecord& leftChild, BuildRecord& rightChild, const size_t threadID, const size_t threads);
@@ -152,6 +157,9 @@ namespace embree
       /*! creates a small leaf node */
       virtual void createSmallLeaf(BuildRecord& current, Allocator& leafAlloc, size_t threadID) = 0;
 
+      /*! creates an inner node over the children and links the children to it */
+      BVH4::BaseNode* createNode(BuildRecord& current, BuildRecord* children, const size_t numChildren, Allocator& nodeAlloc);
+
       /*! creates a large leaf node */
       void createLeaf(BuildRecord& current, Allocator& nodeAlloc, Allocator& leafAlloc, size_t threadIndex, size_t threadCount);
       
@@ -176,6 +184,7 @@ namespace embree
       size_t primBytes; 
       size_t minLeafSize;
       size_t maxLeafSize;
+      bool motionBlur;      //!< creates motion blur nodes that have to get refitted after the build
       
     protected:
       TaskScheduler::Task task;
@@ -211,6 +220,16 @@ namespace embree
       BezierCurves* geom;   //!< input mesh
     };
     
+    template<typename Primitive>
+    class BVH4PointsBuilderFast : public BVH4BuilderFastT<Primitive>
+    {
+    public:
+      BVH4PointsBuilderFast (BVH4* bvh, Scene* scene, size_t listMode);
+      size_t number_of_primitives();
+      void create_primitive_array_sequential(size_t threadIndex, size_t threadCount, PrimInfo& pinfo);
+      void create_primitive_array_parallel  (size_t threadIndex, size_t threadCount, LockStepTaskScheduler* scheduler, PrimInfo& pinfo);
+    };
+    
     template<typename Primitive>
     class BVH4TriangleBuilderFast : public BVH4BuilderFastT<Primitive>
     {
@@ -230,6 +249,7 @@ namespace embree
     public:
       BVH4UserGeometryBuilderFastT (BVH4* bvh, Scene* scene, size_t listMode);
       BVH4UserGeometryBuilderFastT (BVH4* bvh, UserGeometryBase* geom, size_t listMode);
+      virtual void build(size_t threadIndex, size_t threadCount);
       size_t number_of_primitives();
       void create_primitive_array_sequential(size_t threadIndex, size_t threadCount, PrimInfo& pinfo);
       void create_primitive_array_parallel  (size_t threadIndex, size_t threadCount, LockStepTaskScheduler* scheduler, PrimInfo& pinfo) ;
@@ -313,6 +333,23 @@ namespace embree
       ParallelForForPrefixSumState<PrimInfo> pstate;
     };
 
+    class BVH4SubdivGridEagerMBBuilderFast : public BVH4BuilderFastT<PrimRef>
+    {
+    public:
+      BVH4SubdivGridEagerMBBuilderFast (BVH4* bvh, Scene* scene, size_t listMode);
+      virtual void build(size_t threadIndex, size_t threadCount);
+
+      size_t number_of_primitives();
+      void create_primitive_array_sequential(size_t threadIndex, size_t threadCount, PrimInfo& pinfo);
+      void create_primitive_array_parallel  (size_t threadIndex, size_t threadCount, LockStepTaskScheduler* scheduler, PrimInfo& pinfo);
+
+      /*! assigns the bounds of both time steps to the motion blur nodes */
+      std::pair<BBox3fa,BBox3fa> refit(NodeRef ref);
+
+      Scene::Iterator<SubdivMesh,true> iter;
+      ParallelForForPrefixSumState<PrimInfo> pstate;
+    };
+
     class BVH4SubdivGridLazyBuilderFast : public BVH4BuilderFastT<Grid::LazyLeaf*>
     {
     public:
@@ -349,12 +386,27 @@ namespace embree
 
     class BVH4SubdivPatch1CachedBuilderFast : public BVH4BuilderFastT<PrimRef>
     {
+      /*! depth of the subtrees that get refitted in parallel */
+      static const size_t REFIT_SUBTREE_DEPTH = 3;
+
     private:
       bool fastUpdateMode;
       size_t fastUpdateMode_numFaces;
+      bool refitMode;                           //!< only vertices changed, patches and tree structure are kept
+      std::vector<SubdivMesh*> refitMeshes;     //!< meshes the patches got created from
+      std::vector<NodeRef*> refitSubtrees;      //!< subtrees to refit in parallel
+      std::vector<BBox3fa> refitBounds;         //!< bounds of refitted subtrees
 
       BBox3fa refit(NodeRef& ref);
 
+      /*! recreates all patches in place from the current vertices */
+      void update_patches();
+
+      /*! refits the tree over the patches in parallel */
+      void refit_parallel();
+      void collect_subtrees(NodeRef& ref, size_t depth);
+      BBox3fa refit_toplevel(NodeRef& ref, size_t depth, size_t& subtree);
+
     public:
       BVH4SubdivPatch1CachedBuilderFast (BVH4* bvh, Scene* scene, size_t listMode);
       virtual void build(size_t threadIndex, size_t threadCount);
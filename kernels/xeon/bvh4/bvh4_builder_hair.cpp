@@ -115,6 +115,9 @@ namespace embree
 
         tasks.clear();
 #endif
+
+        /* free all temporary primitive blocks */
+        alloc.clear();
 	
 	if (g_verbose >= 2) {
 	  double t1 = getSeconds();
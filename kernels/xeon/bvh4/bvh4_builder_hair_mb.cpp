@@ -122,6 +122,9 @@ namespace embree
         tasks.clear();
 #endif
 
+        /* free all temporary primitive blocks */
+        alloc.clear();
+
 	if (g_verbose >= 2) {
 	  double t1 = getSeconds();
 	  std::cout << " [DONE]" << std::endl;
@@ -372,6 +372,7 @@ namespace embree
       bvh->bounds = pinfo.geomBounds;
 
       /* free all temporary memory blocks */
+      alloc.clear();
       Alloc::global.clear();
 
       if (g_verbose >= 2 || g_benchmark) 
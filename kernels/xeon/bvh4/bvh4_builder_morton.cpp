@@ -329,9 +329,7 @@ namespace embree
       const size_t startID = (threadID+0)*numPrimitives/numThreads;
       const size_t endID   = (threadID+1)*numPrimitives/numThreads;
       
-      /* store the morton codes temporarily in 'node' memory */
-      MortonID32Bit* __restrict__ const dest = (MortonID32Bit*)bvh->alloc.base();
-      computeMortonCodes(startID,endID,state->dest[threadID],state->startGroup[threadID],state->startGroupOffset[threadID],dest);
+      computeMortonCodes(startID,endID,state->dest[threadID],state->startGroup[threadID],state->startGroupOffset[threadID],morton);
     }
     
     void BVH4BuilderMorton::recreateMortonCodes(BuildRecord& current) const
@@ -379,67 +377,6 @@ namespace embree
 #endif	    
     }
     
-    void BVH4BuilderMorton::radixsort(const size_t threadID, const size_t numThreads)
-    {
-      const size_t startID = (threadID+0)*numPrimitives/numThreads;
-      const size_t endID   = (threadID+1)*numPrimitives/numThreads;
-      
-      MortonID32Bit* __restrict__ mortonID[2];
-      mortonID[0] = (MortonID32Bit*) morton; 
-      mortonID[1] = (MortonID32Bit*) bvh->alloc.base();
-      MortonBuilderState::ThreadRadixCountTy* radixCount = state->radixCount;
-      
-      /* we need 3 iterations to process all 32 bits */
-      for (size_t b=0; b<3; b++)
-      {
-        const MortonID32Bit* __restrict src = (MortonID32Bit*) &mortonID[((b+1)%2)][0];
-        MortonID32Bit*       __restrict dst = (MortonID32Bit*) &mortonID[((b+0)%2)][0];
-        
-        /* shift and mask to extract some number of bits */
-        const unsigned int mask = RADIX_BUCKETS_MASK;
-        const unsigned int shift = b * RADIX_BITS;
-        
-        /* count how many items go into the buckets */
-        for (size_t i=0; i<RADIX_BUCKETS; i++)
-          radixCount[threadID][i] = 0;
-        
-        for (size_t i=startID; i<endID; i++) {
-          const size_t index = src[i].get(shift, mask);
-          radixCount[threadID][index]++;
-        }
-        //TaskScheduler::syncThreads(threadID,numThreads);
-	barrier.wait(threadID,numThreads);
-        
-        /* calculate total number of items for each bucket */
-        __aligned(64) size_t total[RADIX_BUCKETS];
-        for (size_t i=0; i<RADIX_BUCKETS; i++)
-          total[i] = 0;
-        
-        for (size_t i=0; i<numThreads; i++)
-          for (size_t j=0; j<RADIX_BUCKETS; j++)
-            total[j] += radixCount[i][j];
-        
-        /* calculate start offset of each bucket */
-        __aligned(64) size_t offset[RADIX_BUCKETS];
-        offset[0] = 0;
-        for (size_t i=1; i<RADIX_BUCKETS; i++)    
-          offset[i] = offset[i-1] + total[i-1];
-        
-        /* calculate start offset of each bucket for this thread */
-        for (size_t j=0; j<RADIX_BUCKETS; j++)
-          for (size_t i=0; i<threadID; i++)
-            offset[j] += radixCount[i][j];
-        
-        /* copy items into their buckets */
-        for (size_t i=startID; i<endID; i++) {
-          const size_t index = src[i].get(shift, mask);
-          dst[offset[index]++] = src[i];
-        }
-        if (b < 2) barrier.wait(threadID,numThreads);
-	  //TaskScheduler::syncThreads(threadID,numThreads);
-      }
-    }
-    
     void BVH4BuilderMorton::recurseSubMortonTrees(const size_t threadID, const size_t numThreads)
     {
       __aligned(64) Allocator nodeAlloc(&bvh->alloc);
@@ -1051,8 +988,8 @@ namespace embree
       else      computeMortonCodes(0,numPrimitives,dst,0,0,morton);
       numPrimitives = dst;
 
-      /* sort morton codes */
-      std::sort(&morton[0],&morton[numPrimitives]); // FIXME: use radix sort
+      /* sort morton codes, 'node' memory serves as temporary storage */
+      radixSort.sort<MortonID32Bit,uint32>(morton,(MortonID32Bit*)bvh->alloc.base(),numPrimitives);
       
 #if defined(DEBUG)
       for (size_t i=1; i<numPrimitives; i++)
@@ -1106,15 +1043,13 @@ namespace embree
       }
       
       /* padding */
-      MortonID32Bit* __restrict__ const dest = (MortonID32Bit*) bvh->alloc.base();
       for (size_t i=numPrimitives; i<( (numPrimitives+7)&(-8) ); i++) {
-        dest[i].code  = 0xffffffff; 
-        dest[i].index = 0;
+        morton[i].code  = 0xffffffff; 
+        morton[i].index = 0;
       }
 
-      /* sort morton codes */
-      barrier.init(threadCount);
-      scheduler->dispatchTask( task_radixsort, this, threadIndex, threadCount );
+      /* sort morton codes, 'node' memory serves as temporary storage */
+      radixSort.sort<MortonID32Bit,uint32>(morton,(MortonID32Bit*)bvh->alloc.base(),numPrimitives);
 
 #if defined(DEBUG)
       for (size_t i=1; i<numPrimitives; i++)
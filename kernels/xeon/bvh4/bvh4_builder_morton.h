@@ -19,6 +19,7 @@
 #include "bvh4.h"
 #include "builders/heuristic_fallback.h"
 #include "builders/workstack.h"
+#include "algorithms/sort.h"
 
 namespace embree
 {
@@ -43,10 +44,6 @@ namespace embree
       static const size_t LATTICE_BITS_PER_DIM = 10;
       static const size_t LATTICE_SIZE_PER_DIM = size_t(1) << LATTICE_BITS_PER_DIM;
       
-      static const size_t RADIX_BITS = 11;
-      static const size_t RADIX_BUCKETS = (1 << RADIX_BITS);
-      static const size_t RADIX_BUCKETS_MASK = (RADIX_BUCKETS-1);
-
     public:
   
       class BuildRecord 
@@ -112,8 +109,6 @@ namespace embree
 
       public:
 
-        typedef unsigned int ThreadRadixCountTy[RADIX_BUCKETS];
-
         MortonBuilderState () 
         {
 	  taskCounter = 0;
@@ -121,12 +116,10 @@ namespace embree
           startGroup = new unsigned int[numThreads];
           startGroupOffset = new unsigned int[numThreads];
 	  dest = new size_t[numThreads];
-          radixCount = (ThreadRadixCountTy*) alignedMalloc(numThreads*sizeof(ThreadRadixCountTy));
         }
 
         ~MortonBuilderState () 
         {
-          alignedFree(radixCount);
           delete[] startGroupOffset;
           delete[] startGroup;
 	  delete[] dest;
@@ -136,12 +129,10 @@ namespace embree
         unsigned int* startGroup;
         unsigned int* startGroupOffset;
 	size_t* dest;
-        ThreadRadixCountTy* radixCount;
         
 	atomic_t taskCounter;
 	std::vector<BuildRecord> buildRecords;
         __aligned(64) WorkStack<BuildRecord,NUM_TOP_LEVEL_BINS> workStack;
-        LinearBarrierActive barrier;
       };
       
       /*! Constructor. */
@@ -175,9 +166,6 @@ namespace embree
       /*! task that calculates the morton codes for each primitive in the scene */
       TASK_FUNCTION(BVH4BuilderMorton,computeMortonCodes);
       
-      /*! parallel sort of the morton codes */
-      TASK_FUNCTION(BVH4BuilderMorton,radixsort);
-      
       /*! task that builds a list of sub-trees */
       TASK_FUNCTION(BVH4BuilderMorton,recurseSubMortonTrees);
       
@@ -238,6 +226,7 @@ namespace embree
     public:
       MortonID32Bit* __restrict__ morton;
       size_t bytesMorton;
+      ParallelRadixSort radixSort; //!< keeps scratch memory of morton code sort across builds
       
     public:
       size_t numGroups;
@@ -245,7 +234,6 @@ namespace embree
       size_t numAllocatedPrimitives;
       size_t numAllocatedNodes;
       CentGeomBBox3fa global_bounds;
-      Barrier barrier;
       //createSmallLeaf createSmallLeaf;
       //leafBounds leafBounds;
       //LockStepTaskScheduler scheduler;
@@ -24,6 +24,10 @@
 #include "geometry/triangle8_intersector1_moeller.h"
 #endif
 #include "geometry/triangle1v_intersector1_pluecker.h"
+#include "geometry/sphere4_intersector1.h"
+#if defined(__AVX__)
+#include "geometry/sphere8_intersector1.h"
+#endif
 #include "geometry/triangle4v_intersector1_pluecker.h"
 #include "geometry/triangle4v_intersector1_moeller_mb.h"
 #include "geometry/triangle4i_intersector1.h"
@@ -316,8 +320,14 @@ namespace embree
 
     DEFINE_INTERSECTOR1(BVH4GridIntersector1,BVH4Intersector1<0x1 COMMA false COMMA GridIntersector1>);
     DEFINE_INTERSECTOR1(BVH4GridLazyIntersector1,BVH4Intersector1<0x1 COMMA false COMMA Switch2Intersector1<GridIntersector1 COMMA GridLazyIntersector1> >);
+    DEFINE_INTERSECTOR1(BVH4GridMBIntersector1,BVH4Intersector1<0x10 COMMA false COMMA GridMBIntersector1>);
+
+    DEFINE_INTERSECTOR1(BVH4Sphere4Intersector1,BVH4Intersector1<0x1 COMMA false COMMA LeafIterator1<Sphere4Intersector1<LeafMode> > >);
+#if defined(__AVX__)
+    DEFINE_INTERSECTOR1(BVH4Sphere8Intersector1,BVH4Intersector1<0x1 COMMA false COMMA LeafIterator1<Sphere8Intersector1<LeafMode> > >);
+#endif
 
-    DEFINE_INTERSECTOR1(BVH4VirtualIntersector1,BVH4Intersector1<0x1 COMMA false COMMA LeafIterator1<VirtualAccelIntersector1> >);
+    DEFINE_INTERSECTOR1(BVH4VirtualIntersector1,BVH4Intersector1<0x1 COMMA false COMMA VirtualAccelIntersector1N<LeafMode> >);
 
     DEFINE_INTERSECTOR1(BVH4Triangle1vMBIntersector1Moeller,BVH4Intersector1<0x10 COMMA false COMMA LeafIterator1<Triangle1vIntersector1MoellerTrumboreMB<LeafMode> > >);
     DEFINE_INTERSECTOR1(BVH4Triangle4vMBIntersector1Moeller,BVH4Intersector1<0x10 COMMA false COMMA LeafIterator1<Triangle4vMBIntersector1MoellerTrumbore<LeafMode> > >);
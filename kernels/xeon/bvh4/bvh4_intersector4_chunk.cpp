@@ -27,6 +27,10 @@
 #include "geometry/triangle4v_intersector4_pluecker.h"
 #include "geometry/triangle4i_intersector4.h"
 #include "geometry/virtual_accel_intersector4.h"
+#include "geometry/sphere4_intersector4.h"
+#if defined (__AVX__)
+#include "geometry/sphere8_intersector4.h"
+#endif
 #include "geometry/triangle1v_intersector4_moeller_mb.h"
 #include "geometry/triangle4v_intersector4_moeller_mb.h"
 
@@ -369,6 +373,11 @@ namespace embree
     DEFINE_INTERSECTOR4(BVH4Triangle1vIntersector4ChunkPluecker, BVH4Intersector4Chunk<0x1 COMMA true COMMA LeafIterator4<Triangle1vIntersector4Pluecker<LeafMode> > >);
     DEFINE_INTERSECTOR4(BVH4Triangle4vIntersector4ChunkPluecker, BVH4Intersector4Chunk<0x1 COMMA true COMMA LeafIterator4<Triangle4vIntersector4Pluecker<LeafMode> > >);
     DEFINE_INTERSECTOR4(BVH4Triangle4iIntersector4ChunkPluecker, BVH4Intersector4Chunk<0x1 COMMA true COMMA LeafIterator4<Triangle4iIntersector4Pluecker<LeafMode> > >);
+    DEFINE_INTERSECTOR4(BVH4Sphere4Intersector4Chunk, BVH4Intersector4Chunk<0x1 COMMA false COMMA LeafIterator4<Sphere4Intersector4<LeafMode> > >);
+#if defined (__AVX__)
+    DEFINE_INTERSECTOR4(BVH4Sphere8Intersector4Chunk, BVH4Intersector4Chunk<0x1 COMMA false COMMA LeafIterator4<Sphere8Intersector4<LeafMode> > >);
+#endif
+
     DEFINE_INTERSECTOR4(BVH4VirtualIntersector4Chunk, BVH4Intersector4Chunk<0x1 COMMA false COMMA LeafIterator4<VirtualAccelIntersector4> >);
 
     DEFINE_INTERSECTOR4(BVH4Triangle1vMBIntersector4ChunkMoeller, BVH4Intersector4Chunk<0x10 COMMA false COMMA LeafIterator4<Triangle1vIntersector4MoellerTrumboreMB<LeafMode> > >);
@@ -123,5 +123,6 @@ namespace embree
 
     DEFINE_INTERSECTOR4(BVH4GridIntersector4, BVH4Intersector4FromIntersector1<BVH4Intersector1<0x1 COMMA false COMMA GridIntersector1> >);
     DEFINE_INTERSECTOR4(BVH4GridLazyIntersector4, BVH4Intersector4FromIntersector1<BVH4Intersector1<0x1 COMMA false COMMA Switch2Intersector1<GridIntersector1 COMMA GridLazyIntersector1> > >);
+    DEFINE_INTERSECTOR4(BVH4GridMBIntersector4, BVH4Intersector4FromIntersector1<BVH4Intersector1<0x10 COMMA false COMMA GridMBIntersector1> >);
    }
 }
@@ -25,6 +25,8 @@
 #include "geometry/triangle4v_intersector8_pluecker.h"
 #include "geometry/triangle4i_intersector8.h"
 #include "geometry/virtual_accel_intersector8.h"
+#include "geometry/sphere4_intersector8.h"
+#include "geometry/sphere8_intersector8.h"
 #include "geometry/triangle1v_intersector8_moeller_mb.h"
 #include "geometry/triangle4v_intersector8_moeller_mb.h"
 
@@ -365,6 +367,9 @@ namespace embree
     DEFINE_INTERSECTOR8(BVH4Triangle1vIntersector8ChunkPluecker, BVH4Intersector8Chunk<0x1 COMMA true COMMA LeafIterator8<Triangle1vIntersector8Pluecker<LeafMode> > >);
     DEFINE_INTERSECTOR8(BVH4Triangle4vIntersector8ChunkPluecker, BVH4Intersector8Chunk<0x1 COMMA true COMMA LeafIterator8<Triangle4vIntersector8Pluecker<LeafMode> > >);
     DEFINE_INTERSECTOR8(BVH4Triangle4iIntersector8ChunkPluecker, BVH4Intersector8Chunk<0x1 COMMA true COMMA LeafIterator8<Triangle4iIntersector8Pluecker<LeafMode> > >);
+    DEFINE_INTERSECTOR8(BVH4Sphere4Intersector8Chunk, BVH4Intersector8Chunk<0x1 COMMA false COMMA LeafIterator8<Sphere4Intersector8<LeafMode> > >);
+    DEFINE_INTERSECTOR8(BVH4Sphere8Intersector8Chunk, BVH4Intersector8Chunk<0x1 COMMA false COMMA LeafIterator8<Sphere8Intersector8<LeafMode> > >);
+
     DEFINE_INTERSECTOR8(BVH4VirtualIntersector8Chunk, BVH4Intersector8Chunk<0x1 COMMA false COMMA LeafIterator8<VirtualAccelIntersector8> >);
 
     DEFINE_INTERSECTOR8(BVH4Triangle1vMBIntersector8ChunkMoeller, BVH4Intersector8Chunk<0x10 COMMA false COMMA LeafIterator8<Triangle1vIntersector8MoellerTrumboreMB<LeafMode> > >);
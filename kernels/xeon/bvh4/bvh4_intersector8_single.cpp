@@ -122,5 +122,6 @@ namespace embree
 
     DEFINE_INTERSECTOR8(BVH4GridIntersector8, BVH4Intersector8FromIntersector1<BVH4Intersector1<0x1 COMMA false COMMA GridIntersector1> >);
     DEFINE_INTERSECTOR8(BVH4GridLazyIntersector8, BVH4Intersector8FromIntersector1<BVH4Intersector1<0x1 COMMA false COMMA Switch2Intersector1<GridIntersector1 COMMA GridLazyIntersector1> > >);
+    DEFINE_INTERSECTOR8(BVH4GridMBIntersector8, BVH4Intersector8FromIntersector1<BVH4Intersector1<0x10 COMMA false COMMA GridMBIntersector1> >);
   }
 }
@@ -36,6 +36,7 @@ namespace embree
   namespace isa
   {
     static const size_t THRESHOLD_FOR_SINGLE_THREADED = 50000; // FIXME: measure if this is really optimal, maybe disable only parallel splits
+    static const size_t THRESHOLD_FOR_PARALLEL_PARTITION = 64*1024;
 
     template<> BVH8BuilderT<Triangle4 >::BVH8BuilderT (BVH8* bvh, Scene* scene, size_t mode) 
       : BVH8Builder(bvh,scene,NULL,mode,2,2,1.0f,false,sizeof(Triangle4),4,inf) {}
@@ -185,7 +186,10 @@ namespace embree
 	/* perform best found split */
 	BuildRecord lrecord(record.depth+1);
 	BuildRecord rrecord(record.depth+1);
-	records_o[bestChild].split.split<PARALLEL>(threadIndex,threadCount,parent->scheduler,parent->alloc,parent->scene,records_o[bestChild].prims,lrecord.prims,lrecord.pinfo,rrecord.prims,rrecord.pinfo);
+	if (!PARALLEL && records_o[bestChild].pinfo.size() > THRESHOLD_FOR_PARALLEL_PARTITION) // large splits of subtasks get performed in parallel
+	  records_o[bestChild].split.split_nested(threadIndex,threadCount,parent->alloc,parent->scene,records_o[bestChild].prims,lrecord.prims,lrecord.pinfo,rrecord.prims,rrecord.pinfo);
+	else
+	  records_o[bestChild].split.split<PARALLEL>(threadIndex,threadCount,parent->scheduler,parent->alloc,parent->scene,records_o[bestChild].prims,lrecord.prims,lrecord.pinfo,rrecord.prims,rrecord.pinfo);
 
 	/* fallback if spatial split did fail for corner case */
 	if (lrecord.pinfo.size() == 0) {
@@ -272,6 +276,7 @@ namespace embree
 	taskMutex.lock();
 	if (tasks.size() == 0) {
 	  taskMutex.unlock();
+          if (!ParallelTaskSet::help()) __pause_cpu(); // help with large splits of other threads
 	  continue;
 	}
 	BuildRecord record = tasks.back();
@@ -410,6 +415,7 @@ namespace embree
       bvh->bounds = pinfo.geomBounds;
       
       /* free all temporary memory blocks */
+      alloc.clear();
       Alloc::global.clear();
       //TaskScheduler::enableThreads(threadCountOld); // FIXME: enable
       
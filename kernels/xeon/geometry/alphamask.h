@@ -0,0 +1,94 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "common/scene.h"
+
+namespace embree
+{
+  namespace isa
+  {
+    /*! Performs the alpha mask test for hits with triangles of
+     *  different meshes, one triangle per SIMD lane. Returns the valid
+     *  hits that are either not masked or hit an opaque texel. */
+    template<typename vbool, typename vint, typename vfloat>
+      __forceinline vbool runAlphaMaskTest(const vbool& valid, Scene* scene, const vint& geomID, const vint& primID, const vfloat& u, const vfloat& v)
+    {
+      /* gather texture coordinates of all triangles that have an alpha mask */
+      const TriangleMesh* meshes[vbool::size];
+      Vec2<vfloat> st0 = zero, st1 = zero, st2 = zero;
+      vfloat width = one, height = one;
+      vbool masked = false;
+      for (size_t m=movemask(valid), i=__bsf(m); m!=0; m=__btc(m,i), i=__bsf(m)) 
+      {
+        const TriangleMesh* mesh = meshes[i] = scene->getTriangleMesh(geomID[i]);
+        if (likely(!mesh->hasAlphaMask())) continue;
+        const TriangleMesh::Triangle& tri = mesh->triangle(primID[i]);
+        const Vec2f& t0 = mesh->texcoord(tri.v[0]); st0.x[i] = t0.x; st0.y[i] = t0.y;
+        const Vec2f& t1 = mesh->texcoord(tri.v[1]); st1.x[i] = t1.x; st1.y[i] = t1.y;
+        const Vec2f& t2 = mesh->texcoord(tri.v[2]); st2.x[i] = t2.x; st2.y[i] = t2.y;
+        width[i] = float(mesh->alphaMaskWidth); height[i] = float(mesh->alphaMaskHeight);
+        masked[i] = -1;
+      }
+      if (likely(none(masked))) return valid;
+
+      /* interpolate texture coordinates and clamp texel coordinates to the mask */
+      const vfloat w = vfloat(one) - u - v;
+      const vfloat s = w*st0.x + u*st1.x + v*st2.x;
+      const vfloat t = w*st0.y + u*st1.y + v*st2.y;
+      const vfloat x = min(max(s*width ,vfloat(zero)),width -vfloat(one));
+      const vfloat y = min(max(t*height,vfloat(zero)),height-vfloat(one));
+
+      /* lookup opacity bits */
+      vbool opaque = valid;
+      for (size_t m=movemask(masked), i=__bsf(m); m!=0; m=__btc(m,i), i=__bsf(m)) {
+        if (!meshes[i]->isOpaque(size_t(x[i]),size_t(y[i]))) opaque[i] = 0;
+      }
+      return opaque;
+    }
+
+    /*! Performs the alpha mask test for hits of a ray packet with a
+     *  single triangle. Returns the valid hits that either have no
+     *  alpha mask or hit an opaque texel. */
+    template<typename vbool, typename vfloat>
+      __forceinline vbool runAlphaMaskTest(const vbool& valid, Scene* scene, const int geomID, const int primID, const vfloat& u, const vfloat& v)
+    {
+      const TriangleMesh* mesh = scene->getTriangleMesh(geomID);
+      if (likely(!mesh->hasAlphaMask())) return valid;
+
+      /* interpolate texture coordinates and clamp texel coordinates to the mask */
+      const TriangleMesh::Triangle& tri = mesh->triangle(primID);
+      const Vec2f st0 = mesh->texcoord(tri.v[0]);
+      const Vec2f st1 = mesh->texcoord(tri.v[1]);
+      const Vec2f st2 = mesh->texcoord(tri.v[2]);
+      const vfloat width  = float(mesh->alphaMaskWidth);
+      const vfloat height = float(mesh->alphaMaskHeight);
+      const vfloat w = vfloat(one) - u - v;
+      const vfloat s = w*st0.x + u*st1.x + v*st2.x;
+      const vfloat t = w*st0.y + u*st1.y + v*st2.y;
+      const vfloat x = min(max(s*width ,vfloat(zero)),width -vfloat(one));
+      const vfloat y = min(max(t*height,vfloat(zero)),height-vfloat(one));
+
+      /* lookup opacity bits */
+      vbool opaque = valid;
+      for (size_t m=movemask(valid), i=__bsf(m); m!=0; m=__btc(m,i), i=__bsf(m)) {
+        if (!mesh->isOpaque(size_t(x[i]),size_t(y[i]))) opaque[i] = 0;
+      }
+      return opaque;
+    }
+  }
+}
@@ -36,9 +36,33 @@ namespace embree
 {
   namespace isa
   {
+    __forceinline bool runFilterN(RTCFilterFuncN filterN, const Geometry* const geometry, const Ray& ray, 
+                                  const float& u, const float& v, const float& t, const Vec3fa& Ng, const int geomID, const int primID)
+    {
+      /* the batched filter function gets the hit passed separately, thus the ray stays untouched */
+      int valid = -1;
+      AVX_ZERO_UPPER();
+      filterN(&valid,geometry->userPtr,(const RTCRay&)ray,geomID,(const unsigned*)&primID,&u,&v,&t,&Ng.x,&Ng.y,&Ng.z,1);
+      return valid != 0;
+    }
+
     __forceinline bool runIntersectionFilter1(const Geometry* const geometry, Ray& ray, 
                                               const float& u, const float& v, const float& t, const Vec3fa& Ng, const int geomID, const int primID)
     {
+      /* use batched filter function with a single hit if set */
+      if (geometry->hasIntersectionFilterN()) 
+      {
+        if (!runFilterN(geometry->intersectionFilterN,geometry,ray,u,v,t,Ng,geomID,primID)) 
+          return false;
+        ray.u = u;
+        ray.v = v;
+        ray.tfar = t;
+        ray.geomID = geomID;
+        ray.primID = primID;
+        ray.Ng = Ng;
+        return true;
+      }
+
       /* temporarily update hit information */
       const float  ray_tfar = ray.tfar;
       const Vec3fa ray_Ng   = ray.Ng;
@@ -68,6 +92,10 @@ namespace embree
     __forceinline bool runOcclusionFilter1(const Geometry* const geometry, Ray& ray, 
                                            const float& u, const float& v, const float& t, const Vec3fa& Ng, const int geomID, const int primID)
     {
+      /* use batched filter function with a single hit if set */
+      if (geometry->hasOcclusionFilterN()) 
+        return runFilterN(geometry->occlusionFilterN,geometry,ray,u,v,t,Ng,geomID,primID);
+
       /* temporarily update hit information */
       const float ray_tfar = ray.tfar;
       const int   ray_geomID = ray.geomID;
@@ -92,6 +120,17 @@ namespace embree
       return true;
     }
     
+    __forceinline sseb runFilterN(RTCFilterFuncN filterN, const sseb& valid, const Geometry* const geometry, const Ray& ray, 
+                                  const ssef& u, const ssef& v, const ssef& t, const sse3f& Ng, const int geomID, const ssei& primID)
+    {
+      /* pass all hits to the batched filter function at once */
+      ssei valid_io = (__m128i) valid;
+      AVX_ZERO_UPPER();
+      filterN((int*)&valid_io,geometry->userPtr,(const RTCRay&)ray,geomID,(const unsigned*)&primID,
+              (const float*)&u,(const float*)&v,(const float*)&t,(const float*)&Ng.x,(const float*)&Ng.y,(const float*)&Ng.z,4);
+      return valid & (valid_io != ssei(0));
+    }
+
     __forceinline sseb runIntersectionFilter4(const sseb& valid, const Geometry* const geometry, Ray4& ray, 
                                               const ssef& u, const ssef& v, const ssef& t, const sse3f& Ng, const int geomID, const int primID)
     {
@@ -228,6 +267,16 @@ namespace embree
     }
     
 #if defined(__AVX__)
+    __forceinline avxb runFilterN(RTCFilterFuncN filterN, const avxb& valid, const Geometry* const geometry, const Ray& ray, 
+                                  const avxf& u, const avxf& v, const avxf& t, const avx3f& Ng, const int geomID, const avxi& primID)
+    {
+      /* pass all hits to the batched filter function at once */
+      avxi valid_io = (__m256i) valid;
+      filterN((int*)&valid_io,geometry->userPtr,(const RTCRay&)ray,geomID,(const unsigned*)&primID,
+              (const float*)&u,(const float*)&v,(const float*)&t,(const float*)&Ng.x,(const float*)&Ng.y,(const float*)&Ng.z,8);
+      return valid & (valid_io != avxi(0));
+    }
+
     __forceinline avxb runIntersectionFilter8(const avxb& valid, const Geometry* const geometry, Ray8& ray, 
                                               const avxf& u, const avxf& v, const avxf& t, const avx3f& Ng, const int geomID, const int primID)
     {
@@ -19,6 +19,8 @@
 #include "primitive.h"
 #include "discrete_tessellation.h"
 #include "common/subdiv/feature_adaptive_eval.h"
+#include "common/subdiv/gregory_patch.h"
+#include "common/subdiv/tessellation_cache.h"
 
 #define GRID_COMPRESS_BOUNDS 1
 
@@ -389,7 +391,7 @@ namespace embree
 	unsigned char ofs;
       };
 
-      __forceinline const BBox3fa getBounds(const size_t x0, const size_t x1, const size_t y0, const size_t y1) const 
+      static __forceinline const BBox3fa getBounds(const Grid& grid, const size_t x0, const size_t x1, const size_t y0, const size_t y1)
       {
 	BBox3fa bounds = empty;
 	for (size_t y=y0; y<=y1; y++)
@@ -403,6 +405,14 @@ namespace embree
 	: grid(grid) {}
 
       __forceinline const BBox3fa init (size_t x0, size_t x1, size_t y0, size_t y1) 
+      {
+	return init(x0,x1,y0,y1,[&] (size_t kx0, size_t kx1, size_t ky0, size_t ky1) { 
+	    return getBounds(grid,kx0,kx1,ky0,ky1); 
+	  });
+      }
+
+      template<typename GetBounds>
+      __forceinline const BBox3fa init (size_t x0, size_t x1, size_t y0, size_t y1, const GetBounds& getBounds) 
       {
 	BBox3fa box_list[16];
 
@@ -445,6 +455,38 @@ namespace embree
       const Grid& grid;
     };
 
+    /*! Leaf over two grids that tessellate the same quads at time 0
+     *  and time 1. The quad bounds enclose both time steps, the bounds
+     *  of each time step are kept for the motion blur nodes above. */
+    struct EagerLeafMB : public EagerLeaf
+    {
+      __forceinline EagerLeafMB (const Grid& grid0, const Grid& grid1) 
+	: EagerLeaf(grid0), grid1(grid1) {}
+
+      __forceinline const std::pair<BBox3fa,BBox3fa> init (size_t x0, size_t x1, size_t y0, size_t y1) 
+      {
+	EagerLeaf::init(x0,x1,y0,y1,[&] (size_t kx0, size_t kx1, size_t ky0, size_t ky1) { 
+	    return merge(getBounds(grid,kx0,kx1,ky0,ky1),getBounds(grid1,kx0,kx1,ky0,ky1));
+	  });
+	bounds0 = getBounds(grid ,x0,x1,y0,y1);
+	bounds1 = getBounds(grid1,x0,x1,y0,y1);
+	return std::pair<BBox3fa,BBox3fa>(bounds0,bounds1);
+      }
+
+      /*! returns the grid vertex interpolated to some time, the
+       *  packed UVs are taken from the first time step */
+      __forceinline const Vec3fa point(const size_t x, const size_t y, const float t) const 
+      {
+	const Vec3fa& p0 = grid .point(x,y);
+	const Vec3fa& p1 = grid1.point(x,y);
+	return copy_a((1.0f-t)*p0+t*p1,p0);
+      }
+
+      BBox3fa bounds0;    //!< bounds of the leaf at time 0
+      BBox3fa bounds1;    //!< bounds of the leaf at time 1
+      const Grid& grid1;  //!< grid at time 1
+    };
+
   public:
 
     __forceinline Grid(unsigned width, unsigned height, unsigned geomID, unsigned primID)
@@ -454,7 +496,8 @@ namespace embree
       assert(height <= 17);
     }
 
-    static __forceinline Grid* create(FastAllocator::Thread& alloc, const size_t width, const size_t height, const unsigned geomID, const unsigned primID) {
+    template<typename Allocator>
+    static __forceinline Grid* create(Allocator& alloc, const size_t width, const size_t height, const unsigned geomID, const unsigned primID) {
       return new (alloc.malloc(sizeof(Grid)-17*17*sizeof(Vec3fa)+width*height*sizeof(Vec3fa))) Grid(width,height,geomID,primID);
     }
     
@@ -661,22 +704,31 @@ namespace embree
       }
     }
 
+    /*! the normals are only evaluated if Ng is not NULL */
     template<typename Patch>
     __forceinline BBox3fa calculatePositionAndNormal(const Patch& patch, Vec2f luv[17*17], Vec3fa Ng[17*17])
     {
-      BBox3fa bounds = empty;
-      for (int y=0; y<height; y++) {
-        for (int x=0; x<width; x++) {
-	  const Vec2f& uv = luv[y*width+x];
-	  const Vec3fa P = patch.eval(uv.x,uv.y);
-	  bounds.extend(P);
-	  point(x,y)    = P;
-	  Ng[y*width+x] = normalize_safe(patch.normal(luv[y*width+x].x, luv[y*width+x].y)); // FIXME: enable only for displacement mapping
-        }
+      /* evaluate grid in blocks of SIMD width, pad last block with last valid UV */
+      const size_t N = width*height;
+      __aligned(64) float u[PatchEvalSIMD::SIZE], v[PatchEvalSIMD::SIZE];
+      for (size_t i=0; i<N; i+=PatchEvalSIMD::SIZE) 
+      {
+	for (size_t k=0; k<PatchEvalSIMD::SIZE; k++) {
+	  const size_t j = min(i+k,N-1);
+	  u[k] = luv[j].x; v[k] = luv[j].y;
+	}
+	PatchEvalSIMD::eval(patch,u,v,min(N-i,size_t(PatchEvalSIMD::SIZE)),&P[i],Ng ? &Ng[i] : NULL);
       }
+
+      BBox3fa bounds = empty;
+      for (size_t i=0; i<N; i++) bounds.extend(P[i]);
       return bounds;
     }
 
+    __forceinline BBox3fa calculatePositionAndNormal(const GregoryPatch& patch, Vec2f luv[17*17], Vec3fa Ng[17*17]) {
+      return calculatePositionAndNormal(DenseGregoryPatch(patch),luv,Ng);
+    }
+
     template<typename Patch>
     __forceinline void calculatePositionAndNormal(const Patch& patch, 
 						  const size_t x0, const size_t x1,
@@ -721,6 +773,23 @@ namespace embree
 	}
 
 
+   __forceinline size_t createEagerPrimsMB(FastAllocator::Thread& alloc, const Grid* grid1, PrimRef* prims, 
+					   const size_t x0, const size_t x1,
+					   const size_t y0, const size_t y1)
+	{
+	  size_t i=0;
+	  for (size_t y=y0; y<y1; y+=8) {
+	    for (size_t x=x0; x<x1; x+=8) {
+	      const size_t rx0 = x-x0, rx1 = min(x+8,x1)-x0;
+	      const size_t ry0 = y-y0, ry1 = min(y+8,y1)-y0;
+	      EagerLeafMB* leaf = new (alloc.malloc(sizeof(EagerLeafMB))) EagerLeafMB(*this,*grid1);
+	      const std::pair<BBox3fa,BBox3fa> bounds = leaf->init(rx0,rx1,ry0,ry1);
+	      prims[i++] = PrimRef(merge(bounds.first,bounds.second),BVH4::encodeTypedLeaf(leaf,0));
+	    }
+	  }
+	  return i;
+	}
+
     template<typename Patch>
     __forceinline void build(Scene* scene, const Patch& patch,
 			     const size_t x0, const size_t x1,
@@ -740,16 +809,16 @@ namespace embree
       /* stitch local UVs */
       stitchLocalUVs(x0,x1,y0,y1,pattern0,pattern1,pattern2,pattern3,pattern_x,pattern_y,luv);
       
-      /* evaluate position and normal */
+      /* evaluate position, the normals are only needed for displacement mapping */
+      SubdivMesh* mesh = (SubdivMesh*) scene->get(geomID);
       Vec3fa Ng[17*17];
-      calculatePositionAndNormal(patch,luv,Ng);
+      calculatePositionAndNormal(patch,luv,mesh->displFunc ? Ng : NULL);
 
       /* calculate global UVs */
       Vec2f guv[17*17]; 
       calculateGlobalUVs(uv0,uv1,uv2,uv3,luv,guv);
 
       /* perform displacement */
-      SubdivMesh* mesh = (SubdivMesh*) scene->get(geomID);
       if (mesh->displFunc) 
 	displace(scene,mesh->displFunc,mesh->userPtr,luv,guv,Ng);
     }
@@ -808,10 +877,10 @@ namespace embree
 
       /* try to approximate bounding box */
       SubdivMesh* mesh = (SubdivMesh*) scene->get(geomID);
-      const BBox3fa dbounds = mesh->displBounds;
+      const BBox3fa dbounds = mesh->getDisplacementBounds(primID);
       if (!dbounds.empty()) {
 	const BBox3fa gbounds = bounds();
-	if (all(gt_mask(8.0f*gbounds.size(),dbounds.size()))) {
+	if (mesh->hasEstimatedDisplacementBounds() || all(gt_mask(8.0f*gbounds.size(),dbounds.size()))) {
 	  return gbounds+dbounds;
 	}
       }
@@ -854,7 +923,43 @@ namespace embree
       return N;
     }
 
-    std::pair<BBox3fa,BVH4::NodeRef> createLazyPrims(FastAllocator::Thread& alloc,
+    /*! tessellates the same grids of two patches that got evaluated at
+     *  time 0 and time 1 and creates motion blur leaves over them */
+    template<typename Patch>
+    static size_t createEagerMB(unsigned geomID, unsigned primID, 
+				Scene* scene, const Patch& patch0, const Patch& patch1,
+				FastAllocator::Thread& alloc, PrimRef* prims,
+				const size_t x0, const size_t x1,
+				const size_t y0, const size_t y1,
+				const Vec2f uv[4], 
+				const DiscreteTessellationPattern& pattern0, 
+				const DiscreteTessellationPattern& pattern1, 
+				const DiscreteTessellationPattern& pattern2, 
+				const DiscreteTessellationPattern& pattern3, 
+				const DiscreteTessellationPattern& pattern_x,
+				const DiscreteTessellationPattern& pattern_y)
+    {
+      size_t N = 0;
+      for (size_t y=y0; y<y1; y+=16)
+      {
+	for (size_t x=x0; x<x1; x+=16) 
+	{
+	  const size_t lx0 = x, lx1 = min(lx0+16,x1);
+	  const size_t ly0 = y, ly1 = min(ly0+16,y1);
+	  Grid* leaf0 = Grid::create(alloc,lx1-lx0+1,ly1-ly0+1,geomID,primID);
+	  Grid* leaf1 = Grid::create(alloc,lx1-lx0+1,ly1-ly0+1,geomID,primID);
+	  leaf0->build(scene,patch0,lx0,lx1,ly0,ly1,uv[0],uv[1],uv[2],uv[3],pattern0,pattern1,pattern2,pattern3,pattern_x,pattern_y);
+	  leaf1->build(scene,patch1,lx0,lx1,ly0,ly1,uv[0],uv[1],uv[2],uv[3],pattern0,pattern1,pattern2,pattern3,pattern_x,pattern_y);
+	  size_t n = leaf0->createEagerPrimsMB(alloc,leaf1,prims,lx0,lx1,ly0,ly1);
+	  prims += n;
+	  N += n;
+	}
+      }
+      return N;
+    }
+
+    template<typename Allocator>
+    std::pair<BBox3fa,BVH4::NodeRef> createLazyPrims(Allocator& alloc,
 						     const size_t x0, const size_t x1,
 						     const size_t y0, const size_t y1)
       {
@@ -910,11 +1015,33 @@ namespace embree
 	return std::pair<BBox3fa,BVH4::NodeRef>(bounds,BVH4::encodeNode2(node));
       }
     
-    struct LazyLeaf
+    /*! allocates from a fixed memory block, used to build lazy leaves into the tessellation cache */
+    struct BlockAllocator
+    {
+      __forceinline BlockAllocator (char* ptr, size_t bytes)
+	: ptr(ptr), cur(0), end(bytes) {}
+
+      __forceinline void* malloc(size_t bytes, size_t align = 16) 
+      {
+	cur += bytes + ((align - cur) & (align-1));
+	assert(cur <= end);
+	return &ptr[cur - bytes];
+      }
+
+    private:
+      char* ptr;
+      size_t cur;
+      size_t end;
+    };
+
+    /*! Leaf that tessellates a grid of up to 16x16 quads on demand. The
+     *  grid and its sub-BVH are stored in the tessellation cache that is
+     *  shared with the cached subdivision mode, thus grids that are not
+     *  used for a while get evicted and are rebuilt when hit again. */
+    struct __aligned(64) LazyLeaf
     {
       /*! Construction from vertices and IDs. */
       __forceinline LazyLeaf (BVH4* bvh,
-			      BVH4::NodeRef* parent,
 			      const unsigned int geomID, 
 			      const unsigned int primID, 
 			      const unsigned int quadID,
@@ -923,7 +1050,7 @@ namespace embree
 			      const unsigned int y0,
 			      const unsigned int y1)
 	
-	: initializing(0), initialized(0), bvh(bvh), parent(parent), geomID(geomID), primID(primID), quadID(quadID), x0(x0), x1(x1), y0(y0), y1(y1) {}
+	: bvh(bvh), geomID(geomID), primID(primID), quadID(quadID), x0(x0), x1(x1), y0(y0), y1(y1) {}
     
 
       __forceinline BBox3fa bounds()
@@ -962,21 +1089,32 @@ namespace embree
 	return box;
       }
 
-      __forceinline size_t initialize()
+      /*! returns the root of the sub-BVH over the grid, builds the grid
+       *  into the tessellation cache if it is not cached */
+      __forceinline size_t initialize(SharedTessellationCache::ThreadState* thread_state)
       {
-	/* let only one thread lazily build this object */
-	if (atomic_add(&initializing,1) != 0) {
-	  while (!initialized) __pause_cpu();
-	  return (size_t)*parent;
-	}
+	Scene* scene = bvh->scene;
+	const unsigned int commitCounter = scene->commitCounter;
+
+	/* the sub-BVH of the previous leaf got already traversed, thus
+	 * the ray references no cache entry and can enter the current cache time */
+	unsigned int time;
+	SharedTessellationCache::Storage* storage = sharedTessellationCache.lockThread(thread_state,time);
+	const size_t root = sharedTessellationCache.lookup(thread_state,storage,this,commitCounter,time);
+	if (likely(root != SharedTessellationCache::CACHE_MISS))
+	  return root;
+
+	/* reserve space for the grid, one inner node, and four leaves */
+	const size_t bytes  = sizeof(Grid) + sizeof(BVH4::Node) + 4*sizeof(EagerLeaf) + 6*16;
+	const size_t blocks = (bytes+63)/64;
+	unsigned int entryTime;
+	SharedTessellationCache::EntryHeader* entry = sharedTessellationCache.alloc(thread_state,storage,1+blocks,entryTime);
+	BlockAllocator alloc((char*)(entry+1),64*blocks);
 
 	/* build sub-BVH */
-	Scene* scene = bvh->scene;
 	SubdivMesh* mesh = scene->getSubdivMesh(geomID);
 	BVH4::NodeRef node = BVH4::emptyNode;
 
-	FastAllocator::Thread& alloc = *bvh->alloc2.instance();
-	
 	feature_adaptive_subdivision_eval(mesh->getHalfEdge(primID),mesh->getVertexBuffer(), // FIXME: only recurse into one sub-quad
 					  [&](const CatmullClarkPatch& patch, const Vec2f uv[4], const int subdiv[4], const int id)
 	{
@@ -999,20 +1137,12 @@ namespace embree
 	  node = leaf->createLazyPrims(alloc,0,x1-x0,0,y1-y0).second;
 	});
 	
-	/* link to sub-BVH */
-	*parent = node;
-	__memory_barrier();
-	initialized = 1;
+	sharedTessellationCache.insert(storage,entry,entryTime,this,commitCounter,node);
 	return (size_t)node;
       }
       
-    public:
-      volatile atomic_t initializing; // FIXME: reduce size
-      volatile char initialized; 
-            
     public:
       BVH4* bvh;
-      BVH4::NodeRef* parent;
       unsigned int geomID;
       unsigned int primID;
       unsigned short quadID;
@@ -1022,7 +1152,7 @@ namespace embree
       unsigned short y1;
     };
     
-    static size_t createLazy(BVH4* bvh, BVH4::NodeRef* parent, unsigned geomID, unsigned primID, unsigned quadID, unsigned width, unsigned height, 
+    static size_t createLazy(BVH4* bvh, unsigned geomID, unsigned primID, unsigned quadID, unsigned width, unsigned height, 
 			     FastAllocator::Thread& alloc, PrimRef* prims)
     {
       size_t N = 0;
@@ -1032,13 +1162,23 @@ namespace embree
 	{
 	  const size_t lx0 = x, lx1 = min(lx0+16,width);
 	  const size_t ly0 = y, ly1 = min(ly0+16,height);
-	  LazyLeaf* leaf = new (alloc.malloc(sizeof(LazyLeaf))) LazyLeaf(bvh,parent,geomID,primID,quadID,lx0,lx1,ly0,ly1);
+	  LazyLeaf* leaf = new (alloc.malloc(sizeof(LazyLeaf),64)) LazyLeaf(bvh,geomID,primID,quadID,lx0,lx1,ly0,ly1);
 	  const BBox3fa bounds = leaf->bounds();
 	  prims[N++] = PrimRef(bounds,BVH4::encodeTypedLeaf(leaf,1));
 	}
       }
       return N;
     }
+
+    /*! primitive type of the grid accels, their leaves are typed and differ in size */
+    struct Type : public PrimitiveType 
+    {
+      Type ();
+      size_t blocks(size_t x) const; 
+      size_t size(const char* This) const;
+    };
+
+    static Type type;
     
   public:
     unsigned width;
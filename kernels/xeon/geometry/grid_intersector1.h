@@ -28,16 +28,25 @@ namespace embree
     {
       typedef Grid::LazyLeaf Primitive;
       
-      struct Precalculations {
-        __forceinline Precalculations (const Ray& ray) {}
+      struct Precalculations 
+      {
+        __forceinline Precalculations (const Ray& ray) {
+          thread_state = sharedTessellationCache.enterThread();
+        }
+
+        __forceinline ~Precalculations() {
+          sharedTessellationCache.leaveThread(thread_state);
+        }
+
+        SharedTessellationCache::ThreadState* thread_state;
       };
       
       static __forceinline void intersect(const Precalculations& pre, Ray& ray, Primitive& prim, const Scene* scene, size_t& lazy_node) {
-        lazy_node = prim.initialize();
+        lazy_node = prim.initialize(pre.thread_state);
       }
       
       static __forceinline bool occluded(const Precalculations& pre, Ray& ray, Primitive& prim, const Scene* scene, size_t& lazy_node) {
-        lazy_node = prim.initialize();
+        lazy_node = prim.initialize(pre.thread_state);
         return false;
       }
     };
@@ -491,5 +500,136 @@ namespace embree
         return occluded(pre,ray,prim[0],scene,lazy_node);
       }
     };
+
+    struct GridMBIntersector1 : public GridIntersector1
+    {
+      typedef Grid::EagerLeafMB Primitive;
+
+      /*! Intersect a ray with the grid interpolated to the time of the ray and updates the hit. */
+      static __forceinline void intersect(const Precalculations& pre, Ray& ray, const Primitive& prim, const Scene* scene, size_t& lazy_node)
+      {
+        STAT3(normal.trav_prims,1,1,1);
+        
+#if defined (__AVX__)
+        
+        /* perform box tests against bounds of both time steps */
+        const avxf ray_tfar(ray.tfar);
+        size_t mask = prim.bounds.intersect<false>(pre.nearX, pre.nearY, pre.nearZ, pre.org, pre.rdir, pre.org_rdir, pre.ray_tnear, ray_tfar);
+        
+#else
+        
+        /* perform box tests against bounds of both time steps */
+        const ssef ray_tfar(ray.tfar);
+        size_t mask = prim.bounds.intersect<false>(pre.nearX, pre.nearY, pre.nearZ, pre.org, pre.rdir, pre.org_rdir, pre.ray_tnear, ray_tfar);
+        
+#endif
+        
+        /* intersect quad-quads */
+        const float t = ray.time;
+        while (mask) 
+        {
+          const size_t i = __bscf(mask);
+          const size_t ofs = prim.quads[i].ofs;
+          switch (prim.quads[i].type) {
+          case Grid::EagerLeaf::Quads::QUAD1X1: {
+            const Vec3fa v00 = prim.point(ofs,0,t), v10 = prim.point(ofs+1,0,t);
+            const Vec3fa v01 = prim.point(ofs,1,t), v11 = prim.point(ofs+1,1,t);
+            intersectQuad(ray, v00,v10,v01,v11, prim);
+            break;
+          }
+          case Grid::EagerLeaf::Quads::QUAD1X2: {
+            const Vec3fa v00 = prim.point(ofs,0,t), v10 = prim.point(ofs+1,0,t);
+            const Vec3fa v01 = prim.point(ofs,1,t), v11 = prim.point(ofs+1,1,t);
+            const Vec3fa v02 = prim.point(ofs,2,t), v12 = prim.point(ofs+1,2,t);
+            intersectQuads(ray, v10,v11,v12, v00,v01,v02, prim);
+            break;
+          }
+          case Grid::EagerLeaf::Quads::QUAD2X1: {
+            const Vec3fa v00 = prim.point(ofs,0,t), v10 = prim.point(ofs+1,0,t), v20 = prim.point(ofs+2,0,t);
+            const Vec3fa v01 = prim.point(ofs,1,t), v11 = prim.point(ofs+1,1,t), v21 = prim.point(ofs+2,1,t);
+            intersectQuads(ray, v00,v10,v20,v01,v11,v21, prim);
+            break;
+          }
+          case Grid::EagerLeaf::Quads::QUAD2X2: {
+            const Vec3fa v00 = prim.point(ofs,0,t), v10 = prim.point(ofs+1,0,t), v20 = prim.point(ofs+2,0,t);
+            const Vec3fa v01 = prim.point(ofs,1,t), v11 = prim.point(ofs+1,1,t), v21 = prim.point(ofs+2,1,t);
+            const Vec3fa v02 = prim.point(ofs,2,t), v12 = prim.point(ofs+1,2,t), v22 = prim.point(ofs+2,2,t);
+            intersectQuads(ray, v00,v10,v20,v01,v11,v21,v02,v12,v22, prim);
+            break;
+          }
+          default: assert(false);  
+          }
+        }
+      }
+      
+      /*! Intersect a ray with the grid interpolated to the time of the ray and updates the hit. */
+      static __forceinline void intersect(const Precalculations& pre, Ray& ray, const Primitive* prim, size_t ty, const Scene* scene, size_t& lazy_node) {
+        intersect(pre,ray,prim[0],scene,lazy_node);
+      }    
+
+      /*! Test if the ray is occluded by the grid interpolated to the time of the ray */
+      static __forceinline bool occluded(const Precalculations& pre, Ray& ray, const Primitive& prim, const Scene* scene, size_t& lazy_node)
+      {
+        STAT3(shadow.trav_prims,1,1,1);
+        
+#if defined (__AVX__)
+        
+        /* perform box tests against bounds of both time steps */
+        const avxf ray_tfar(ray.tfar);
+        size_t mask = prim.bounds.intersect<false>(pre.nearX, pre.nearY, pre.nearZ, pre.org, pre.rdir, pre.org_rdir, pre.ray_tnear, ray_tfar);
+        
+#else
+        
+        /* perform box tests against bounds of both time steps */
+        const ssef ray_tfar(ray.tfar);
+        size_t mask = prim.bounds.intersect<false>(pre.nearX, pre.nearY, pre.nearZ, pre.org, pre.rdir, pre.org_rdir, pre.ray_tnear, ray_tfar);
+        
+#endif
+        
+        /* intersect quad-quads */
+        const float t = ray.time;
+        while (mask) 
+        {
+          const size_t i = __bscf(mask);
+          const size_t ofs = prim.quads[i].ofs;
+          switch (prim.quads[i].type) {
+          case Grid::EagerLeaf::Quads::QUAD1X1: {
+            const Vec3fa v00 = prim.point(ofs,0,t), v10 = prim.point(ofs+1,0,t);
+            const Vec3fa v01 = prim.point(ofs,1,t), v11 = prim.point(ofs+1,1,t);
+            if (occludedQuad(ray, v00,v10,v01,v11, prim)) return true;
+            break;
+          }
+          case Grid::EagerLeaf::Quads::QUAD1X2: {
+            const Vec3fa v00 = prim.point(ofs,0,t), v10 = prim.point(ofs+1,0,t);
+            const Vec3fa v01 = prim.point(ofs,1,t), v11 = prim.point(ofs+1,1,t);
+            const Vec3fa v02 = prim.point(ofs,2,t), v12 = prim.point(ofs+1,2,t);
+            if (occludedQuads(ray, v10,v11,v12,v00,v01,v02, prim)) return true;
+            break;
+          }
+          case Grid::EagerLeaf::Quads::QUAD2X1: {
+            const Vec3fa v00 = prim.point(ofs,0,t), v10 = prim.point(ofs+1,0,t), v20 = prim.point(ofs+2,0,t);
+            const Vec3fa v01 = prim.point(ofs,1,t), v11 = prim.point(ofs+1,1,t), v21 = prim.point(ofs+2,1,t);
+            if (occludedQuads(ray, v00,v10,v20,v01,v11,v21, prim)) return true;
+            break;
+          }
+          case Grid::EagerLeaf::Quads::QUAD2X2: {
+            const Vec3fa v00 = prim.point(ofs,0,t), v10 = prim.point(ofs+1,0,t), v20 = prim.point(ofs+2,0,t);
+            const Vec3fa v01 = prim.point(ofs,1,t), v11 = prim.point(ofs+1,1,t), v21 = prim.point(ofs+2,1,t);
+            const Vec3fa v02 = prim.point(ofs,2,t), v12 = prim.point(ofs+1,2,t), v22 = prim.point(ofs+2,2,t);
+            if (occludedQuads(ray, v00,v10,v20,v01,v11,v21,v02,v12,v22, prim)) return true;
+            break;
+          }
+          default: assert(false);  
+          }
+        }
+        
+        return false;
+      }
+      
+      /*! Test if the ray is occluded by the grid interpolated to the time of the ray */
+      static __forceinline bool occluded(const Precalculations& pre, Ray& ray, const Primitive* prim, size_t ty, const Scene* scene, size_t& lazy_node) {
+        return occluded(pre,ray,prim[0],scene,lazy_node);
+      }
+    };
   }
 }
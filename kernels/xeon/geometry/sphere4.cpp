@@ -0,0 +1,43 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "sphere4.h"
+#if defined(__TARGET_AVX__)
+#include "sphere8.h"
+#endif
+
+namespace embree
+{
+  Sphere4Type Sphere4Type::type;
+
+  Sphere4Type::Sphere4Type () 
+    : PrimitiveType("sphere4",sizeof(Sphere4),4,false,1) {} 
+
+#if defined(__TARGET_AVX__)
+  Sphere8Type Sphere8Type::type;
+
+  Sphere8Type::Sphere8Type () 
+    : PrimitiveType("sphere8",2*sizeof(Sphere4),8,false,1) {}
+#endif
+  
+  size_t Sphere4Type::blocks(size_t x) const {
+    return (x+3)/4;
+  }
+  
+  size_t Sphere4Type::size(const char* This) const {
+    return ((Sphere4*)This)->size();
+  }
+}
@@ -0,0 +1,174 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "primitive.h"
+
+namespace embree
+{
+  /*! Stores 4 spheres in struct of array layout. */
+  struct Sphere4
+  {
+  public:
+
+    /*! Default constructor. */
+    __forceinline Sphere4 () {}
+
+    /*! Construction from centers, radii, and IDs. */
+    __forceinline Sphere4 (const sse3f& p, const ssef& r, const ssei& geomIDs, const ssei& primIDs, const ssei& mask, const bool last)
+      : p(p), r(r), geomIDs(geomIDs), primIDs(primIDs | (last << 31))
+    {
+#if defined(RTCORE_RAY_MASK)
+      this->mask = mask;
+#endif
+    }
+
+    /*! Returns if the specified sphere is valid. */
+    __forceinline bool valid(const size_t i) const { 
+      assert(i<4); 
+      return geomIDs[i] != -1; 
+    }
+
+    /*! Returns a mask that tells which spheres are valid. */
+    __forceinline sseb valid() const { return geomIDs != ssei(-1); }
+
+    /*! Returns the number of stored spheres. */
+    __forceinline size_t size() const {
+      return bitscan(~movemask(valid()));
+    }
+
+    /*! calculate the bounds of the spheres */
+    __forceinline BBox3fa bounds() const 
+    {
+      sse3f lower = p-sse3f(r);
+      sse3f upper = p+sse3f(r);
+      sseb mask = valid();
+      lower.x = select(mask,lower.x,ssef(pos_inf));
+      lower.y = select(mask,lower.y,ssef(pos_inf));
+      lower.z = select(mask,lower.z,ssef(pos_inf));
+      upper.x = select(mask,upper.x,ssef(neg_inf));
+      upper.y = select(mask,upper.y,ssef(neg_inf));
+      upper.z = select(mask,upper.z,ssef(neg_inf));
+      return BBox3fa(Vec3fa(reduce_min(lower.x),reduce_min(lower.y),reduce_min(lower.z)),
+                     Vec3fa(reduce_max(upper.x),reduce_max(upper.y),reduce_max(upper.z)));
+    }
+
+    /*! non temporal store */
+    __forceinline static void store_nt(Sphere4* dst, const Sphere4& src)
+    {
+      store4f_nt(&dst->p.x,src.p.x);
+      store4f_nt(&dst->p.y,src.p.y);
+      store4f_nt(&dst->p.z,src.p.z);
+      store4f_nt(&dst->r,src.r);
+      store4i_nt(&dst->geomIDs,src.geomIDs);
+      store4i_nt(&dst->primIDs,src.primIDs);
+#if defined(RTCORE_RAY_MASK)
+      store4i_nt(&dst->mask,src.mask);
+#endif
+    }
+
+    /*! returns required number of primitive blocks for N primitives */
+    static __forceinline size_t blocks(size_t N) { return (N+3)/4; }
+
+    /*! checks if this is the last sphere in the list */
+    __forceinline int last() const { 
+      return primIDs[0] & 0x80000000; 
+    }
+
+    /*! returns the geometry IDs */
+    template<bool list>
+    __forceinline ssei geomID() const { 
+      return geomIDs; 
+    }
+    template<bool list>
+    __forceinline int geomID(const size_t i) const { 
+      assert(i<4); return geomIDs[i]; 
+    }
+
+    /*! returns the primitive IDs */
+    template<bool list>
+    __forceinline ssei primID() const { 
+      if (list) return primIDs & 0x7FFFFFFF; 
+      else      return primIDs;
+    }
+    template<bool list>
+    __forceinline int  primID(const size_t i) const { 
+      assert(i<4); 
+      if (list) return primIDs[i] & 0x7FFFFFFF; 
+      else      return primIDs[i];
+    }
+
+    /*! fill sphere from sphere list */
+    __forceinline void fill(atomic_set<PrimRefBlock>::block_iterator_unsafe& prims, Scene* scene, const bool list)
+    {
+      ssei vgeomID = -1, vprimID = -1, vmask = -1;
+      sse3f p = zero; ssef r = zero;
+      
+      for (size_t i=0; i<4 && prims; i++, prims++)
+      {
+	const PrimRef& prim = *prims;
+	const size_t geomID = prim.geomID();
+        const size_t primID = prim.primID();
+        const Points* __restrict__ const points = scene->getPoints(geomID);
+        const Vec3fa& c = points->vertex(primID);
+        vgeomID [i] = geomID;
+        vprimID [i] = primID;
+        vmask   [i] = points->mask;
+        p.x[i] = c.x; p.y[i] = c.y; p.z[i] = c.z; r[i] = points->radius(primID);
+      }
+      Sphere4::store_nt(this,Sphere4(p,r,vgeomID,vprimID,vmask,list && !prims));
+    }
+
+    /*! fill sphere from sphere array */
+    __forceinline void fill(const PrimRef* prims, size_t& begin, size_t end, Scene* scene, const bool list)
+    {
+      ssei vgeomID = -1, vprimID = -1, vmask = -1;
+      sse3f p = zero; ssef r = zero;
+      
+      for (size_t i=0; i<4 && begin<end; i++, begin++)
+      {
+	const PrimRef& prim = prims[begin];
+        const size_t geomID = prim.geomID();
+        const size_t primID = prim.primID();
+        const Points* __restrict__ const points = scene->getPoints(geomID);
+        const Vec3fa& c = points->vertex(primID);
+        vgeomID [i] = geomID;
+        vprimID [i] = primID;
+        vmask   [i] = points->mask;
+        p.x[i] = c.x; p.y[i] = c.y; p.z[i] = c.z; r[i] = points->radius(primID);
+      }
+      Sphere4::store_nt(this,Sphere4(p,r,vgeomID,vprimID,vmask,list && begin>=end));
+    }
+    
+  public:
+    sse3f p;        //!< Centers of the spheres.
+    ssef r;         //!< Radii of the spheres.
+    ssei geomIDs;   //!< user geometry ID
+    ssei primIDs;   //!< primitive ID
+#if defined(RTCORE_RAY_MASK)
+    ssei mask;      //!< geometry mask
+#endif
+  };
+
+  struct Sphere4Type : public PrimitiveType 
+  {
+    static Sphere4Type type;
+    Sphere4Type ();
+    size_t blocks(size_t x) const;
+    size_t size(const char* This) const;
+  };
+}
@@ -0,0 +1,128 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "sphere4.h"
+#include "sphere4_intersector1.h"
+#include "../common/ray4.h"
+
+namespace embree
+{
+  namespace isa
+  {
+    /*! Intersector for 4 spheres with 4 rays. Each sphere is
+     *  broadcast and tested against all active rays of the packet. */
+    template<bool list>
+      struct Sphere4Intersector4
+      {
+        typedef Sphere4 Primitive;
+        
+        struct Precalculations {
+          __forceinline Precalculations (const sseb& valid, const Ray4& ray) {}
+        };
+        
+        /*! Intersects 4 rays with 4 spheres. */
+        static __forceinline void intersect(const sseb& valid_i, Precalculations& pre, Ray4& ray, const Primitive& sphere, Scene* scene)
+        {
+          for (size_t i=0; i<4; i++)
+          {
+            if (!sphere.valid(i)) break;
+            STAT3(normal.trav_prims,1,popcnt(valid_i),4);
+            
+            /* calculate discriminant */
+            sseb valid = valid_i;
+            const sse3f O = ray.org - broadcast4f(sphere.p,i);
+            const ssef r = ssef(sphere.r[i]);
+            const ssef A = dot(ray.dir,ray.dir);
+            const ssef B = dot(O,ray.dir);
+            const ssef C = dot(O,O) - r*r;
+            const ssef disc = B*B - A*C;
+            valid &= disc >= 0.0f;
+            if (likely(none(valid))) continue;
+            
+            /* perform depth test, use far hit if ray starts inside */
+            const ssef Q = sqrt(disc);
+            const ssef t0 = (-B-Q)/A;
+            const ssef t1 = (-B+Q)/A;
+            const sseb valid0 = valid & (t0 > ray.tnear) & (t0 < ray.tfar);
+            const sseb valid1 = valid & (t1 > ray.tnear) & (t1 < ray.tfar);
+            valid = valid0 | valid1;
+            if (likely(none(valid))) continue;
+            
+            /* ray masking test */
+#if defined(RTCORE_RAY_MASK)
+            valid &= (sphere.mask[i] & ray.mask) != 0;
+            if (unlikely(none(valid))) continue;
+#endif
+            
+            /* update hit information */
+            const ssef t = select(valid0,t0,t1);
+            const sse3f Ng = O + t*ray.dir;
+            store4f(valid,&ray.u,ssef(zero));
+            store4f(valid,&ray.v,ssef(zero));
+            store4f(valid,&ray.tfar,t);
+            store4i(valid,&ray.geomID,sphere.geomID<list>(i));
+            store4i(valid,&ray.primID,sphere.primID<list>(i));
+            store4f(valid,&ray.Ng.x,Ng.x);
+            store4f(valid,&ray.Ng.y,Ng.y);
+            store4f(valid,&ray.Ng.z,Ng.z);
+          }
+        }
+        
+        /*! Test for 4 rays if they are occluded by any of the 4 spheres. */
+        static __forceinline sseb occluded(const sseb& valid_i, Precalculations& pre, Ray4& ray, const Primitive& sphere, Scene* scene)
+        {
+          sseb valid0 = valid_i;
+          
+          for (size_t i=0; i<4; i++)
+          {
+            if (!sphere.valid(i)) break;
+            STAT3(shadow.trav_prims,1,popcnt(valid0),4);
+            
+            /* calculate discriminant */
+            sseb valid = valid0;
+            const sse3f O = ray.org - broadcast4f(sphere.p,i);
+            const ssef r = ssef(sphere.r[i]);
+            const ssef A = dot(ray.dir,ray.dir);
+            const ssef B = dot(O,ray.dir);
+            const ssef C = dot(O,O) - r*r;
+            const ssef disc = B*B - A*C;
+            valid &= disc >= 0.0f;
+            if (likely(none(valid))) continue;
+            
+            /* perform depth test */
+            const ssef Q = sqrt(disc);
+            const ssef t0 = (-B-Q)/A;
+            const ssef t1 = (-B+Q)/A;
+            valid &= ((t0 > ray.tnear) & (t0 < ray.tfar)) | ((t1 > ray.tnear) & (t1 < ray.tfar));
+            if (likely(none(valid))) continue;
+            
+            /* ray masking test */
+#if defined(RTCORE_RAY_MASK)
+            valid &= (sphere.mask[i] & ray.mask) != 0;
+            if (unlikely(none(valid))) continue;
+#endif
+            
+            /* update occlusion */
+            valid0 &= !valid;
+            if (none(valid0)) break;
+          }
+          return !valid0;
+        }
+      };
+  }
+}
@@ -0,0 +1,111 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "sphere8.h"
+#include "common/ray.h"
+
+namespace embree
+{
+  namespace isa
+  {
+    /*! Intersector for a single ray with 8 spheres. The ray is
+     *  inserted into the implicit sphere equation and the resulting
+     *  quadratic equation is solved for all 8 spheres in parallel. */
+    template<bool list>
+      struct Sphere8Intersector1
+      {
+        typedef Sphere8 Primitive;
+        
+        struct Precalculations {
+          __forceinline Precalculations (const Ray& ray) {}
+        };
+        
+        /*! Intersect a ray with the 8 spheres and updates the hit. */
+        static __forceinline void intersect(const Precalculations& pre, Ray& ray, const Primitive& sphere, Scene* scene)
+        {
+          /* calculate discriminant */
+          STAT3(normal.trav_prims,1,1,1);
+          const avx3f O = avx3f(ray.org) - sphere.p;
+          const avx3f D = avx3f(ray.dir);
+          const avxf A = dot(D,D);
+          const avxf B = dot(O,D);
+          const avxf C = dot(O,O) - sphere.r*sphere.r;
+          const avxf disc = B*B - A*C;
+          avxb valid = sphere.valid() & (disc >= 0.0f);
+          if (likely(none(valid))) return;
+          
+          /* perform depth test, use far hit if ray starts inside */
+          const avxf Q = sqrt(disc);
+          const avxf t0 = (-B-Q)/A;
+          const avxf t1 = (-B+Q)/A;
+          const avxb valid0 = valid & (t0 > avxf(ray.tnear)) & (t0 < avxf(ray.tfar));
+          const avxb valid1 = valid & (t1 > avxf(ray.tnear)) & (t1 < avxf(ray.tfar));
+          valid = valid0 | valid1;
+          if (likely(none(valid))) return;
+          
+          /* ray masking test */
+#if defined(RTCORE_RAY_MASK)
+          valid &= (sphere.mask & ray.mask) != 0;
+          if (unlikely(none(valid))) return;
+#endif
+          
+          /* update hit information */
+          const avxf t = select(valid0,t0,t1);
+          const size_t i = select_min(valid,t);
+          const Vec3fa Ng = ray.org + t[i]*ray.dir - Vec3fa(sphere.p.x[i],sphere.p.y[i],sphere.p.z[i]);
+          ray.u = 0.0f;
+          ray.v = 0.0f;
+          ray.tfar = t[i];
+          ray.Ng.x = Ng.x;
+          ray.Ng.y = Ng.y;
+          ray.Ng.z = Ng.z;
+          ray.geomID = sphere.geomID<list>(i);
+          ray.primID = sphere.primID<list>(i);
+        }
+        
+        /*! Test if the ray is occluded by one of the spheres. */
+        static __forceinline bool occluded(const Precalculations& pre, Ray& ray, const Primitive& sphere, Scene* scene)
+        {
+          /* calculate discriminant */
+          STAT3(shadow.trav_prims,1,1,1);
+          const avx3f O = avx3f(ray.org) - sphere.p;
+          const avx3f D = avx3f(ray.dir);
+          const avxf A = dot(D,D);
+          const avxf B = dot(O,D);
+          const avxf C = dot(O,O) - sphere.r*sphere.r;
+          const avxf disc = B*B - A*C;
+          avxb valid = sphere.valid() & (disc >= 0.0f);
+          if (likely(none(valid))) return false;
+          
+          /* perform depth test */
+          const avxf Q = sqrt(disc);
+          const avxf t0 = (-B-Q)/A;
+          const avxf t1 = (-B+Q)/A;
+          valid &= ((t0 > avxf(ray.tnear)) & (t0 < avxf(ray.tfar))) | ((t1 > avxf(ray.tnear)) & (t1 < avxf(ray.tfar)));
+          if (likely(none(valid))) return false;
+          
+          /* ray masking test */
+#if defined(RTCORE_RAY_MASK)
+          valid &= (sphere.mask & ray.mask) != 0;
+          if (unlikely(none(valid))) return false;
+#endif
+          return true;
+        }
+      };
+  }
+}
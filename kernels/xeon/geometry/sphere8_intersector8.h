@@ -0,0 +1,128 @@
+// ======================================================================== //
+// Copyright 2009-2014 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "sphere8.h"
+#include "sphere8_intersector1.h"
+#include "../common/ray8.h"
+
+namespace embree
+{
+  namespace isa
+  {
+    /*! Intersector for 8 spheres with 8 rays. Each sphere is
+     *  broadcast and tested against all active rays of the packet. */
+    template<bool list>
+      struct Sphere8Intersector8
+      {
+        typedef Sphere8 Primitive;
+        
+        struct Precalculations {
+          __forceinline Precalculations (const avxb& valid, const Ray8& ray) {}
+        };
+        
+        /*! Intersects 8 rays with 8 spheres. */
+        static __forceinline void intersect(const avxb& valid_i, Precalculations& pre, Ray8& ray, const Primitive& sphere, Scene* scene)
+        {
+          for (size_t i=0; i<8; i++)
+          {
+            if (!sphere.valid(i)) break;
+            STAT3(normal.trav_prims,1,popcnt(valid_i),8);
+            
+            /* calculate discriminant */
+            avxb valid = valid_i;
+            const avx3f O = ray.org - broadcast8f(sphere.p,i);
+            const avxf r = avxf(sphere.r[i]);
+            const avxf A = dot(ray.dir,ray.dir);
+            const avxf B = dot(O,ray.dir);
+            const avxf C = dot(O,O) - r*r;
+            const avxf disc = B*B - A*C;
+            valid &= disc >= 0.0f;
+            if (likely(none(valid))) continue;
+            
+            /* perform depth test, use far hit if ray starts inside */
+            const avxf Q = sqrt(disc);
+            const avxf t0 = (-B-Q)/A;
+            const avxf t1 = (-B+Q)/A;
+            const avxb valid0 = valid & (t0 > ray.tnear) & (t0 < ray.tfar);
+            const avxb valid1 = valid & (t1 > ray.tnear) & (t1 < ray.tfar);
+            valid = valid0 | valid1;
+            if (likely(none(valid))) continue;
+            
+            /* ray masking test */
+#if defined(RTCORE_RAY_MASK)
+            valid &= (sphere.mask[i] & ray.mask) != 0;
+            if (unlikely(none(valid))) continue;
+#endif
+            
+            /* update hit information */
+            const avxf t = select(valid0,t0,t1);
+            const avx3f Ng = O + t*ray.dir;
+            store8f(valid,&ray.u,avxf(zero));
+            store8f(valid,&ray.v,avxf(zero));
+            store8f(valid,&ray.tfar,t);
+            store8i(valid,&ray.geomID,sphere.geomID<list>(i));
+            store8i(valid,&ray.primID,sphere.primID<list>(i));
+            store8f(valid,&ray.Ng.x,Ng.x);
+            store8f(valid,&ray.Ng.y,Ng.y);
+            store8f(valid,&ray.Ng.z,Ng.z);
+          }
+        }
+        
+        /*! Test for 8 rays if they are occluded by any of the 8 spheres. */
+        static __forceinline avxb occluded(const avxb& valid_i, Precalculations& pre, Ray8& ray, const Primitive& sphere, Scene* scene)
+        {
+          avxb valid0 = valid_i;
+          
+          for (size_t i=0; i<8; i++)
+          {
+            if (!sphere.valid(i)) break;
+            STAT3(shadow.trav_prims,1,popcnt(valid0),8);
+            
+            /* calculate discriminant */
+            avxb valid = valid0;
+            const avx3f O = ray.org - broadcast8f(sphere.p,i);
+            const avxf r = avxf(sphere.r[i]);
+            const avxf A = dot(ray.dir,ray.dir);
+            const avxf B = dot(O,ray.dir);
+            const avxf C = dot(O,O) - r*r;
+            const avxf disc = B*B - A*C;
+            valid &= disc >= 0.0f;
+            if (likely(none(valid))) continue;
+            
+            /* perform depth test */
+            const avxf Q = sqrt(disc);
+            const avxf t0 = (-B-Q)/A;
+            const avxf t1 = (-B+Q)/A;
+            valid &= ((t0 > ray.tnear) & (t0 < ray.tfar)) | ((t1 > ray.tnear) & (t1 < ray.tfar));
+            if (likely(none(valid))) continue;
+            
+            /* ray masking test */
+#if defined(RTCORE_RAY_MASK)
+            valid &= (sphere.mask[i] & ray.mask) != 0;
+            if (unlikely(none(valid))) continue;
+#endif
+            
+            /* update occlusion */
+            valid0 &= !valid;
+            if (none(valid0)) break;
+          }
+          return !valid0;
+        }
+      };
+  }
+}
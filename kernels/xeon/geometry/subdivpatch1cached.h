@@ -34,6 +34,15 @@ namespace embree
       {
       }
 
+  SubdivPatch1Cached (const Vec3fa controlPoints[16],
+                      const unsigned int gID,
+                      const unsigned int pID,
+                      const SubdivMesh *const mesh,
+                      const Vec2f uv[4],
+                      const float edge_level[4]) : SubdivPatch1Base(controlPoints,gID,pID,mesh,uv,edge_level)
+      {
+      }
+
     struct Type : public PrimitiveType 
     {
       Type ();
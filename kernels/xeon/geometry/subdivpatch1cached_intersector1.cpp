@@ -25,8 +25,6 @@ namespace embree
   namespace isa
   {  
     
-    __thread TessellationCache *SubdivPatch1CachedIntersector1::thread_cache = NULL;
-    
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -228,19 +226,5 @@ namespace embree
       return bounds;
     }
     
-    void SubdivPatch1CachedIntersector1::createTessellationCache()
-    {
-      TessellationCache *cache = (TessellationCache *)_mm_malloc(sizeof(TessellationCache),64);
-      assert( (size_t)cache % 64 == 0 );
-      cache->init();	
-#if defined(DEBUG) && 0
-      static AtomicMutex mtx;
-      mtx.lock();
-      std::cout << "Enabling tessellation cache with " << cache->allocated64ByteBlocks() << " blocks = " << cache->allocated64ByteBlocks()*64 << " bytes as default size" << std::endl;
-      mtx.unlock();
-#endif
-      thread_cache = cache;
-    }
-    
   };
 }
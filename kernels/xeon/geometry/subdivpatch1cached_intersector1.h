@@ -36,12 +36,6 @@ namespace embree
     public:
       typedef SubdivPatch1Cached Primitive;
       
-      /*! Per thread tessellation cache */
-      static __thread TessellationCache *thread_cache;
-      
-      /*! Creates per thread tessellation cache */
-      static void createTessellationCache();
-      
       /*! Precalculations for subdiv patch intersection */
       class Precalculations {
 	  public:
@@ -49,7 +43,7 @@ namespace embree
         Vec3fa ray_org_rdir;
         SubdivPatch1Cached *current_patch;
         SubdivPatch1Cached *hit_patch;
-        TessellationCache *local_cache;      
+        SharedTessellationCache::ThreadState *thread_state;
         Ray &r;
         
         
@@ -60,17 +54,14 @@ namespace embree
           current_patch = NULL;
           hit_patch     = NULL;
 
-          /*! Initialize per thread tessellation cache */
-          if (unlikely(!thread_cache))
-            createTessellationCache();
-          
-          local_cache = thread_cache;
-          assert(local_cache != NULL);
+          thread_state  = sharedTessellationCache.enterThread();
         }
 
           /*! Final per ray computations like smooth normal, patch u,v, etc. */        
         __forceinline ~Precalculations() 
         {
+          sharedTessellationCache.leaveThread(thread_state);
+
           if (unlikely(hit_patch != NULL))
           {
 
@@ -359,20 +350,25 @@ namespace embree
       
       
       /*! Returns BVH4 node reference for subtree over patch grid */
-      static __forceinline size_t getSubtreeRootNode(TessellationCache *local_cache, const SubdivPatch1Cached* const subdiv_patch, const void* geom)
+      static __forceinline size_t getSubtreeRootNode(SharedTessellationCache::ThreadState *thread_state, const SubdivPatch1Cached* const subdiv_patch, const void* geom)
       {
         const unsigned int commitCounter = ((Scene*)geom)->commitCounter;
-        TessellationCache::InputTagType tag = (TessellationCache::InputTagType)subdiv_patch;
+
+        /* the subtree of the previous patch got already traversed, thus
+         * the ray references no cache entry and can enter the current cache time */
+        unsigned int time;
+        SharedTessellationCache::Storage* storage = sharedTessellationCache.lockThread(thread_state,time);
         
-        BVH4::NodeRef root = local_cache->lookup(tag,commitCounter);
+        BVH4::NodeRef root = sharedTessellationCache.lookup(thread_state,storage,subdiv_patch,commitCounter,time);
         root.prefetch(0);
         if (unlikely(root == (size_t)-1))
         {
           subdiv_patch->prefetchData();
           const unsigned int blocks = subdiv_patch->grid_subtree_size_64b_blocks;
           
-          TessellationCache::CacheTag &t = local_cache->request(tag,commitCounter,blocks);
-          BVH4::Node* node = (BVH4::Node*)local_cache->getCacheMemoryPtr(t);
+          unsigned int entryTime;
+          SharedTessellationCache::EntryHeader* entry = sharedTessellationCache.alloc(thread_state,storage,blocks+1,entryTime);
+          BVH4::Node* node = (BVH4::Node*)(entry+1);
           prefetchL1(((float*)node + 0*16));
           prefetchL1(((float*)node + 1*16));
           prefetchL1(((float*)node + 2*16));
@@ -381,10 +377,7 @@ namespace embree
           size_t new_root = (size_t)buildSubdivPatchTree(*subdiv_patch,node,((Scene*)geom)->getSubdivMesh(subdiv_patch->geom));
           assert( new_root != BVH4::invalidNode);
           
-          local_cache->updateRootRef(t,new_root);
-          
-          assert( (size_t)local_cache->getPtr() + (size_t)t.getRootRef() == new_root );
-          
+          sharedTessellationCache.insert(storage,entry,entryTime,subdiv_patch,commitCounter,new_root);
           return new_root;
         }
         
@@ -432,7 +425,7 @@ namespace embree
         }
         else 
         {
-          lazy_node = getSubtreeRootNode(pre.local_cache, prim, geom);
+          lazy_node = getSubtreeRootNode(pre.thread_state, prim, geom);
           pre.current_patch = (SubdivPatch1Cached*)prim;
         }             
         
@@ -454,7 +447,7 @@ namespace embree
         }
         else 
         {
-          lazy_node = getSubtreeRootNode(pre.local_cache, prim, geom);        
+          lazy_node = getSubtreeRootNode(pre.thread_state, prim, geom);        
           pre.current_patch = (SubdivPatch1Cached*)prim;
         }             
         
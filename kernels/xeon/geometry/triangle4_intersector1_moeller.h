@@ -19,6 +19,7 @@
 #include "triangle4.h"
 #include "common/ray.h"
 #include "geometry/filter.h"
+#include "geometry/alphamask.h"
 
 namespace embree
 {
@@ -82,15 +83,25 @@ namespace embree
           const ssef u = U * rcpAbsDen;
           const ssef v = V * rcpAbsDen;
           const ssef t = T * rcpAbsDen;
+
+          /* alpha mask test */
+#if defined(RTCORE_ALPHA_MASK)
+          if (unlikely(scene->numAlphaMasks)) {
+            valid = runAlphaMaskTest(valid,scene,tri.geomID<list>(),tri.primID<list>(),u,v);
+            if (none(valid)) return;
+          }
+#endif
+
           size_t i = select_min(valid,t);
           int geomID = tri.geomID<list>(i);
           
           /* intersection filter test */
 #if defined(RTCORE_INTERSECTION_FILTER)
+          sseb accepted = false;
           while (true) 
           {
             Geometry* geometry = scene->get(geomID);
-            if (likely(!geometry->hasIntersectionFilter1())) 
+            if (likely(!geometry->hasIntersectionFilter1()) || accepted[i]) 
             {
 #endif
               /* update hit information */
@@ -107,9 +118,20 @@ namespace embree
               return;
             }
             
-            Vec3fa Ng = Vec3fa(tri.Ng.x[i],tri.Ng.y[i],tri.Ng.z[i]);
-            if (runIntersectionFilter1(geometry,ray,u[i],v[i],t[i],Ng,geomID,tri.primID<list>(i))) return;
-            valid[i] = 0;
+            /* pass all hits of this geometry to the batched filter function at once */
+            if (geometry->hasIntersectionFilterN()) 
+            {
+              const sseb valid_geom = valid & (tri.geomID<list>() == ssei(geomID));
+              const sseb passed = runFilterN(geometry->intersectionFilterN,valid_geom,geometry,ray,u,v,t,sse3f(tri.Ng),geomID,tri.primID<list>());
+              valid = (valid & !valid_geom) | passed;
+              accepted |= passed;
+            }
+            else 
+            {
+              Vec3fa Ng = Vec3fa(tri.Ng.x[i],tri.Ng.y[i],tri.Ng.z[i]);
+              if (runIntersectionFilter1(geometry,ray,u[i],v[i],t[i],Ng,geomID,tri.primID<list>(i))) return;
+              valid[i] = 0;
+            }
             if (none(valid)) return;
             i = select_min(valid,t);
             geomID = tri.geomID<list>(i);
@@ -153,6 +175,15 @@ namespace embree
           valid &= (tri.mask & ray.mask) != 0;
           if (unlikely(none(valid))) return false;
 #endif
+
+          /* alpha mask test */
+#if defined(RTCORE_ALPHA_MASK)
+          if (unlikely(scene->numAlphaMasks)) {
+            const ssef rcpAbsDen = rcp(absDen);
+            valid = runAlphaMaskTest(valid,scene,tri.geomID<list>(),tri.primID<list>(),U*rcpAbsDen,V*rcpAbsDen);
+            if (none(valid)) return false;
+          }
+#endif
           
           /* intersection filter test */
 #if defined(RTCORE_INTERSECTION_FILTER)
@@ -171,6 +202,20 @@ namespace embree
             const ssef u = U * rcpAbsDen;
             const ssef v = V * rcpAbsDen;
             const ssef t = T * rcpAbsDen;
+
+            /* pass all hits of this geometry to the batched filter function at once */
+            if (geometry->hasOcclusionFilterN()) 
+            {
+              const sseb valid_geom = valid & (tri.geomID<list>() == ssei(geomID));
+              if (any(runFilterN(geometry->occlusionFilterN,valid_geom,geometry,ray,u,v,t,sse3f(tri.Ng),geomID,tri.primID<list>())))
+                break;
+              valid &= !valid_geom;
+              m=movemask(valid); 
+              if (m == 0) return false;
+              i=__bsf(m);
+              continue;
+            }
+
             const Vec3fa Ng = Vec3fa(tri.Ng.x[i],tri.Ng.y[i],tri.Ng.z[i]);
             if (runOcclusionFilter1(geometry,ray,u[i],v[i],t[i],Ng,geomID,tri.primID<list>(i))) 
               break;
@@ -19,6 +19,7 @@
 #include "triangle8.h"
 #include "common/ray.h"
 #include "geometry/filter.h"
+#include "geometry/alphamask.h"
 
 namespace embree
 {
@@ -82,15 +83,25 @@ namespace embree
           const avxf u = U * rcpAbsDen;
           const avxf v = V * rcpAbsDen;
           const avxf t = T * rcpAbsDen;
+
+          /* alpha mask test */
+#if defined(RTCORE_ALPHA_MASK)
+          if (unlikely(scene->numAlphaMasks)) {
+            valid = runAlphaMaskTest(valid,scene,tri.geomID<list>(),tri.primID<list>(),u,v);
+            if (none(valid)) return;
+          }
+#endif
+
           size_t i = select_min(valid,t);
           int geomID = tri.geomID<list>(i);
           
           /* intersection filter test */
 #if defined(RTCORE_INTERSECTION_FILTER)
+          avxb accepted = false;
           while (true) 
           {
             Geometry* geometry = scene->get(geomID);
-            if (likely(!geometry->hasIntersectionFilter1())) 
+            if (likely(!geometry->hasIntersectionFilter1()) || accepted[i]) 
             {
 #endif
               /* update hit information */
@@ -107,9 +118,20 @@ namespace embree
               return;
             }
             
-            Vec3fa Ng = Vec3fa(tri.Ng.x[i],tri.Ng.y[i],tri.Ng.z[i]);
-            if (runIntersectionFilter1(geometry,ray,u[i],v[i],t[i],Ng,geomID,tri.primID<list>(i))) return;
-            valid[i] = 0;
+            /* pass all hits of this geometry to the batched filter function at once */
+            if (geometry->hasIntersectionFilterN()) 
+            {
+              const avxb valid_geom = valid & (tri.geomID<list>() == avxi(geomID));
+              const avxb passed = runFilterN(geometry->intersectionFilterN,valid_geom,geometry,ray,u,v,t,avx3f(tri.Ng),geomID,tri.primID<list>());
+              valid = (valid & !valid_geom) | passed;
+              accepted |= passed;
+            }
+            else 
+            {
+              Vec3fa Ng = Vec3fa(tri.Ng.x[i],tri.Ng.y[i],tri.Ng.z[i]);
+              if (runIntersectionFilter1(geometry,ray,u[i],v[i],t[i],Ng,geomID,tri.primID<list>(i))) return;
+              valid[i] = 0;
+            }
             if (none(valid)) return;
             i = select_min(valid,t);
             geomID = tri.geomID<list>(i);
@@ -156,6 +178,15 @@ namespace embree
           valid &= (tri.mask & ray.mask) != 0;
           if (unlikely(none(valid))) return false;
 #endif
+
+          /* alpha mask test */
+#if defined(RTCORE_ALPHA_MASK)
+          if (unlikely(scene->numAlphaMasks)) {
+            const avxf rcpAbsDen = rcp(absDen);
+            valid = runAlphaMaskTest(valid,scene,tri.geomID<list>(),tri.primID<list>(),U*rcpAbsDen,V*rcpAbsDen);
+            if (none(valid)) return false;
+          }
+#endif
           
           /* intersection filter test */
 #if defined(RTCORE_INTERSECTION_FILTER)
@@ -173,9 +204,21 @@ namespace embree
             const avxf u = U * rcpAbsDen;
             const avxf v = V * rcpAbsDen;
             const avxf t = T * rcpAbsDen;
-            const Vec3fa Ng = Vec3fa(tri.Ng.x[i],tri.Ng.y[i],tri.Ng.z[i]);
-            if (runOcclusionFilter1(geometry,ray,u[i],v[i],t[i],Ng,geomID,tri.primID<list>(i))) break;
-            valid[i] = 0;
+
+            /* pass all hits of this geometry to the batched filter function at once */
+            if (geometry->hasOcclusionFilterN()) 
+            {
+              const avxb valid_geom = valid & (tri.geomID<list>() == avxi(geomID));
+              if (any(runFilterN(geometry->occlusionFilterN,valid_geom,geometry,ray,u,v,t,avx3f(tri.Ng),geomID,tri.primID<list>())))
+                break;
+              valid &= !valid_geom;
+            }
+            else 
+            {
+              const Vec3fa Ng = Vec3fa(tri.Ng.x[i],tri.Ng.y[i],tri.Ng.z[i]);
+              if (runOcclusionFilter1(geometry,ray,u[i],v[i],t[i],Ng,geomID,tri.primID<list>(i))) break;
+              valid[i] = 0;
+            }
             if (none(valid)) return false;
             i = select_min(valid,T);
             geomID = tri.geomID<list>(i);
@@ -101,6 +101,14 @@ namespace embree
             const avxf t = T*rcpAbsDen;
             const int geomID = tri.geomID<list>(i);
             const int primID = tri.primID<list>(i);
+
+            /* alpha mask test */
+#if defined(RTCORE_ALPHA_MASK)
+            if (enableIntersectionFilter) {
+              valid = runAlphaMaskTest(valid,scene,geomID,primID,u,v);
+              if (none(valid)) continue;
+            }
+#endif
             
             /* intersection filter test */
 #if defined(RTCORE_INTERSECTION_FILTER)
@@ -181,6 +189,15 @@ namespace embree
             valid &= (tri.mask[i] & ray.mask) != 0;
             if (unlikely(none(valid))) continue;
 #endif
+
+            /* alpha mask test */
+#if defined(RTCORE_ALPHA_MASK)
+            if (enableIntersectionFilter) {
+              const avxf rcpAbsDen = rcp(absDen);
+              valid = runAlphaMaskTest(valid,scene,tri.geomID<list>(i),tri.primID<list>(i),U*rcpAbsDen,V*rcpAbsDen);
+              if (none(valid)) continue;
+            }
+#endif
             
             /* intersection filter test */
 #if defined(RTCORE_INTERSECTION_FILTER)
@@ -252,6 +269,15 @@ namespace embree
           const avxf u = U * rcpAbsDen;
           const avxf v = V * rcpAbsDen;
           const avxf t = T * rcpAbsDen;
+
+          /* alpha mask test */
+#if defined(RTCORE_ALPHA_MASK)
+          if (enableIntersectionFilter && unlikely(scene->numAlphaMasks)) {
+            valid = runAlphaMaskTest(valid,scene,tri.geomID<list>(),tri.primID<list>(),u,v);
+            if (none(valid)) return;
+          }
+#endif
+
           size_t i = select_min(valid,t);
           int geomID = tri.geomID<list>(i);
           
@@ -326,6 +352,15 @@ namespace embree
           valid &= (tri.mask & ray.mask[k]) != 0;
           if (unlikely(none(valid))) return false;
 #endif
+
+          /* alpha mask test */
+#if defined(RTCORE_ALPHA_MASK)
+          if (enableIntersectionFilter && unlikely(scene->numAlphaMasks)) {
+            const avxf rcpAbsDen = rcp(absDen);
+            valid = runAlphaMaskTest(valid,scene,tri.geomID<list>(),tri.primID<list>(),U*rcpAbsDen,V*rcpAbsDen);
+            if (none(valid)) return false;
+          }
+#endif
           
           /* intersection filter test */
 #if defined(RTCORE_INTERSECTION_FILTER)
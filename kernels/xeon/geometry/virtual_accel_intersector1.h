@@ -44,5 +44,69 @@ namespace embree
         return ray.geomID == 0;
       }
     };
+
+    /*! Intersects a ray with all objects of a leaf. Consecutive items
+     *  of user geometries that have a stream callback set get passed
+     *  to that callback at once. */
+    template<bool list>
+    struct VirtualAccelIntersector1N
+    {
+      typedef AccelSetItem Primitive;
+      typedef VirtualAccelIntersector1::Precalculations Precalculations;
+
+      /*! maximal number of items passed to the stream callback at once */
+      static const size_t maxItems = 16;
+
+      /*! returns the number of objects in the leaf */
+      static __forceinline size_t count(const Primitive* prim, size_t num) 
+      {
+        if (!list) return num;
+        size_t n = 1; while (!prim[n-1].last()) n++;
+        return n;
+      }
+      
+      static __forceinline void intersect(Precalculations& pre, Ray& ray, const Primitive* prim, size_t num, Scene* scene, size_t& lazy_node) 
+      {
+        AVX_ZERO_UPPER();
+        const unsigned rayIDs[maxItems] = { 0 };
+        size_t items[maxItems];
+        const size_t n = count(prim,num);
+        for (size_t i=0; i<n;)
+        {
+          AccelSet* accel = prim[i].accel;
+          if (likely(!accel->hasIntersectN())) {
+            accel->intersect((RTCRay&)ray,prim[i].item); i++;
+            continue;
+          }
+          size_t N=0;
+          for (; i<n && N<maxItems && prim[i].accel == accel; i++) 
+            items[N++] = prim[i].item;
+          accel->intersectN((RTCRay*)&ray,rayIDs,items,N);
+        }
+      }
+      
+      static __forceinline bool occluded(Precalculations& pre, Ray& ray, const Primitive* prim, size_t num, Scene* scene, size_t& lazy_node) 
+      {
+        AVX_ZERO_UPPER();
+        const unsigned rayIDs[maxItems] = { 0 };
+        size_t items[maxItems];
+        const size_t n = count(prim,num);
+        for (size_t i=0; i<n;)
+        {
+          AccelSet* accel = prim[i].accel;
+          if (likely(!accel->hasOccludedN())) {
+            accel->occluded((RTCRay&)ray,prim[i].item); i++;
+          }
+          else {
+            size_t N=0;
+            for (; i<n && N<maxItems && prim[i].accel == accel; i++) 
+              items[N++] = prim[i].item;
+            accel->occludedN((RTCRay*)&ray,rayIDs,items,N);
+          }
+          if (ray.geomID == 0) return true;
+        }
+        return false;
+      }
+    };
   }
 }
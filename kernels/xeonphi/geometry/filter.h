@@ -22,11 +22,40 @@
 
 namespace embree
 {
+  __forceinline bool runFilterN(RTCFilterFuncN filterN, const Geometry* const geometry, const Ray& ray, 
+                                const mic_f& u, const mic_f& v, const mic_f& t, const mic_f& Ngx, const mic_f& Ngy, const mic_f& Ngz, const mic_m wmask, 
+                                const int geomID, const int primID, Vec3fa& hit_uvt, Vec3fa& hit_Ng)
+  {
+    /* the batched filter function gets the hit passed separately, thus the ray stays untouched */
+    compactustore16f_low(wmask,&hit_uvt.x,u); 
+    compactustore16f_low(wmask,&hit_uvt.y,v); 
+    compactustore16f_low(wmask,&hit_uvt.z,t); 
+    compactustore16f_low(wmask,&hit_Ng.x,Ngx); 
+    compactustore16f_low(wmask,&hit_Ng.y,Ngy); 
+    compactustore16f_low(wmask,&hit_Ng.z,Ngz);
+    int valid = -1;
+    filterN(&valid,geometry->userPtr,(const RTCRay&)ray,geomID,(const unsigned*)&primID,&hit_uvt.x,&hit_uvt.y,&hit_uvt.z,&hit_Ng.x,&hit_Ng.y,&hit_Ng.z,1);
+    return valid != 0;
+  }
+
   __forceinline bool runIntersectionFilter1(const Geometry* const geometry, Ray& ray, 
                                             const mic_f& u, const mic_f& v, const mic_f& t, const mic_f& Ngx, const mic_f& Ngy, const mic_f& Ngz, const mic_m wmask, 
                                             const int geomID, const int primID)
   {
- 
+    /* use batched filter function with a single hit if set */
+    if (geometry->hasIntersectionFilterN()) 
+    {
+      Vec3fa hit_uvt, hit_Ng;
+      if (!runFilterN(geometry->intersectionFilterN,geometry,ray,u,v,t,Ngx,Ngy,Ngz,wmask,geomID,primID,hit_uvt,hit_Ng))
+        return false;
+      ray.u = hit_uvt.x;
+      ray.v = hit_uvt.y;
+      ray.tfar = hit_uvt.z;
+      ray.Ng = hit_Ng;
+      ray.geomID = geomID;
+      ray.primID = primID;
+      return true;
+    }
 
     /* temporarily update hit information */
     const float  ray_tfar = ray.tfar;
@@ -59,6 +88,12 @@ namespace embree
                                          const mic_f& u, const mic_f& v, const mic_f& t, const mic_f& Ngx, const mic_f& Ngy, const mic_f& Ngz, const mic_m wmask, 
                                          const int geomID, const int primID)
   {
+    /* use batched filter function with a single hit if set */
+    if (geometry->hasOcclusionFilterN()) {
+      Vec3fa hit_uvt, hit_Ng;
+      return runFilterN(geometry->occlusionFilterN,geometry,ray,u,v,t,Ngx,Ngy,Ngz,wmask,geomID,primID,hit_uvt,hit_Ng);
+    }
+
     /* temporarily update hit information */
     const float ray_tfar = ray.tfar;
     const int   ray_geomID = ray.geomID;
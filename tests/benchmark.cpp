@@ -20,6 +20,7 @@
 #include "embree2/rtcore_ray.h"
 #include "math/vec3.h"
 #include "../kernels/common/default.h"
+#include "../kernels/algorithms/sort.h"
 #include <vector>
 
 namespace embree
@@ -120,8 +121,8 @@ namespace embree
   public:
     enum { N = 100 };
 
-    benchmark_barrier_sys () 
-     : Benchmark("barrier_sys","ms") {}
+    benchmark_barrier_sys (const std::string& name, size_t spinRounds, size_t yieldRounds) 
+     : Benchmark(name,"ms"), spinRounds(spinRounds), yieldRounds(yieldRounds) {}
 
     static void benchmark_barrier_sys_thread(void* ptr) 
     {
@@ -132,6 +133,7 @@ namespace embree
     
     double run (size_t numThreads)
     {
+      IdlePolicy::set(spinRounds,yieldRounds);
       g_barrier.init(numThreads);
       for (size_t i=1; i<numThreads; i++)
 	g_threads.push_back(createThread(benchmark_barrier_sys_thread,(void*)i,1000000,i));
@@ -147,8 +149,12 @@ namespace embree
     
       //printf("%30s ... %f ms (%f k/s)\n","barrier_sys",1000.0f*(t1-t0)/double(N),1E-3*N/(t1-t0));
       //fflush(stdout);
+      IdlePolicy::set(IdlePolicy::DEFAULT_SPIN_ROUNDS,IdlePolicy::DEFAULT_YIELD_ROUNDS);
       return 1000.0f*(t1-t0)/double(N);
     }
+
+  private:
+    size_t spinRounds, yieldRounds;
   };
 
   class benchmark_barrier_active : public Benchmark
@@ -156,8 +162,8 @@ namespace embree
     enum { N = 1000 };
 
   public:
-    benchmark_barrier_active () 
-      : Benchmark("barrier_active","ns") {}
+    benchmark_barrier_active (const std::string& name, size_t spinRounds, size_t yieldRounds) 
+      : Benchmark(name,"ns"), spinRounds(spinRounds), yieldRounds(yieldRounds) {}
 
     static void benchmark_barrier_active_thread(void* ptr) 
     {
@@ -170,6 +176,7 @@ namespace embree
   
     double run (size_t numThreads)
     {
+      IdlePolicy::set(spinRounds,yieldRounds);
       g_num_threads = numThreads;
       g_barrier_active.init(numThreads);
       for (size_t i=1; i<numThreads; i++)
@@ -189,8 +196,12 @@ namespace embree
       
       //printf("%30s ... %f ms (%f k/s)\n","barrier_active",1000.0f*(t1-t0)/double(N),1E-3*N/(t1-t0));
       //fflush(stdout);
+      IdlePolicy::set(IdlePolicy::DEFAULT_SPIN_ROUNDS,IdlePolicy::DEFAULT_YIELD_ROUNDS);
       return 1E9*(t1-t0)/double(N);
     }
+
+  private:
+    size_t spinRounds, yieldRounds;
   };
 
   class benchmark_atomic_inc : public Benchmark
@@ -334,6 +345,85 @@ namespace embree
 
   char* benchmark_bandwidth::ptr = NULL;
 
+  class benchmark_tasks : public Benchmark
+  {
+  public:
+    enum { N = 1 << 16, DEPTH = 10 };
+
+    benchmark_tasks (const std::string& name, const std::string& type, bool nested) 
+      : Benchmark(name,"Mtasks/s"), type(type), nested(nested) {}
+
+    static void task_flat(void* data, size_t threadIndex, size_t threadCount, size_t taskIndex, size_t taskCount, TaskScheduler::Event* event) {
+    }
+
+    /* each task element spawns a task of two elements until depth 0 is reached */
+    static void task_nested(void* data, size_t threadIndex, size_t threadCount, size_t taskIndex, size_t taskCount, TaskScheduler::Event* event) 
+    {
+      size_t depth = (size_t) data;
+      if (depth == 0) return;
+      TaskScheduler::executeTask(threadIndex,threadCount,task_nested,(void*)(depth-1),2,"task_nested");
+    }
+    
+    double run (size_t numThreads)
+    {
+      TaskScheduler::create(numThreads,type);
+
+      /* a nested tree has 2^(DEPTH+2)-2 task elements */
+      size_t numTasks = nested ? N/((size_t(4) << DEPTH)-2) : 1;
+      size_t numElements = nested ? numTasks*((size_t(4) << DEPTH)-2) : N;
+
+      double t0 = getSeconds();
+      for (size_t i=0; i<numTasks; i++)
+      {
+        TaskScheduler::EventSync event;
+        TaskScheduler::Task task(&event,nested ? task_nested : task_flat,(void*)DEPTH,nested ? 2 : N,NULL,NULL,name.c_str());
+        TaskScheduler::addTask(-1,TaskScheduler::GLOBAL_FRONT,&task);
+        event.sync();
+      }
+      double t1 = getSeconds();
+
+      TaskScheduler::destroy();
+      return 1E-6*double(numElements)/(t1-t0);
+    }
+
+  private:
+    std::string type;
+    bool nested;
+  };
+
+  class benchmark_sort : public Benchmark
+  {
+  public:
+    enum { N = 1 << 22 };
+
+    benchmark_sort (const std::string& name, bool keyValue) 
+      : Benchmark(name,"Mkeys/s"), keyValue(keyValue) {}
+
+    double run (size_t numThreads)
+    {
+      TaskScheduler::create(numThreads);
+
+      std::vector<uint64> keys(N), tmpKeys(N);
+      std::vector<unsigned int> vals(N), tmpVals(N);
+      for (size_t i=0; i<N; i++) {
+        keys[i] = uint64(rand())*uint64(rand());
+        vals[i] = (unsigned int) i;
+      }
+
+      double t0 = getSeconds();
+      if (keyValue) sorter.sort<uint64,unsigned int>(keys.data(),tmpKeys.data(),vals.data(),tmpVals.data(),N);
+      else          sorter.sort<uint64,uint64>(keys.data(),tmpKeys.data(),N);
+      double t1 = getSeconds();
+
+      TaskScheduler::destroy();
+      return 1E-6*double(N)/(t1-t0);
+    }
+
+  private:
+    bool keyValue;
+    ParallelRadixSort sorter;
+  };
+
   RTCRay makeRay(Vec3f org, Vec3f dir) 
   {
     RTCRay ray;
@@ -772,11 +862,21 @@ namespace embree
   void create_benchmarks()
   {
     benchmarks.push_back(new benchmark_mutex_sys());
-    benchmarks.push_back(new benchmark_barrier_sys());
-    benchmarks.push_back(new benchmark_barrier_active());
+    benchmarks.push_back(new benchmark_barrier_sys("barrier_sys",IdlePolicy::DEFAULT_SPIN_ROUNDS,IdlePolicy::DEFAULT_YIELD_ROUNDS));
+    benchmarks.push_back(new benchmark_barrier_sys("barrier_sys_spin",size_t(-1),0));
+    benchmarks.push_back(new benchmark_barrier_sys("barrier_sys_sleep",0,0));
+    benchmarks.push_back(new benchmark_barrier_active("barrier_active",IdlePolicy::DEFAULT_SPIN_ROUNDS,IdlePolicy::DEFAULT_YIELD_ROUNDS));
+    benchmarks.push_back(new benchmark_barrier_active("barrier_active_spin",size_t(-1),0));
+    benchmarks.push_back(new benchmark_barrier_active("barrier_active_sleep",0,0));
     benchmarks.push_back(new benchmark_atomic_inc());
     benchmarks.push_back(new benchmark_osmalloc());
     benchmarks.push_back(new benchmark_bandwidth());
+    benchmarks.push_back(new benchmark_tasks("tasks_flat_sys","sys",false));
+    benchmarks.push_back(new benchmark_tasks("tasks_flat_stealing","stealing",false));
+    benchmarks.push_back(new benchmark_tasks("tasks_nested_sys","sys",true));
+    benchmarks.push_back(new benchmark_tasks("tasks_nested_stealing","stealing",true));
+    benchmarks.push_back(new benchmark_sort("sort_u64",false));
+    benchmarks.push_back(new benchmark_sort("sort_u64_key_value",true));
  
     benchmarks.push_back(new create_geometry ("create_static_geometry_120",      RTC_SCENE_STATIC,RTC_GEOMETRY_STATIC,6,1));
     benchmarks.push_back(new create_geometry ("create_static_geometry_1k" ,      RTC_SCENE_STATIC,RTC_GEOMETRY_STATIC,17,1));
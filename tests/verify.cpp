@@ -21,12 +21,15 @@
 #include "sys/sync/barrier.h"
 #include "sys/sync/mutex.h"
 #include "sys/sync/condition.h"
+#include "math/vec2.h"
 #include "math/vec3.h"
 #include "math/bbox.h"
 #include "embree2/rtcore.h"
 #include "embree2/rtcore_ray.h"
 #include "../kernels/common/default.h"
 #include <vector>
+#include <deque>
+#include <sstream>
 
 //#define DEFAULT_STACK_SIZE 2*1024*1024
 //#define DEFAULT_STACK_SIZE 512*1024
@@ -634,6 +637,58 @@ namespace embree
     return mesh;
   }
 
+  /* height of the limit surface of the subdiv height field, the
+   * B-spline limit of the sampled paraboloid is raised by 2/3*h^2 */
+  float subdivHeightFieldY(const float x, const float z, size_t N)
+  {
+    const float h = 2.0f/N;
+    return 0.5f*(x*x+z*z) + 0.5f*2.0f/3.0f*h*h;
+  }
+
+  /* adds a regular subdiv mesh of NxN quads over [-1,1]x[-1,1] in the xz-plane, sampling the paraboloid y = (x*x+z*z)/2 */
+  unsigned int addSubdivHeightField (RTCScene scene, RTCGeometryFlags flags, size_t N, float level, float motion = 0.0f)
+  {
+    size_t numTimeSteps = motion == 0.0f ? 1 : 2;
+    unsigned int mesh = rtcNewSubdivisionMesh(scene, flags, N*N, 4*N*N, (N+1)*(N+1), 0, 0, 0, numTimeSteps);
+    Vec3fa* vertices0 = (Vec3fa*) rtcMapBuffer(scene,mesh,RTC_VERTEX_BUFFER0); 
+    Vec3fa* vertices1 = NULL;
+    if (numTimeSteps == 2) vertices1 = (Vec3fa*) rtcMapBuffer(scene,mesh,RTC_VERTEX_BUFFER1); 
+    int*    indices   = (int    *) rtcMapBuffer(scene,mesh,RTC_INDEX_BUFFER);
+    int*    faces     = (int    *) rtcMapBuffer(scene,mesh,RTC_FACE_BUFFER);
+    float*  levels    = (float  *) rtcMapBuffer(scene,mesh,RTC_LEVEL_BUFFER);
+
+    for (size_t z=0; z<=N; z++) 
+    {
+      for (size_t x=0; x<=N; x++) 
+      {
+        const float px = 2.0f*float(x)/float(N)-1.0f;
+        const float pz = 2.0f*float(z)/float(N)-1.0f;
+        vertices0[z*(N+1)+x] = Vec3fa(px,0.5f*(px*px+pz*pz),pz);
+        if (vertices1) vertices1[z*(N+1)+x] = vertices0[z*(N+1)+x] + Vec3fa(0.0f,motion,0.0f);
+      }
+    }
+    for (size_t z=0; z<N; z++) 
+    {
+      for (size_t x=0; x<N; x++) 
+      {
+        const size_t f = z*N+x;
+        faces[f] = 4;
+        indices[4*f+0] = (z+0)*(N+1)+(x+0);
+        indices[4*f+1] = (z+1)*(N+1)+(x+0);
+        indices[4*f+2] = (z+1)*(N+1)+(x+1);
+        indices[4*f+3] = (z+0)*(N+1)+(x+1);
+      }
+    }
+    for (size_t i=0; i<4*N*N; i++) levels[i] = level;
+
+    rtcUnmapBuffer(scene,mesh,RTC_VERTEX_BUFFER0); 
+    if (vertices1) rtcUnmapBuffer(scene,mesh,RTC_VERTEX_BUFFER1); 
+    rtcUnmapBuffer(scene,mesh,RTC_INDEX_BUFFER);
+    rtcUnmapBuffer(scene,mesh,RTC_FACE_BUFFER);
+    rtcUnmapBuffer(scene,mesh,RTC_LEVEL_BUFFER);
+    return mesh;
+  }
+
   unsigned int addCube (RTCScene scene_i, RTCGeometryFlags flag, const Vec3fa& pos, const float r)
   {
     /* create a triangulated cube with 12 triangles and 8 vertices */
@@ -993,6 +1048,31 @@ namespace embree
     numFailedTests += !ok;
     return ok;
   }
+  bool test_thread_placement ()
+  {
+    const std::vector<ThreadLocation>& threads = getThreadTopology();
+    const size_t N = threads.size();
+    if (N != getNumberOfLogicalThreads()) return false;
+
+    const AffinityPolicy policies[] = { AFFINITY_COMPACT, AFFINITY_SCATTER, AFFINITY_CORES, AFFINITY_SOCKETS };
+    for (size_t p=0; p<4; p++)
+    {
+      /* the first N threads get placed onto distinct logical threads */
+      std::vector<bool> used(N,false);
+      for (size_t i=0; i<N; i++) {
+        const ssize_t t = getThreadPlacement(policies[p],i);
+        if (t < 0 || t >= ssize_t(N) || used[t]) return false;
+        used[t] = true;
+      }
+
+      /* the scatter and cores policies use all cores before SMT siblings */
+      if (policies[p] != AFFINITY_SCATTER && policies[p] != AFFINITY_CORES) continue;
+      for (size_t i=0; i<getNumberOfCores(); i++)
+        if (threads[getThreadPlacement(policies[p],i)].smt != 0) return false;
+    }
+    return true;
+  }
+
 
   MutexSys g_mutex;
   size_t g_counter;
@@ -1325,6 +1405,69 @@ namespace embree
     return true;
   }
 
+  /*! shoots a grid of rays downwards through both scenes and compares the hits */
+  bool rtcore_compare_hits(RTCScene scene0, RTCScene scene1, const Vec3fa& lower, const Vec3fa& upper, size_t N, size_t& numHits)
+  {
+    numHits = 0;
+    for (size_t x=0; x<N; x++)
+    {
+      for (size_t z=0; z<N; z++)
+      {
+        const Vec3fa org(lower.x+(x+0.5f)*(upper.x-lower.x)/N,upper.y+1.0f,lower.z+(z+0.5f)*(upper.z-lower.z)/N);
+        RTCRay ray0 = makeRay(org,Vec3fa(0,-1,0));
+        RTCRay ray1 = makeRay(org,Vec3fa(0,-1,0));
+        rtcIntersect(scene0,ray0);
+        rtcIntersect(scene1,ray1);
+        if (ray0.geomID != ray1.geomID || ray0.primID != ray1.primID) return false;
+        if (ray0.geomID == RTC_INVALID_GEOMETRY_ID) continue;
+        if (fabs(ray0.tfar-ray1.tfar) > 1E-3f*ray1.tfar) return false;
+        numHits++;
+      }
+    }
+    return true;
+  }
+
+  bool rtcore_rebuild_hair()
+  {
+    const size_t numHairs = 1000;
+    RTCScene scene = rtcNewScene(RTC_SCENE_DYNAMIC,aflags);
+    unsigned geom = addHair(scene,RTC_GEOMETRY_DEFORMABLE,Vec3fa(0,0,0),1.0f,0.2f,numHairs);
+    AssertNoError();
+    rtcCommit (scene);
+    AssertNoError();
+
+    for (size_t i=0; i<4; i++) 
+    {
+      /* move the curves, each commit rebuilds the scene with the same builder */
+      Vec3fa* vertices = (Vec3fa*) rtcMapBuffer(scene,geom,RTC_VERTEX_BUFFER);
+      for (size_t j=0; j<4*numHairs; j++) {
+        vertices[j].x += 0.5f; vertices[j].z -= 0.25f;
+      }
+      rtcUnmapBuffer(scene,geom,RTC_VERTEX_BUFFER);
+      rtcUpdate(scene,geom);
+      rtcCommit (scene);
+      AssertNoError();
+
+      /* build a new scene from the same curves */
+      RTCScene ref = rtcNewScene(RTC_SCENE_DYNAMIC,aflags);
+      unsigned refGeom = rtcNewHairGeometry (ref,RTC_GEOMETRY_STATIC,numHairs,4*numHairs);
+      memcpy(rtcMapBuffer(ref,refGeom,RTC_VERTEX_BUFFER),rtcMapBuffer(scene,geom,RTC_VERTEX_BUFFER),4*numHairs*sizeof(Vec3fa));
+      memcpy(rtcMapBuffer(ref,refGeom,RTC_INDEX_BUFFER ),rtcMapBuffer(scene,geom,RTC_INDEX_BUFFER ),numHairs*sizeof(int));
+      rtcUnmapBuffer(scene,geom,RTC_VERTEX_BUFFER); rtcUnmapBuffer(ref,refGeom,RTC_VERTEX_BUFFER);
+      rtcUnmapBuffer(scene,geom,RTC_INDEX_BUFFER ); rtcUnmapBuffer(ref,refGeom,RTC_INDEX_BUFFER );
+      rtcCommit (ref);
+      AssertNoError();
+
+      size_t numHits = 0;
+      bool ok = rtcore_compare_hits(scene,ref,Vec3fa(-1,-1,-4),Vec3fa(10,15,32),64,numHits);
+      rtcDeleteScene (ref);
+      if (!ok || numHits == 0) return false;
+    }
+    rtcDeleteScene (scene);
+    AssertNoError();
+    return true;
+  }
+
   bool rtcore_ray_masks_intersect(RTCSceneFlags sflags, RTCGeometryFlags gflags)
   {
     bool passed = true;
@@ -1656,6 +1799,128 @@ namespace embree
 	    ray.geomID[i] = -1;
   }
 
+  void intersectionFilterN(int* valid, void* ptr, const RTCRay& ray, unsigned geomID, const unsigned* primID, 
+                           const float* u, const float* v, const float* t, const float* Ngx, const float* Ngy, const float* Ngz, size_t N) 
+  {
+    if ((size_t)ptr != 123) 
+      return;
+
+    for (size_t i=0; i<N; i++)
+      if (valid[i])
+        if (primID[i] & 2) 
+          valid[i] = 0;
+  }
+
+  bool rtcore_filterN(RTCSceneFlags sflags, RTCGeometryFlags gflags)
+  {
+    bool passed = true;
+
+    RTCScene scene = rtcNewScene(sflags,aflags);
+    Vec3fa p0(-0.75f,-0.25f,-10.0f), dx(4,0,0), dy(0,4,0);
+    int geom0 = addPlane (scene, gflags, 4, p0, dx, dy);
+    rtcSetUserData(scene,geom0,(void*)123);
+    rtcSetIntersectionFilterFunctionN(scene,geom0,intersectionFilterN);
+    rtcSetOcclusionFilterFunctionN(scene,geom0,intersectionFilterN);
+    rtcCommit (scene);
+    
+    for (size_t iy=0; iy<4; iy++) 
+    {
+      for (size_t ix=0; ix<4; ix++) 
+      {
+        int primID = 2*(iy*4+ix);
+        {
+          RTCRay ray0 = makeRay(Vec3fa(float(ix),float(iy),0.0f),Vec3fa(0,0,-1));
+          rtcIntersect(scene,ray0);
+          bool ok0 = (primID & 2) ? (ray0.geomID == -1) : (ray0.geomID == 0 && ray0.primID == primID);
+          if (!ok0) passed = false;
+        }
+        {
+          RTCRay ray0 = makeRay(Vec3fa(float(ix),float(iy),0.0f),Vec3fa(0,0,-1));
+          rtcOccluded(scene,ray0);
+          bool ok0 = (primID & 2) ? (ray0.geomID == -1) : (ray0.geomID == 0);
+          if (!ok0) passed = false;
+        }
+      }
+    }
+    rtcDeleteScene (scene);
+    clearBuffers();
+    return passed;
+  }
+
+  struct FilterNBatch
+  {
+    unsigned reject;   //!< bit mask of the primIDs to reject
+    size_t maxHits;    //!< maximal number of valid hits passed at once
+  };
+
+  void intersectionFilterNBatch(int* valid, void* ptr, const RTCRay& ray, unsigned geomID, const unsigned* primID, 
+                                const float* u, const float* v, const float* t, const float* Ngx, const float* Ngy, const float* Ngz, size_t N) 
+  {
+    FilterNBatch* batch = (FilterNBatch*) ptr;
+    size_t numHits = 0;
+    for (size_t i=0; i<N; i++) {
+      if (!valid[i]) continue;
+      numHits++;
+      if ((batch->reject >> primID[i]) & 1) valid[i] = 0;
+    }
+    batch->maxHits = max(batch->maxHits,numHits);
+  }
+
+  bool rtcore_filterN_batch(RTCSceneFlags sflags, RTCGeometryFlags gflags)
+  {
+    /* four stacked triangles end up in a single leaf, thus the Triangle4 and Triangle8 intersectors pass all their hits at once */
+    RTCScene scene = rtcNewScene(sflags,aflags);
+    unsigned geom0 = rtcNewTriangleMesh (scene, gflags, 4, 12);
+    Vertex3fa* vertices = (Vertex3fa*) rtcMapBuffer(scene,geom0,RTC_VERTEX_BUFFER); 
+    Triangle* triangles = (Triangle*) rtcMapBuffer(scene,geom0,RTC_INDEX_BUFFER);
+    for (size_t i=0; i<4; i++) 
+    {
+      const float z = -1.0f-float(i);
+      vertices[3*i+0].x = -1.0f; vertices[3*i+0].y = -1.0f; vertices[3*i+0].z = z;
+      vertices[3*i+1].x = +2.0f; vertices[3*i+1].y = -1.0f; vertices[3*i+1].z = z;
+      vertices[3*i+2].x = -1.0f; vertices[3*i+2].y = +2.0f; vertices[3*i+2].z = z;
+      triangles[i].v0 = 3*i+0; triangles[i].v1 = 3*i+1; triangles[i].v2 = 3*i+2;
+    }
+    rtcUnmapBuffer(scene,geom0,RTC_VERTEX_BUFFER); 
+    rtcUnmapBuffer(scene,geom0,RTC_INDEX_BUFFER);
+
+    FilterNBatch batch;
+    rtcSetUserData(scene,geom0,&batch);
+    rtcSetIntersectionFilterFunctionN(scene,geom0,intersectionFilterNBatch);
+    rtcSetOcclusionFilterFunctionN(scene,geom0,intersectionFilterNBatch);
+    rtcCommit (scene);
+    bool passed = rtcGetError() == RTC_NO_ERROR;
+
+    /* the robust and compact acceleration structures pass the hits one by one */
+#if defined(__MIC__)
+    const bool batched = false;
+#else
+    const bool batched = !(sflags & (RTC_SCENE_ROBUST | RTC_SCENE_COMPACT));
+#endif
+
+    /* the nearest accepted triangle has to get reported */
+    const unsigned reject[4] = { 0x5, 0x3, 0x7, 0xF };
+    for (size_t i=0; i<4; i++)
+    {
+      batch.reject = reject[i]; batch.maxHits = 0;
+      RTCRay ray0 = makeRay(Vec3fa(0,0,0),Vec3fa(0,0,-1));
+      rtcIntersect(scene,ray0);
+      const int primID = reject[i] == 0xF ? -1 : __bsf(~reject[i]);
+      if (primID == -1) passed &= ray0.geomID == -1;
+      else              passed &= ray0.geomID == geom0 && ray0.primID == primID;
+      passed &= batched ? batch.maxHits == size_t(4) : batch.maxHits == size_t(1);
+
+      batch.maxHits = 0;
+      RTCRay ray1 = makeRay(Vec3fa(0,0,0),Vec3fa(0,0,-1));
+      rtcOccluded(scene,ray1);
+      passed &= primID == -1 ? ray1.geomID == -1 : ray1.geomID == 0;
+      passed &= batched ? batch.maxHits == size_t(4) : batch.maxHits == size_t(1);
+    }
+    rtcDeleteScene (scene);
+    clearBuffers();
+    return passed;
+  }
+
   bool rtcore_filter_intersect(RTCSceneFlags sflags, RTCGeometryFlags gflags)
   {
     bool passed = true;
@@ -1816,12 +2081,170 @@ namespace embree
       bool ok1 = rtcore_filter_occluded(flag,RTC_GEOMETRY_STATIC);
       if (ok1) printf(GREEN("+")); else printf(RED("-"));
       passed &= ok1;
+      bool ok2 = rtcore_filterN(flag,RTC_GEOMETRY_STATIC);
+      if (ok2) printf(GREEN("+")); else printf(RED("-"));
+      passed &= ok2;
+      bool ok3 = rtcore_filterN_batch(flag,RTC_GEOMETRY_STATIC);
+      if (ok3) printf(GREEN("+")); else printf(RED("-"));
+      passed &= ok3;
+
+    }
+    printf(" %s\n",passed ? GREEN("[PASSED]") : RED("[FAILED]"));
+    fflush(stdout);
+    numFailedTests += !passed;
+  }
+
+#if defined(RTCORE_ALPHA_MASK)
+  bool rtcore_alpha_mask_check(RTCScene scene, bool visible)
+  {
+    bool passed = true;
+    for (size_t iy=0; iy<4; iy++) 
+    {
+      for (size_t ix=0; ix<4; ix++) 
+      {
+        bool opaque = visible && (ix+iy)%2 == 0;
+        {
+          RTCRay ray0 = makeRay(Vec3fa(float(ix),float(iy),0.0f),Vec3fa(0,0,-1));
+          rtcIntersect(scene,ray0);
+          bool ok0 = opaque ? (ray0.geomID == 0) : (ray0.geomID == -1);
+          if (!ok0) passed = false;
+        }
+        {
+          RTCRay ray0 = makeRay(Vec3fa(float(ix),float(iy),0.0f),Vec3fa(0,0,-1));
+          rtcOccluded(scene,ray0);
+          bool ok0 = opaque ? (ray0.geomID == 0) : (ray0.geomID == -1);
+          if (!ok0) passed = false;
+        }
+
+#if !defined(__MIC__)
+        {
+          RTCRay ray0 = makeRay(Vec3fa(float(ix),float(iy),0.0f),Vec3fa(0,0,-1));
+          RTCRay4 ray4;
+          setRay(ray4,0,ray0);
+          __aligned(16) int valid4[4] = { -1,0,0,0 };
+          rtcIntersect4(valid4,scene,ray4);
+          bool ok0 = opaque ? (ray4.geomID[0] == 0) : (ray4.geomID[0] == -1);
+          if (!ok0) passed = false;
+        }
+        {
+          RTCRay ray0 = makeRay(Vec3fa(float(ix),float(iy),0.0f),Vec3fa(0,0,-1));
+          RTCRay4 ray4;
+          setRay(ray4,0,ray0);
+          __aligned(16) int valid4[4] = { -1,0,0,0 };
+          rtcOccluded4(valid4,scene,ray4);
+          bool ok0 = opaque ? (ray4.geomID[0] == 0) : (ray4.geomID[0] == -1);
+          if (!ok0) passed = false;
+        }
+#endif
+      }
+    }
+    return passed;
+  }
+
+  bool rtcore_alpha_mask(RTCSceneFlags sflags, RTCGeometryFlags gflags)
+  {
+    bool passed = true;
+
+    RTCScene scene = rtcNewScene(sflags,aflags);
+    Vec3fa p0(-0.75f,-0.25f,-10.0f), dx(4,0,0), dy(0,4,0);
+    int geom0 = addPlane (scene, gflags, 4, p0, dx, dy);
+
+    /* map each quad of the plane to one texel of a checkerboard mask */
+    Vec2f* texcoords = (Vec2f*) rtcMapBuffer(scene,geom0,RTC_TEXCOORD_BUFFER);
+    for (size_t y=0; y<=4; y++) 
+      for (size_t x=0; x<=4; x++) 
+        texcoords[y*5+x] = Vec2f(float(x)/4.0f,float(y)/4.0f);
+    rtcUnmapBuffer(scene,geom0,RTC_TEXCOORD_BUFFER);
+
+    unsigned int bits = 0;
+    for (size_t y=0; y<4; y++) 
+      for (size_t x=0; x<4; x++) 
+        if ((x+y)%2 == 0) bits |= 1 << (y*4+x);
+    rtcSetAlphaMask(scene,geom0,&bits,4,4);
+    rtcCommit (scene);
+    
+    passed &= rtcore_alpha_mask_check(scene,true);
+
+    /* the mask has to survive disabling and enabling of the mesh */
+    if (sflags & RTC_SCENE_DYNAMIC)
+    {
+      rtcDisable(scene,geom0);
+      rtcCommit (scene);
+      passed &= rtcore_alpha_mask_check(scene,false);
+      rtcEnable(scene,geom0);
+      rtcCommit (scene);
+      passed &= rtcore_alpha_mask_check(scene,true);
+    }
+    rtcDeleteScene (scene);
+    clearBuffers();
+    return passed;
+  }
+
+  bool rtcore_alpha_mask_robust()
+  {
+    RTCScene scene = rtcNewScene(RTCSceneFlags(RTC_SCENE_STATIC | RTC_SCENE_ROBUST),aflags);
+    AssertNoError();
+    int geom0 = addPlane (scene, RTC_GEOMETRY_STATIC, 4, Vec3fa(0,0,-10), Vec3fa(4,0,0), Vec3fa(0,4,0));
+    AssertNoError();
+    unsigned int bits = 0x5555;
+    rtcSetAlphaMask(scene,geom0,&bits,4,4); // robust scenes do not support alpha masks
+    AssertError(RTC_INVALID_OPERATION);
+    rtcDeleteScene (scene);
+    clearBuffers();
+    return true;
+  }
+
+  bool rtcore_alpha_mask_unsupported()
+  {
+    unsigned int bits = 0x5555;
+
+    /* motion blur meshes are handled by the Triangle4vMB intersectors without alpha test */
+    RTCScene scene = rtcNewScene(RTC_SCENE_STATIC,aflags);
+    AssertNoError();
+    unsigned int geom0 = rtcNewTriangleMesh (scene, RTC_GEOMETRY_STATIC, 1, 3, 2);
+    AssertNoError();
+    rtcSetAlphaMask(scene,geom0,&bits,4,4); 
+    AssertError(RTC_INVALID_OPERATION);
+    rtcDeleteScene (scene);
+
+    /* the Triangle4v intersectors do not perform the alpha test either */
+    rtcExit();
+    rtcInit((g_rtcore+",tri_accel=bvh4.triangle4v").c_str());
+    scene = rtcNewScene(RTC_SCENE_STATIC,aflags);
+    AssertNoError();
+    geom0 = addPlane (scene, RTC_GEOMETRY_STATIC, 4, Vec3fa(0,0,-10), Vec3fa(4,0,0), Vec3fa(0,4,0));
+    AssertNoError();
+    rtcSetAlphaMask(scene,geom0,&bits,4,4); 
+    bool passed = rtcGetError() == RTC_INVALID_OPERATION;
+    rtcDeleteScene (scene);
+    clearBuffers();
+    rtcExit();
+    rtcInit(g_rtcore.c_str());
+    return passed;
+  }
 
+  void rtcore_alpha_mask_all()
+  {
+    printf("%30s ... ","alpha_mask");
+    bool passed = true;
+    RTCSceneFlags flags[2] = { RTC_SCENE_STATIC, RTC_SCENE_DYNAMIC };
+    for (int i=0; i<2; i++) 
+    {
+      bool ok = rtcore_alpha_mask(flags[i],RTC_GEOMETRY_STATIC);
+      if (ok) printf(GREEN("+")); else printf(RED("-"));
+      passed &= ok;
     }
+    bool ok = rtcore_alpha_mask_robust();
+    if (ok) printf(GREEN("+")); else printf(RED("-"));
+    passed &= ok;
+    ok = rtcore_alpha_mask_unsupported();
+    if (ok) printf(GREEN("+")); else printf(RED("-"));
+    passed &= ok;
     printf(" %s\n",passed ? GREEN("[PASSED]") : RED("[FAILED]"));
     fflush(stdout);
     numFailedTests += !passed;
   }
+#endif
 
   bool rtcore_packet_write_test(RTCSceneFlags sflags, RTCGeometryFlags gflags, int type)
   {
@@ -2424,41 +2847,661 @@ namespace embree
     return true;
   }
 
-  void shootRays (RTCScene scene)
+  struct StreamSpheres 
   {
-    Vec3fa org(2.0f*drand48()-1.0f,2.0f*drand48()-1.0f,2.0f*drand48()-1.0f);
-    Vec3fa dir(2.0f*drand48()-1.0f,2.0f*drand48()-1.0f,2.0f*drand48()-1.0f);
-    RTCRay ray = makeRay(org,dir); 
-    rtcOccluded(scene,ray);
-    rtcIntersect(scene,ray);
+    StreamSpheres (size_t N) : spheres(new Sphere[N]), geomID(-1), numStreamCalls(0), maxStreamItems(0), numBoundsCalls(0) {}
+    ~StreamSpheres () { delete[] spheres; }
+  public:
+    Sphere* spheres;
+    unsigned geomID;
+    atomic_t numStreamCalls;
+    size_t maxStreamItems;
+    atomic_t numBoundsCalls;
+  };
 
-#if !defined(__MIC__)
-    RTCRay4 ray4;
-    for (size_t j=0; j<4; j++) {
-      Vec3fa org(2.0f*drand48()-1.0f,2.0f*drand48()-1.0f,2.0f*drand48()-1.0f);
-      Vec3fa dir(2.0f*drand48()-1.0f,2.0f*drand48()-1.0f,2.0f*drand48()-1.0f);
-      RTCRay ray = makeRay(org,dir); 
-      setRay(ray4,j,ray);
+  bool intersectSphere(const Sphere& sphere, RTCRay& ray, float& t)
+  {
+    const Vec3fa org(ray.org[0],ray.org[1],ray.org[2]);
+    const Vec3fa dir(ray.dir[0],ray.dir[1],ray.dir[2]);
+    const Vec3fa v = org-sphere.pos;
+    const float A = dot(dir,dir);
+    const float B = 2.0f*dot(v,dir);
+    const float C = dot(v,v) - sqr(sphere.r);
+    const float D = B*B - 4.0f*A*C;
+    if (D < 0.0f) return false;
+    t = (-B-sqrt(D))/(2.0f*A);
+    return t > ray.tnear && t < ray.tfar;
+  }
+
+  void IntersectFuncStream(void* ptr, RTCRay* rays, const unsigned* rayIDs, const size_t* items, size_t N) 
+  {
+    StreamSpheres* set = (StreamSpheres*) ptr;
+    set->numStreamCalls++;
+    set->maxStreamItems = max(set->maxStreamItems,N);
+    for (size_t i=0; i<N; i++) 
+    {
+      RTCRay& ray = rays[rayIDs[i]];
+      float t; if (!intersectSphere(set->spheres[items[i]],ray,t)) continue;
+      ray.tfar = t;
+      ray.u = ray.v = 0.0f;
+      ray.geomID = set->geomID;
+      ray.primID = items[i];
     }
-    __aligned(16) int valid4[4] = { -1,-1,-1,-1 };
-    rtcOccluded4(valid4,scene,ray4);
-    rtcIntersect4(valid4,scene,ray4);
-#endif
+  }
 
-#if defined(__TARGET_AVX__) || defined(__TARGET_AVX2__)
-    if (has_feature(AVX)) {
-      RTCRay8 ray8;
-      for (size_t j=0; j<8; j++) {
-        Vec3fa org(2.0f*drand48()-1.0f,2.0f*drand48()-1.0f,2.0f*drand48()-1.0f);
-        Vec3fa dir(2.0f*drand48()-1.0f,2.0f*drand48()-1.0f,2.0f*drand48()-1.0f);
-        RTCRay ray = makeRay(org,dir); 
-        setRay(ray8,j,ray);
-      }
-      __aligned(32) int valid8[8] = { -1,-1,-1,-1,-1,-1,-1,-1 };
-      rtcOccluded8(valid8,scene,ray8);
-      rtcIntersect8(valid8,scene,ray8);
+  void OccludedFuncStream(void* ptr, RTCRay* rays, const unsigned* rayIDs, const size_t* items, size_t N) 
+  {
+    StreamSpheres* set = (StreamSpheres*) ptr;
+    set->numStreamCalls++;
+    set->maxStreamItems = max(set->maxStreamItems,N);
+    for (size_t i=0; i<N; i++) {
+      RTCRay& ray = rays[rayIDs[i]];
+      float t; if (intersectSphere(set->spheres[items[i]],ray,t)) ray.geomID = 0;
     }
-#endif
+  }
+
+  void BoundsFuncStream(StreamSpheres* set, size_t item, BBox3fa* bounds_o) {
+    *bounds_o = set->spheres[item].bounds();
+  }
+
+  void BoundsFuncN(StreamSpheres* set, size_t begin, size_t end, float* lower_x, float* lower_y, float* lower_z, float* upper_x, float* upper_y, float* upper_z) 
+  {
+    atomic_add(&set->numBoundsCalls,1);
+    for (size_t i=begin; i<end; i++) {
+      const BBox3fa bounds = set->spheres[i].bounds();
+      lower_x[i-begin] = bounds.lower.x; lower_y[i-begin] = bounds.lower.y; lower_z[i-begin] = bounds.lower.z;
+      upper_x[i-begin] = bounds.upper.x; upper_y[i-begin] = bounds.upper.y; upper_z[i-begin] = bounds.upper.z;
+    }
+  }
+
+  bool rtcore_user_geometry_stream()
+  {
+    bool passed = true;
+    RTCScene scene = rtcNewScene(RTC_SCENE_STATIC,RTC_INTERSECT1);
+    AssertNoError();
+    StreamSpheres* set = new StreamSpheres(64);
+    for (size_t i=0; i<64; i++) set->spheres[i] = Sphere(Vec3fa(float(i),0.0f,-5.0f),0.4f);
+    unsigned geom = set->geomID = rtcNewUserGeometry (scene,64);
+    rtcSetBoundsFunction(scene,geom,(RTCBoundsFunc)BoundsFuncStream);
+    rtcSetUserData(scene,geom,set);
+    rtcSetIntersectFunctionN(scene,geom,IntersectFuncStream);
+    rtcSetOccludedFunctionN(scene,geom,OccludedFuncStream);
+    rtcCommit (scene);
+    AssertNoError();
+
+    for (size_t i=0; i<64; i++) 
+    {
+      RTCRay ray0 = makeRay(Vec3fa(float(i),0.0f,0.0f),Vec3fa(0,0,-1));
+      rtcIntersect(scene,ray0);
+      passed &= ray0.geomID == geom && ray0.primID == i;
+      RTCRay ray1 = makeRay(Vec3fa(float(i),0.0f,0.0f),Vec3fa(0,0,-1));
+      rtcOccluded(scene,ray1);
+      passed &= ray1.geomID == 0;
+      RTCRay ray2 = makeRay(Vec3fa(float(i)+0.5f,0.0f,0.0f),Vec3fa(0,0,-1));
+      rtcOccluded(scene,ray2);
+      passed &= ray2.geomID == -1;
+    }
+    passed &= set->numStreamCalls > 0;
+    passed &= set->maxStreamItems > 1; // leaves have to pass multiple items at once
+
+    rtcDeleteScene (scene);
+    delete set;
+    AssertNoError();
+    return passed;
+  }
+
+  bool rtcore_user_geometry_boundsN(RTCSceneFlags sflags, size_t N)
+  {
+    /* only the batched bounding function gets set */
+    bool passed = true;
+    RTCScene scene = rtcNewScene(sflags,RTC_INTERSECT1);
+    AssertNoError();
+    StreamSpheres* set = new StreamSpheres(N);
+    for (size_t i=0; i<N; i++) set->spheres[i] = Sphere(Vec3fa(float(i%1000),float(i/1000),-5.0f),0.4f);
+    set->spheres[7] = Sphere(Vec3fa(inf),0.4f); // invalid item has to get skipped
+    unsigned geom = set->geomID = rtcNewUserGeometry (scene,N);
+    rtcSetBoundsFunctionN(scene,geom,(RTCBoundsFuncN)BoundsFuncN);
+    rtcSetUserData(scene,geom,set);
+    rtcSetIntersectFunctionN(scene,geom,IntersectFuncStream);
+    rtcSetOccludedFunctionN(scene,geom,OccludedFuncStream);
+    rtcCommit (scene);
+    AssertNoError();
+    passed &= set->numBoundsCalls > 0;
+
+    for (size_t k=0; k<2; k++)
+    {
+      for (size_t i=0; i<1000; i++) 
+      {
+        const size_t item = (i*7919) % N;
+        if (item == 7) continue;
+        const Vec3fa pos = set->spheres[item].pos;
+        RTCRay ray0 = makeRay(Vec3fa(pos.x,pos.y,0.0f),Vec3fa(0,0,-1));
+        rtcIntersect(scene,ray0);
+        passed &= ray0.geomID == geom && ray0.primID == item;
+      }
+      if (k == 1 || !(sflags & RTC_SCENE_DYNAMIC)) break;
+
+      /* move all spheres and rebuild from the batched bounds */
+      for (size_t i=0; i<N; i++) if (i != 7) set->spheres[i].pos.y += 0.5f;
+      rtcUpdate(scene,geom);
+      rtcCommit (scene);
+      AssertNoError();
+    }
+
+    rtcDeleteScene (scene);
+    delete set;
+    AssertNoError();
+    return passed;
+  }
+
+#if !defined(__MIC__)
+  bool rtcore_points(RTCSceneFlags sflags)
+  {
+    bool passed = true;
+    RTCScene scene = rtcNewScene(sflags,aflags);
+    AssertNoError();
+    const size_t N = 1000;
+    unsigned geom = rtcNewPointGeometry (scene,RTC_GEOMETRY_STATIC,N);
+    Vec3fa* points = (Vec3fa*) rtcMapBuffer(scene,geom,RTC_VERTEX_BUFFER);
+    for (size_t i=0; i<N; i++) points[i] = Vec3fa(float(i%100),float(i/100),-5.0f,0.25f);
+    rtcUnmapBuffer(scene,geom,RTC_VERTEX_BUFFER);
+    rtcCommit (scene);
+    AssertNoError();
+
+    for (size_t i=0; i<N; i+=7) 
+    {
+      const Vec3fa org(float(i%100),float(i/100),0.0f);
+      RTCRay ray0 = makeRay(org,Vec3fa(0,0,-1));
+      rtcIntersect(scene,ray0);
+      passed &= ray0.geomID == geom && ray0.primID == i && fabs(ray0.tfar-4.75f) < 1E-4f;
+      RTCRay ray1 = makeRay(org+Vec3fa(0.5f,0.0f,0.0f),Vec3fa(0,0,-1));
+      rtcOccluded(scene,ray1);
+      passed &= ray1.geomID == -1;
+
+      RTCRay4 ray4;
+      for (size_t j=0; j<4; j++) setRay(ray4,j,makeRay(org+Vec3fa(0.0f,0.0f,float(j)),Vec3fa(0,0,-1)));
+      __aligned(16) int valid4[4] = { -1,-1,-1,-1 };
+      rtcIntersect4(valid4,scene,ray4);
+      for (size_t j=0; j<4; j++)
+        passed &= ray4.geomID[j] == geom && ray4.primID[j] == i && fabs(ray4.tfar[j]-4.75f-float(j)) < 1E-4f;
+    }
+
+    rtcDeleteScene (scene);
+    AssertNoError();
+    return passed;
+  }
+
+  bool rtcore_tessellation_cache_stats()
+  {
+    bool passed = true;
+    RTCScene scene = rtcNewScene(RTC_SCENE_STATIC | RTC_SCENE_COHERENT,aflags);
+    AssertNoError();
+    unsigned geom = addSubdivSphere(scene,RTC_GEOMETRY_STATIC,zero,1.0f,10,8);
+    rtcCommit (scene);
+    AssertNoError();
+
+    RTCTessellationCacheStats stats;
+    rtcGetTessellationCacheStats(&stats,true);
+    for (size_t i=0; i<1000; i++) 
+    {
+      const float x = float(i%32)/31.0f-0.5f;
+      const float y = float(i/32)/31.0f-0.5f;
+      RTCRay ray = makeRay(Vec3fa(x,y,-5.0f),Vec3fa(0,0,1));
+      rtcIntersect(scene,ray);
+      passed &= ray.geomID == geom;
+    }
+    rtcGetTessellationCacheStats(&stats);
+    passed &= stats.size > 0;
+    passed &= stats.accesses > 0 && stats.misses > 0 && stats.hits > 0;
+    passed &= stats.hits + stats.misses == stats.accesses;
+
+    rtcDeleteScene (scene);
+    AssertNoError();
+    return passed;
+  }
+
+  bool rtcore_tessellation_cache_scenes()
+  {
+    /* new scenes likely get the addresses of deleted ones, their cached tessellations must not get used */
+    float lastT = inf;
+    for (size_t i=0; i<8; i++) 
+    {
+      RTCScene scene = rtcNewScene(RTC_SCENE_STATIC | RTC_SCENE_COHERENT,aflags);
+      AssertNoError();
+      unsigned geom = addSubdivSphere(scene,RTC_GEOMETRY_STATIC,zero,1.0f+0.25f*i,10,8);
+      rtcCommit (scene);
+      AssertNoError();
+
+      RTCRay ray = makeRay(Vec3fa(0.1f,0.1f,-5.0f),Vec3fa(0,0,1));
+      rtcIntersect(scene,ray);
+      rtcDeleteScene (scene);
+      AssertNoError();
+      if (ray.geomID != geom || ray.tfar > lastT-0.1f) return false;
+      lastT = ray.tfar;
+    }
+    return true;
+  }
+
+  atomic_t g_numLevelEdges = 0;
+
+  void edgeLevelFunc(void* ptr, unsigned geomID, size_t firstEdge,
+                     const float* x0, const float* y0, const float* z0,
+                     const float* x1, const float* y1, const float* z1,
+                     float* levels, size_t N)
+  {
+    for (size_t i=0; i<N; i++) levels[i] = 4.0f;
+    atomic_add(&g_numLevelEdges,N);
+  }
+
+  bool rtcore_edge_levels()
+  {
+    bool passed = true;
+    RTCScene scene = rtcNewScene(RTC_SCENE_DYNAMIC | RTC_SCENE_COHERENT,aflags);
+    AssertNoError();
+    unsigned geom = addSubdivSphere(scene,RTC_GEOMETRY_DYNAMIC,zero,1.0f,10,1);
+    rtcSetEdgeLevelFunction(scene,geom,edgeLevelFunc);
+    AssertNoError();
+
+    for (size_t frame=0; frame<2; frame++)
+    {
+      if (frame == 1) {
+        const float cam[3] = { 0.0f, 0.0f, -5.0f };
+        rtcSetEdgeLevelFunction(scene,geom,NULL);
+        rtcSetEdgeLevelCamera(scene,geom,cam,16.0f);
+        AssertNoError();
+      }
+      g_numLevelEdges = 0;
+      rtcCommit (scene);
+      AssertNoError();
+      passed &= (frame == 0) == (g_numLevelEdges > 0);
+
+      for (size_t i=0; i<100; i++) 
+      {
+        const float x = float(i%10)/9.0f-0.5f;
+        const float y = float(i/10)/9.0f-0.5f;
+        RTCRay ray = makeRay(Vec3fa(x,y,-5.0f),Vec3fa(0,0,1));
+        rtcIntersect(scene,ray);
+        passed &= ray.geomID == geom;
+      }
+    }
+
+    rtcDeleteScene (scene);
+    AssertNoError();
+    return passed;
+  }
+
+  bool rtcore_interpolate()
+  {
+    bool passed = true;
+    RTCScene scene = rtcNewScene(RTC_SCENE_DYNAMIC | RTC_SCENE_COHERENT,aflags);
+    AssertNoError();
+    unsigned geom = addSubdivSphere(scene,RTC_GEOMETRY_DYNAMIC,zero,1.0f,10,16);
+    Vec3fa* vertices = (Vec3fa*) rtcMapBuffer(scene,geom,RTC_VERTEX_BUFFER);
+    Vec3fa* attribs  = (Vec3fa*) rtcMapBuffer(scene,geom,RTC_USER_VERTEX_BUFFER0);
+    for (size_t i=0; i<(10*2)*(10+1); i++) attribs[i] = vertices[i];
+    rtcUnmapBuffer(scene,geom,RTC_USER_VERTEX_BUFFER0);
+    rtcUnmapBuffer(scene,geom,RTC_VERTEX_BUFFER);
+    rtcCommit (scene);
+    AssertNoError();
+
+    for (size_t i=0; i<100; i+=4) 
+    {
+      __aligned(16) int valid[4] = { -1,-1,-1,-1 };
+      unsigned primIDs[4]; float u[4], v[4]; 
+      float P[4][3], dPdu[4][3], dPdv[4][3];
+      for (size_t j=0; j<4; j++)
+      {
+        const float x = float((i+j)%10)/9.0f-0.5f;
+        const float y = float((i+j)/10)/9.0f-0.5f;
+        RTCRay ray = makeRay(Vec3fa(x,y,-5.0f),Vec3fa(0,0,1));
+        rtcIntersect(scene,ray);
+        if (ray.geomID != geom) { passed = false; valid[j] = 0; continue; }
+        primIDs[j] = ray.primID; u[j] = ray.u; v[j] = ray.v;
+
+        /* interpolated position has to be close to the hit, and the derivatives span the surface */
+        rtcInterpolate(scene,geom,ray.primID,ray.u,ray.v,RTC_VERTEX_BUFFER,P[j],dPdu[j],dPdv[j],3);
+        const Vec3fa hit = Vec3fa(x,y,-5.0f)+ray.tfar*Vec3fa(0,0,1);
+        const Vec3fa p(P[j][0],P[j][1],P[j][2]);
+        const Vec3fa Ng = cross(Vec3fa(dPdu[j][0],dPdu[j][1],dPdu[j][2]),Vec3fa(dPdv[j][0],dPdv[j][1],dPdv[j][2]));
+        passed &= length(p-hit) < 0.01f;
+        passed &= abs(dot(normalize(Ng),normalize(Vec3fa(ray.Ng[0],ray.Ng[1],ray.Ng[2])))) > 0.9f;
+
+        /* user vertex buffer holds the same data */
+        float Pu[3]; 
+        rtcInterpolate(scene,geom,ray.primID,ray.u,ray.v,RTC_USER_VERTEX_BUFFER0,Pu,NULL,NULL,3);
+        passed &= Pu[0] == P[j][0] && Pu[1] == P[j][1] && Pu[2] == P[j][2];
+      }
+
+      /* batched interpolation returns identical results in SOA layout */
+      float PN[3][4], dPduN[3][4], dPdvN[3][4];
+      rtcInterpolateN(scene,geom,valid,primIDs,u,v,4,RTC_VERTEX_BUFFER,&PN[0][0],&dPduN[0][0],&dPdvN[0][0],3);
+      for (size_t j=0; j<4; j++) {
+        if (valid[j] == 0) continue;
+        for (size_t k=0; k<3; k++) {
+          passed &= PN[k][j] == P[j][k];
+          passed &= dPduN[k][j] == dPdu[j][k];
+          passed &= dPdvN[k][j] == dPdv[j][k];
+        }
+      }
+    }
+    AssertNoError();
+
+    rtcDeleteScene (scene);
+    AssertNoError();
+    return passed;
+  }
+
+  bool rtcore_interpolate_derivatives()
+  {
+    /* all faces of a subdivided cube are irregular, as all vertices have valence 3 */
+    RTCScene scene = rtcNewScene(RTC_SCENE_STATIC,aflags);
+    AssertNoError();
+    unsigned geom = rtcNewSubdivisionMesh(scene, RTC_GEOMETRY_STATIC, 6, 24, 8, 0, 0, 0);
+    Vec3fa* vertices = (Vec3fa*) rtcMapBuffer(scene,geom,RTC_VERTEX_BUFFER); 
+    int*    indices  = (int*   ) rtcMapBuffer(scene,geom,RTC_INDEX_BUFFER);
+    int*    faces    = (int*   ) rtcMapBuffer(scene,geom,RTC_FACE_BUFFER);
+    for (size_t i=0; i<8; i++) /* slightly distorted to avoid symmetries */
+      vertices[i] = Vec3fa(i&1 ? 1.0f : -1.0f, i&2 ? 1.0f : -1.0f, i&4 ? 1.0f : -1.0f) + 0.1f*Vec3fa(float(i%3),float(i%5),float(i%2));
+    const int cube[24] = { 0,1,3,2, 4,6,7,5, 0,4,5,1, 2,3,7,6, 0,2,6,4, 1,5,7,3 };
+    for (size_t i=0; i<24; i++) indices[i] = cube[i];
+    for (size_t i=0; i<6; i++) faces[i] = 4;
+    rtcUnmapBuffer(scene,geom,RTC_VERTEX_BUFFER); 
+    rtcUnmapBuffer(scene,geom,RTC_INDEX_BUFFER);
+    rtcUnmapBuffer(scene,geom,RTC_FACE_BUFFER);
+    rtcCommit (scene);
+    AssertNoError();
+
+    /* compare derivatives against central differences */
+    bool passed = true;
+    const float h = 1E-3f;
+    const float uvs[4][2] = { { 0.3f,0.2f }, { 0.7f,0.35f }, { 0.15f,0.8f }, { 0.6f,0.65f } };
+    for (size_t f=0; f<6; f++) 
+    {
+      for (size_t i=0; i<4; i++)
+      {
+        const float u = uvs[i][0], v = uvs[i][1];
+        float P[3], dPdu[3], dPdv[3], Pu0[3], Pu1[3], Pv0[3], Pv1[3];
+        rtcInterpolate(scene,geom,f,u,v,RTC_VERTEX_BUFFER,P,dPdu,dPdv,3);
+        rtcInterpolate(scene,geom,f,u-h,v,RTC_VERTEX_BUFFER,Pu0,NULL,NULL,3);
+        rtcInterpolate(scene,geom,f,u+h,v,RTC_VERTEX_BUFFER,Pu1,NULL,NULL,3);
+        rtcInterpolate(scene,geom,f,u,v-h,RTC_VERTEX_BUFFER,Pv0,NULL,NULL,3);
+        rtcInterpolate(scene,geom,f,u,v+h,RTC_VERTEX_BUFFER,Pv1,NULL,NULL,3);
+        const Vec3fa du(dPdu[0],dPdu[1],dPdu[2]), dv(dPdv[0],dPdv[1],dPdv[2]);
+        const Vec3fa fu = (Vec3fa(Pu1[0],Pu1[1],Pu1[2])-Vec3fa(Pu0[0],Pu0[1],Pu0[2]))/(2.0f*h);
+        const Vec3fa fv = (Vec3fa(Pv1[0],Pv1[1],Pv1[2])-Vec3fa(Pv0[0],Pv0[1],Pv0[2]))/(2.0f*h);
+        passed &= length(du-fu) <= 1E-2f*length(fu);
+        passed &= length(dv-fv) <= 1E-2f*length(fv);
+      }
+    }
+    AssertNoError();
+
+    rtcDeleteScene (scene);
+    AssertNoError();
+    return passed;
+  }
+
+  /*! shoots rays downwards onto the inner faces of the subdiv height field and checks the hits against its limit surface raised by dy */
+  bool rtcore_check_height_field(RTCScene scene, unsigned geom, size_t N, float dy, float time = 0.0f)
+  {
+    for (size_t i=0; i<32*32; i++) 
+    {
+      const float x = 1.2f*(float(i%32)+0.5f)/32.0f-0.6f;
+      const float z = 1.2f*(float(i/32)+0.5f)/32.0f-0.6f;
+      RTCRay ray = makeRay(Vec3fa(x,10.0f,z),Vec3fa(0,-1,0));
+      ray.time = time;
+      rtcIntersect(scene,ray);
+      if (ray.geomID != geom) return false;
+      if (fabs(10.0f-ray.tfar-subdivHeightFieldY(x,z,N)-dy) > 1E-3f) return false;
+      const Vec3fa Ng = normalize(Vec3fa(ray.Ng[0],ray.Ng[1],ray.Ng[2]));
+      if (abs(dot(Ng,normalize(Vec3fa(-x,1.0f,-z)))) < 0.99f) return false;
+    }
+    return true;
+  }
+
+  bool rtcore_subdiv_grids()
+  {
+    /* the eager and lazy grids evaluate the patches in SIMD */
+    const RTCSceneFlags sflags[2] = { RTC_SCENE_INCOHERENT, RTC_SCENE_INCOHERENT | RTC_SCENE_COMPACT };
+    for (size_t i=0; i<2; i++)
+    {
+      RTCScene scene = rtcNewScene(RTC_SCENE_STATIC | sflags[i],aflags);
+      AssertNoError();
+      unsigned geom = addSubdivHeightField(scene,RTC_GEOMETRY_STATIC,16,7);
+      rtcCommit (scene);
+      AssertNoError();
+      bool ok = rtcore_check_height_field(scene,geom,16,0.0f);
+      rtcDeleteScene (scene);
+      AssertNoError();
+      if (!ok) return false;
+    }
+    return true;
+  }
+
+  bool rtcore_subdiv_regular_patches()
+  {
+    /* the cached tessellation of the inner faces uses the precomputed B-spline control points */
+    RTCScene scene = rtcNewScene(RTC_SCENE_DYNAMIC | RTC_SCENE_COHERENT,aflags);
+    AssertNoError();
+    unsigned geom = addSubdivHeightField(scene,RTC_GEOMETRY_DEFORMABLE,16,8);
+    rtcCommit (scene);
+    AssertNoError();
+    bool passed = rtcore_check_height_field(scene,geom,16,0.0f);
+
+    /* the control points have to follow the vertices */
+    for (size_t i=1; i<4; i++)
+    {
+      Vec3fa* vertices = (Vec3fa*) rtcMapBuffer(scene,geom,RTC_VERTEX_BUFFER);
+      for (size_t j=0; j<17*17; j++) vertices[j].y += 0.25f;
+      rtcUnmapBuffer(scene,geom,RTC_VERTEX_BUFFER);
+      rtcUpdateBuffer(scene,geom,RTC_VERTEX_BUFFER);
+      rtcCommit (scene);
+      AssertNoError();
+      passed &= rtcore_check_height_field(scene,geom,16,0.25f*i);
+    }
+
+    rtcDeleteScene (scene);
+    AssertNoError();
+    return passed;
+  }
+
+  bool rtcore_subdiv_refit()
+  {
+    /* the builder reports the refit in verbose mode, capture its output */
+    std::stringstream log;
+    std::streambuf* cout = std::cout.rdbuf(log.rdbuf());
+    rtcExit();
+    rtcInit((g_rtcore+",verbose=1").c_str());
+
+    /* changing only the vertices of a deformable mesh refits the cached subdiv bvh */
+    RTCScene scene = rtcNewScene(RTC_SCENE_DYNAMIC | RTC_SCENE_COHERENT,aflags);
+    unsigned geom = addSubdivHeightField(scene,RTC_GEOMETRY_DEFORMABLE,16,4);
+    rtcCommit (scene);
+    bool passed = rtcGetError() == RTC_NO_ERROR;
+
+    for (size_t i=0; i<4 && passed; i++)
+    {
+      Vec3fa* vertices = (Vec3fa*) rtcMapBuffer(scene,geom,RTC_VERTEX_BUFFER);
+      for (size_t j=0; j<17*17; j++) 
+        vertices[j].y += 0.25f*sinf(3.0f*vertices[j].x+float(i))*cosf(2.0f*vertices[j].z);
+      rtcUnmapBuffer(scene,geom,RTC_VERTEX_BUFFER);
+      rtcUpdateBuffer(scene,geom,RTC_VERTEX_BUFFER);
+
+      log.str("");
+      rtcCommit (scene);
+      passed &= rtcGetError() == RTC_NO_ERROR;
+      passed &= log.str().find("refit") != std::string::npos;
+
+      /* build a new scene from the same vertices */
+      RTCScene ref = rtcNewScene(RTC_SCENE_STATIC | RTC_SCENE_COHERENT,aflags);
+      unsigned refGeom = addSubdivHeightField(ref,RTC_GEOMETRY_STATIC,16,4);
+      memcpy(rtcMapBuffer(ref,refGeom,RTC_VERTEX_BUFFER),rtcMapBuffer(scene,geom,RTC_VERTEX_BUFFER),17*17*sizeof(Vec3fa));
+      rtcUnmapBuffer(scene,geom,RTC_VERTEX_BUFFER); rtcUnmapBuffer(ref,refGeom,RTC_VERTEX_BUFFER);
+      rtcCommit (ref);
+      passed &= rtcGetError() == RTC_NO_ERROR;
+
+      size_t numHits = 0;
+      passed &= rtcore_compare_hits(scene,ref,Vec3fa(-1,-1,-1),Vec3fa(1,2,1),64,numHits);
+      passed &= numHits > 0;
+      rtcDeleteScene (ref);
+    }
+    rtcDeleteScene (scene);
+    passed &= rtcGetError() == RTC_NO_ERROR;
+    rtcExit();
+    rtcInit(g_rtcore.c_str());
+    std::cout.rdbuf(cout);
+    return passed;
+  }
+
+  bool rtcore_lazy_grid_eviction()
+  {
+    /* the lazy grids of the inner faces do not fit into a 1 MB tessellation cache */
+    rtcExit();
+    rtcInit((g_rtcore+",tessellation_cache_size=1,tessellation_cache_max_size=1").c_str());
+    bool passed = rtcGetError() == RTC_NO_ERROR;
+
+    RTCScene scene = rtcNewScene(RTC_SCENE_STATIC | RTC_SCENE_INCOHERENT | RTC_SCENE_COMPACT,aflags);
+    unsigned geom = addSubdivHeightField(scene,RTC_GEOMETRY_STATIC,32,4);
+    rtcCommit (scene);
+    passed &= rtcGetError() == RTC_NO_ERROR;
+
+    /* evicted grids have to get rebuilt when hit again */
+    RTCTessellationCacheStats stats;
+    rtcGetTessellationCacheStats(&stats,true);
+    for (size_t i=0; i<3; i++)
+      passed &= rtcore_check_height_field(scene,geom,32,0.0f);
+    rtcGetTessellationCacheStats(&stats);
+    passed &= stats.size <= 1024*1024;
+    passed &= stats.evictions > 0;
+
+    rtcDeleteScene (scene);
+    passed &= rtcGetError() == RTC_NO_ERROR;
+    rtcExit();
+    rtcInit(g_rtcore.c_str());
+    return passed;
+  }
+
+  bool rtcore_large_patches()
+  {
+    /* the tessellation of a single patch does not fit into a segment of a 1 MB tessellation cache */
+    rtcExit();
+    rtcInit((g_rtcore+",tessellation_cache_size=1,tessellation_cache_max_size=1").c_str());
+    bool passed = rtcGetError() == RTC_NO_ERROR;
+
+    RTCScene scene = rtcNewScene(RTC_SCENE_STATIC | RTC_SCENE_COHERENT,aflags);
+    unsigned geom = addSubdivHeightField(scene,RTC_GEOMETRY_STATIC,8,128);
+    rtcCommit (scene);
+    passed &= rtcGetError() == RTC_NO_ERROR;
+    passed &= rtcore_check_height_field(scene,geom,8,0.0f);
+
+    rtcDeleteScene (scene);
+    passed &= rtcGetError() == RTC_NO_ERROR;
+    rtcExit();
+    rtcInit(g_rtcore.c_str());
+    return passed;
+  }
+
+  void displacementFunc(void* ptr, unsigned geomID, unsigned primID, 
+                        const float* u, const float* v, 
+                        const float* nx, const float* ny, const float* nz, 
+                        float* px, float* py, float* pz, size_t N)
+  {
+    for (size_t i=0; i<N; i++) {
+      py[i] += 0.1f + 0.1f*px[i]*px[i];
+      px[i] += 0.25f;
+    }
+  }
+
+  bool rtcore_displacement_bounds()
+  {
+    /* lazy grids get bounded by the estimated instead of the much larger user specified displacement bounds */
+    rtcExit();
+    rtcInit((g_rtcore+",subdiv_displacement_bounds=estimate").c_str());
+    bool passed = rtcGetError() == RTC_NO_ERROR;
+
+    RTCScene scene = rtcNewScene(RTC_SCENE_STATIC | RTC_SCENE_INCOHERENT | RTC_SCENE_COMPACT,aflags);
+    unsigned geom = addSubdivHeightField(scene,RTC_GEOMETRY_STATIC,16,8);
+    RTCBounds bounds = { -10.0f, -10.0f, -10.0f, 0.0f, 10.0f, 10.0f, 10.0f, 0.0f };
+    rtcSetDisplacementFunction(scene,geom,displacementFunc,&bounds);
+    rtcCommit (scene);
+    passed &= rtcGetError() == RTC_NO_ERROR;
+
+    /* the surface gets displaced sideways, thus it is missed if the bounds do not contain the displacement */
+    for (size_t i=0; i<32*32; i++) 
+    {
+      const float x = 1.2f*(float(i%32)+0.5f)/32.0f-0.6f;
+      const float z = 1.2f*(float(i/32)+0.5f)/32.0f-0.6f;
+      RTCRay ray = makeRay(Vec3fa(x+0.25f,10.0f,z),Vec3fa(0,-1,0));
+      rtcIntersect(scene,ray);
+      passed &= ray.geomID == geom;
+      passed &= fabs(10.0f-ray.tfar-subdivHeightFieldY(x,z,16)-0.1f-0.1f*x*x) < 1E-3f;
+    }
+
+    rtcDeleteScene (scene);
+    passed &= rtcGetError() == RTC_NO_ERROR;
+    rtcExit();
+    rtcInit(g_rtcore.c_str());
+    return passed;
+  }
+
+  bool rtcore_subdiv_motion_blur()
+  {
+    /* the height field moves upwards by 0.5 from time 0 to time 1 */
+    const RTCSceneFlags sflags[2] = { RTC_SCENE_COHERENT, RTC_SCENE_INCOHERENT };
+    for (size_t i=0; i<2; i++)
+    {
+      RTCScene scene = rtcNewScene(RTC_SCENE_STATIC | sflags[i],aflags);
+      AssertNoError();
+      unsigned geom = addSubdivHeightField(scene,RTC_GEOMETRY_STATIC,16,4,0.5f);
+      rtcCommit (scene);
+      AssertNoError();
+      bool ok = true;
+      for (size_t j=0; j<5; j++) {
+        const float time = 0.25f*float(j);
+        ok &= rtcore_check_height_field(scene,geom,16,0.5f*time,time);
+      }
+      rtcDeleteScene (scene);
+      AssertNoError();
+      if (!ok) return false;
+    }
+    return true;
+  }
+#endif
+
+  void shootRays (RTCScene scene)
+  {
+    Vec3fa org(2.0f*drand48()-1.0f,2.0f*drand48()-1.0f,2.0f*drand48()-1.0f);
+    Vec3fa dir(2.0f*drand48()-1.0f,2.0f*drand48()-1.0f,2.0f*drand48()-1.0f);
+    RTCRay ray = makeRay(org,dir); 
+    rtcOccluded(scene,ray);
+    rtcIntersect(scene,ray);
+
+#if !defined(__MIC__)
+    RTCRay4 ray4;
+    for (size_t j=0; j<4; j++) {
+      Vec3fa org(2.0f*drand48()-1.0f,2.0f*drand48()-1.0f,2.0f*drand48()-1.0f);
+      Vec3fa dir(2.0f*drand48()-1.0f,2.0f*drand48()-1.0f,2.0f*drand48()-1.0f);
+      RTCRay ray = makeRay(org,dir); 
+      setRay(ray4,j,ray);
+    }
+    __aligned(16) int valid4[4] = { -1,-1,-1,-1 };
+    rtcOccluded4(valid4,scene,ray4);
+    rtcIntersect4(valid4,scene,ray4);
+#endif
+
+#if defined(__TARGET_AVX__) || defined(__TARGET_AVX2__)
+    if (has_feature(AVX)) {
+      RTCRay8 ray8;
+      for (size_t j=0; j<8; j++) {
+        Vec3fa org(2.0f*drand48()-1.0f,2.0f*drand48()-1.0f,2.0f*drand48()-1.0f);
+        Vec3fa dir(2.0f*drand48()-1.0f,2.0f*drand48()-1.0f,2.0f*drand48()-1.0f);
+        RTCRay ray = makeRay(org,dir); 
+        setRay(ray8,j,ray);
+      }
+      __aligned(32) int valid8[8] = { -1,-1,-1,-1,-1,-1,-1,-1 };
+      rtcOccluded8(valid8,scene,ray8);
+      rtcIntersect8(valid8,scene,ray8);
+    }
+#endif
 
 #if defined(__MIC__)
     RTCRay16 ray16;
@@ -2813,6 +3856,130 @@ namespace embree
     return true;
   }
 
+  /* minimal thread pool of an application that executes the tasks of Embree */
+  struct AppTaskPool
+  {
+    struct Item 
+    {
+      Item (RTCTaskFunc func, void* task, size_t taskIndex, size_t taskCount)
+        : func(func), task(task), taskIndex(taskIndex), taskCount(taskCount) {}
+
+      RTCTaskFunc func;
+      void* task;
+      size_t taskIndex, taskCount;
+    };
+
+    AppTaskPool (size_t numThreads) : terminate(false), numSpawned(0)
+    {
+      for (size_t i=0; i<numThreads; i++)
+        threads.push_back(createThread(threadFunction,this,DEFAULT_STACK_SIZE));
+    }
+
+    ~AppTaskPool ()
+    {
+      mutex.lock();
+      terminate = true;
+      condition.broadcast();
+      mutex.unlock();
+      for (size_t i=0; i<threads.size(); i++)
+        join(threads[i]);
+    }
+
+    /* executes the next item, returns false if there was none */
+    bool work(bool block)
+    {
+      mutex.lock();
+      while (block && items.empty() && !terminate) 
+        condition.wait(mutex);
+      if (items.empty()) {
+        mutex.unlock();
+        return false;
+      }
+      Item item = items.front(); items.pop_front();
+      mutex.unlock();
+      item.func(item.task,item.taskIndex,item.taskCount);
+      return true;
+    }
+
+    static void threadFunction(void* ptr) 
+    {
+      AppTaskPool* pool = (AppTaskPool*) ptr;
+      while (!pool->terminate) pool->work(true);
+    }
+
+    static void spawn(void* ptr, RTCTaskFunc func, void* task, size_t taskCount)
+    {
+      AppTaskPool* pool = (AppTaskPool*) ptr;
+      pool->mutex.lock();
+      for (size_t i=0; i<taskCount; i++) 
+        pool->items.push_back(Item(func,task,i,taskCount));
+      pool->numSpawned += taskCount;
+      pool->condition.broadcast();
+      pool->mutex.unlock();
+    }
+
+    static void wait(void* ptr, RTCConditionFunc cond, void* condPtr)
+    {
+      AppTaskPool* pool = (AppTaskPool*) ptr;
+      while (!cond(condPtr)) 
+        if (!pool->work(false)) __pause_cpu();
+    }
+
+  public:
+    std::vector<thread_t> threads;
+    MutexSys mutex;
+    ConditionSys condition;
+    std::deque<Item> items;
+    volatile bool terminate;
+    size_t numSpawned;
+  };
+
+  bool rtcore_app_tasking_build(AppTaskPool& pool)
+  {
+    RTCScene scene = rtcNewScene(RTC_SCENE_STATIC,aflags);
+    AssertNoError();
+    for (size_t i=0; i<8; i++) 
+      addSphere(scene,RTC_GEOMETRY_STATIC,Vec3fa(4.0f*i,0,0),1.0f,100);
+    rtcCommit(scene);
+    AssertNoError();
+
+    bool ok = pool.numSpawned > 0;
+    for (size_t i=0; i<8; i++) {
+      RTCRay ray = makeRay(Vec3fa(4.0f*i,0,-10),Vec3fa(0,0,1)); 
+      rtcIntersect(scene,ray);
+      ok &= ray.geomID == i;
+    }
+    rtcDeleteScene (scene);
+    clearBuffers();
+    AssertNoError();
+    return ok;
+  }
+
+  bool rtcore_app_tasking()
+  {
+    /* tasking system cannot get changed while Embree is running */
+    rtcSetTaskingSystem(AppTaskPool::spawn,AppTaskPool::wait,NULL);
+    AssertAnyError();
+
+    /* build a scene using the threads of the application pool only */
+    rtcExit();
+    bool ok = false;
+    {
+      /* the pool may run more tasks at once than Embree uses threads */
+      const size_t numThreads = getNumberOfLogicalThreads();
+      AppTaskPool pool(2*numThreads);
+      rtcSetTaskingSystem(AppTaskPool::spawn,AppTaskPool::wait,&pool);
+      rtcInit((g_rtcore+",threads="+std::stringOf(numThreads)).c_str());
+      ok = rtcGetError() == RTC_NO_ERROR && rtcore_app_tasking_build(pool);
+      rtcExit();
+    }
+
+    /* continue with the Embree internal threads */
+    rtcSetTaskingSystem(NULL,NULL,NULL);
+    rtcInit(g_rtcore.c_str());
+    return ok;
+  }
+
   /* main function in embree namespace */
   int main(int argc, char** argv) 
   {
@@ -2833,6 +4000,7 @@ namespace embree
 #if !defined(__MIC__) && !defined(_WIN32) // FIXME: hangs on MIC and Windows
     POSITIVE("condition_sys",             test_condition_sys());
 #endif
+    POSITIVE("thread_placement",          test_thread_placement());
 #if 1
     POSITIVE("empty_static",              rtcore_empty(RTC_SCENE_STATIC));
     POSITIVE("empty_dynamic",             rtcore_empty(RTC_SCENE_DYNAMIC));
@@ -2855,12 +4023,32 @@ namespace embree
 
     POSITIVE("update_deformable",         rtcore_update(RTC_GEOMETRY_DEFORMABLE));
     POSITIVE("update_dynamic",            rtcore_update(RTC_GEOMETRY_DYNAMIC));
+    POSITIVE("rebuild_hair",              rtcore_rebuild_hair());
     POSITIVE("overlapping_triangles",     rtcore_overlapping_triangles(100000));
     POSITIVE("overlapping_hair",          rtcore_overlapping_hair(100000));
 
     rtcore_build();
 
     POSITIVE("new_delete_geometry",       rtcore_new_delete_geometry());
+    POSITIVE("user_geometry_stream",      rtcore_user_geometry_stream());
+    POSITIVE("user_geometry_boundsN",     rtcore_user_geometry_boundsN(RTC_SCENE_STATIC,100000));
+    POSITIVE("user_geometry_boundsN_dynamic", rtcore_user_geometry_boundsN(RTC_SCENE_DYNAMIC,1000));
+#if !defined(__MIC__)
+    POSITIVE("points_static",             rtcore_points(RTC_SCENE_STATIC));
+    POSITIVE("points_dynamic",            rtcore_points(RTC_SCENE_DYNAMIC));
+    POSITIVE("tessellation_cache_stats",  rtcore_tessellation_cache_stats());
+    POSITIVE("tessellation_cache_scenes", rtcore_tessellation_cache_scenes());
+    POSITIVE("edge_levels",               rtcore_edge_levels());
+    POSITIVE("interpolate",               rtcore_interpolate());
+    POSITIVE("interpolate_derivatives",   rtcore_interpolate_derivatives());
+    POSITIVE("subdiv_grids",              rtcore_subdiv_grids());
+    POSITIVE("subdiv_regular_patches",    rtcore_subdiv_regular_patches());
+    POSITIVE("subdiv_refit",              rtcore_subdiv_refit());
+    POSITIVE("lazy_grid_eviction",        rtcore_lazy_grid_eviction());
+    POSITIVE("large_patches",             rtcore_large_patches());
+    POSITIVE("displacement_bounds",       rtcore_displacement_bounds());
+    POSITIVE("subdiv_motion_blur",        rtcore_subdiv_motion_blur());
+#endif
 
 #if defined(RTCORE_RAY_MASK)
     rtcore_ray_masks_all();
@@ -2874,6 +4062,10 @@ namespace embree
     rtcore_backface_culling_all();
 #endif
 
+#if defined(RTCORE_ALPHA_MASK)
+    rtcore_alpha_mask_all();
+#endif
+
     rtcore_packet_write_test_all();
 
     const Vec3fa pos = Vec3fa(148376.0f,1234.0f,-223423.0f);
@@ -2933,6 +4125,7 @@ namespace embree
     POSITIVE("regression_dynamic_user_threads", rtcore_regression(rtcore_regression_dynamic_thread,true));
 
     POSITIVE("regression_garbage_geom",   rtcore_regression_garbage());
+    POSITIVE("app_tasking",               rtcore_app_tasking());
 #endif
 
     rtcExit();